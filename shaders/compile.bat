@@ -3,7 +3,10 @@
 for /D %%i in (C:\VulkanSDK\*) do set "SDK_DIR=%%i"
 set "IS_ERROR=0"
 
-set shaders="main" "skybox" "prepass" "sphere-cube" "convolute" "prefilter" "brdf-integrate" "ss-quad" "ssao"
+set shaders="main" "skybox" "prepass" "sphere-cube" "convolute" "prefilter" "brdf-integrate" "ss-quad" "ssao" "shadow"
+rem screen-space passes drawn with the vertex shader of "ss-quad"
+set fragment_shaders="ssao-blur" "taa" "fxaa" "upscale"
+set compute_shaders="gtao" "depth-pyramid" "cull" "skin"
 
 (for %%a in (%shaders%) do (
    @echo on
@@ -17,4 +20,18 @@ set shaders="main" "skybox" "prepass" "sphere-cube" "convolute" "prefilter" "brd
    if %ERRORLEVEL% NEQ 0 set "IS_ERROR=1"
 ))
 
+(for %%a in (%fragment_shaders%) do (
+   @echo on
+   %SDK_DIR%/Bin/glslc.exe %%a.frag -o obj/%%a-frag.spv -g --target-env=vulkan1.1
+   @echo off
+   if %ERRORLEVEL% NEQ 0 set "IS_ERROR=1"
+))
+
+(for %%a in (%compute_shaders%) do (
+   @echo on
+   %SDK_DIR%/Bin/glslc.exe %%a.comp -o obj/%%a-comp.spv -g --target-env=vulkan1.1
+   @echo off
+   if %ERRORLEVEL% NEQ 0 set "IS_ERROR=1"
+))
+
 if %IS_ERROR% NEQ 0 exit 1
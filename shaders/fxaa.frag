@@ -0,0 +1,168 @@
+#version 450
+
+layout (location = 0) in vec2 texCoords;
+
+layout (location = 0) out vec4 outColor;
+
+layout (push_constant) uniform PushConstants {
+    vec2 uv_scale; // part of the input texture that was rendered into this frame
+} constants;
+
+layout (binding = 0) uniform sampler2D sceneColorSampler; // linear hdr
+
+#define EDGE_THRESHOLD_MIN 0.0312
+#define EDGE_THRESHOLD_MAX 0.125
+#define SUBPIXEL_QUALITY 0.75
+#define SEARCH_STEPS 12
+
+const float search_step_sizes[SEARCH_STEPS] = float[](1.0, 1.0, 1.0, 1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0, 8.0);
+
+vec2 texel_size;
+
+vec3 sample_color(vec2 uv) {
+    // texels outside the rendered region hold stale contents from frames rendered at a higher scale
+    uv = clamp(uv, 0.5 * texel_size, constants.uv_scale - 0.5 * texel_size);
+    return textureLod(sceneColorSampler, uv, 0.0).rgb;
+}
+
+// edges have to be detected on what ends up on screen, so the input is tonemapped before taking its luma.
+// the square root roughly matches the gamma curve applied later on
+float luma(vec3 color) {
+    vec3 tonemapped = color / (color + vec3(1.0));
+    return sqrt(dot(tonemapped, vec3(0.299, 0.587, 0.114)));
+}
+
+float sample_luma(vec2 uv) {
+    return luma(sample_color(uv));
+}
+
+void main() {
+    texel_size = 1.0 / vec2(textureSize(sceneColorSampler, 0));
+
+    vec2 uv = gl_FragCoord.xy * texel_size;
+    vec3 center_color = sample_color(uv);
+
+    float luma_center = luma(center_color);
+    float luma_down = sample_luma(uv + vec2(0.0, texel_size.y));
+    float luma_up = sample_luma(uv - vec2(0.0, texel_size.y));
+    float luma_left = sample_luma(uv - vec2(texel_size.x, 0.0));
+    float luma_right = sample_luma(uv + vec2(texel_size.x, 0.0));
+
+    float luma_min = min(luma_center, min(min(luma_down, luma_up), min(luma_left, luma_right)));
+    float luma_max = max(luma_center, max(max(luma_down, luma_up), max(luma_left, luma_right)));
+    float luma_range = luma_max - luma_min;
+
+    // skip pixels which aren't on a noticeable edge, which is most of them
+    if (luma_range < max(EDGE_THRESHOLD_MIN, luma_max * EDGE_THRESHOLD_MAX)) {
+        outColor = vec4(center_color, 1.0);
+        return;
+    }
+
+    float luma_down_left = sample_luma(uv + vec2(-texel_size.x, texel_size.y));
+    float luma_up_right = sample_luma(uv + vec2(texel_size.x, -texel_size.y));
+    float luma_up_left = sample_luma(uv - texel_size);
+    float luma_down_right = sample_luma(uv + texel_size);
+
+    float luma_down_up = luma_down + luma_up;
+    float luma_left_right = luma_left + luma_right;
+    float luma_left_corners = luma_down_left + luma_up_left;
+    float luma_down_corners = luma_down_left + luma_down_right;
+    float luma_right_corners = luma_down_right + luma_up_right;
+    float luma_up_corners = luma_up_right + luma_up_left;
+
+    // decide on the edge's orientation from horizontal and vertical second derivatives
+
+    float edge_horizontal = abs(-2.0 * luma_left + luma_left_corners)
+                            + 2.0 * abs(-2.0 * luma_center + luma_down_up)
+                            + abs(-2.0 * luma_right + luma_right_corners);
+    float edge_vertical = abs(-2.0 * luma_up + luma_up_corners)
+                          + 2.0 * abs(-2.0 * luma_center + luma_left_right)
+                          + abs(-2.0 * luma_down + luma_down_corners);
+
+    bool is_horizontal = edge_horizontal >= edge_vertical;
+
+    // pick the side of the pixel the edge lies on
+
+    float luma_negative = is_horizontal ? luma_up : luma_left;
+    float luma_positive = is_horizontal ? luma_down : luma_right;
+    float gradient_negative = luma_negative - luma_center;
+    float gradient_positive = luma_positive - luma_center;
+
+    bool is_negative_steepest = abs(gradient_negative) >= abs(gradient_positive);
+    float gradient_scaled = 0.25 * max(abs(gradient_negative), abs(gradient_positive));
+
+    float step_length = is_horizontal ? texel_size.y : texel_size.x;
+    float luma_local_average;
+
+    if (is_negative_steepest) {
+        step_length = -step_length;
+        luma_local_average = 0.5 * (luma_negative + luma_center);
+    } else {
+        luma_local_average = 0.5 * (luma_positive + luma_center);
+    }
+
+    // walk along the edge in both directions until its end, starting in between both pixels across it
+
+    vec2 edge_uv = uv;
+    if (is_horizontal) {
+        edge_uv.y += 0.5 * step_length;
+    } else {
+        edge_uv.x += 0.5 * step_length;
+    }
+
+    vec2 search_offset = is_horizontal ? vec2(texel_size.x, 0.0) : vec2(0.0, texel_size.y);
+
+    vec2 uv1 = edge_uv - search_offset * search_step_sizes[0];
+    vec2 uv2 = edge_uv + search_offset * search_step_sizes[0];
+
+    float luma_end1 = sample_luma(uv1) - luma_local_average;
+    float luma_end2 = sample_luma(uv2) - luma_local_average;
+
+    bool reached1 = abs(luma_end1) >= gradient_scaled;
+    bool reached2 = abs(luma_end2) >= gradient_scaled;
+
+    for (int i = 1; i < SEARCH_STEPS && !(reached1 && reached2); i++) {
+        if (!reached1) {
+            uv1 -= search_offset * search_step_sizes[i];
+            luma_end1 = sample_luma(uv1) - luma_local_average;
+            reached1 = abs(luma_end1) >= gradient_scaled;
+        }
+
+        if (!reached2) {
+            uv2 += search_offset * search_step_sizes[i];
+            luma_end2 = sample_luma(uv2) - luma_local_average;
+            reached2 = abs(luma_end2) >= gradient_scaled;
+        }
+    }
+
+    float distance1 = is_horizontal ? uv.x - uv1.x : uv.y - uv1.y;
+    float distance2 = is_horizontal ? uv2.x - uv.x : uv2.y - uv.y;
+
+    bool is_direction1 = distance1 < distance2;
+    float distance_final = min(distance1, distance2);
+    float edge_length = distance1 + distance2;
+
+    // only blend if the closer edge end moves away from the center's luma, otherwise the pixel is past the edge
+    bool is_luma_center_smaller = luma_center < luma_local_average;
+    bool is_correct_variation = ((is_direction1 ? luma_end1 : luma_end2) < 0.0) != is_luma_center_smaller;
+
+    float edge_offset = is_correct_variation ? 0.5 - distance_final / edge_length : 0.0;
+
+    // sub-pixel aliasing, for features thinner than a pixel which the edge search can't handle
+
+    float luma_average = (2.0 * (luma_down_up + luma_left_right) + luma_left_corners + luma_right_corners) / 12.0;
+    float subpixel_offset1 = clamp(abs(luma_average - luma_center) / luma_range, 0.0, 1.0);
+    float subpixel_offset2 = (-2.0 * subpixel_offset1 + 3.0) * subpixel_offset1 * subpixel_offset1;
+    float subpixel_offset = subpixel_offset2 * subpixel_offset2 * SUBPIXEL_QUALITY;
+
+    float final_offset = max(edge_offset, subpixel_offset);
+
+    vec2 final_uv = uv;
+    if (is_horizontal) {
+        final_uv.y += final_offset * step_length;
+    } else {
+        final_uv.x += final_offset * step_length;
+    }
+
+    outColor = vec4(sample_color(final_uv), 1.0);
+}
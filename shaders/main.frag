@@ -4,6 +4,7 @@
 
 #include "utils/ubo.glsl"
 #include "utils/pbr.glsl"
+#include "utils/material.glsl"
 
 layout (location = 0) in vec3 worldPosition;
 layout (location = 1) in vec2 fragTexCoord;
@@ -13,6 +14,7 @@ layout (location = 0) out vec4 outColor;
 
 layout (push_constant) uniform PushConstants {
     uint material_id;
+    uint uses_texture_arrays;
 } constants;
 
 layout (set = 0, binding = 0) uniform UniformBufferObject {
@@ -21,48 +23,149 @@ layout (set = 0, binding = 0) uniform UniformBufferObject {
     MiscData misc;
 } ubo;
 
-layout (set = 0, binding = 1) uniform sampler2D ssaoSampler;
+layout (set = 0, binding = 1) uniform sampler2D ssaoSampler; // already blurred
 
-#define MATERIAL_TEX_ARRAY_SIZE 32
+// keep in sync with `LightClusterGrid`
+#define CLUSTER_GRID_SIZE_X 16
+#define CLUSTER_GRID_SIZE_Y 9
+#define CLUSTER_GRID_SIZE_Z 24
+
+struct PunctualLight {
+    vec4 position_range;
+    vec4 radiance_cos_inner;
+    vec4 direction_cos_outer;
+};
+
+layout (std430, set = 0, binding = 2) readonly buffer LightBuffer {
+    uint light_count;
+    uint framebuffer_width;
+    uint framebuffer_height;
+    PunctualLight lights[];
+} light_buffer;
+
+// x: offset into the light index list, y: light count
+layout (std430, set = 0, binding = 3) readonly buffer LightClusterBuffer {
+    uvec2 clusters[];
+} cluster_buffer;
+
+layout (std430, set = 0, binding = 4) readonly buffer LightIndexBuffer {
+    uint light_indices[];
+} light_index_buffer;
+
+layout (set = 0, binding = 5) uniform sampler2D shadowMapSampler;
 
-layout (set = 1, binding = 0) uniform sampler2D baseColorSamplers[MATERIAL_TEX_ARRAY_SIZE];
-layout (set = 1, binding = 1) uniform sampler2D normalSamplers[MATERIAL_TEX_ARRAY_SIZE];
-layout (set = 1, binding = 2) uniform sampler2D ormSamplers[MATERIAL_TEX_ARRAY_SIZE];
 
 layout (set = 2, binding = 0) uniform samplerCube irradianceMapSampler;
 layout (set = 2, binding = 1) uniform samplerCube prefilterMapSampler;
 layout (set = 2, binding = 2) uniform sampler2D brdfLutSampler;
 
-float getBlurredSsao() {
-    vec2 texCoord = gl_FragCoord.xy / vec2(ubo.window.width, ubo.window.height);
+vec3 evaluate_light(vec3 light_dir, vec3 radiance, vec3 normal, vec3 view, vec3 base_color, vec3 f0,
+                    vec3 k_diffuse, float roughness) {
+    vec3 halfway = normalize(view + light_dir);
+    float n_dot_l = max(dot(normal, light_dir), 0.0);
 
-    vec2 texelSize = vec2(1.0) / vec2(textureSize(ssaoSampler, 0));
-    float result = 0.0;
+    // BRDF intermediate values
+    vec3 fresnel = fresnel_schlick(max(dot(halfway, view), 0.0), f0);
+    float ndf = distribution_ggx(normal, halfway, roughness);
+    float geom = geometry_smith(normal, view, light_dir, roughness);
 
-    for (int x = -2; x < 2; x++) {
-        for (int y = -2; y < 2; y++) {
-            vec2 offset = vec2(x, y) * texelSize;
-            result += texture(ssaoSampler, texCoord + offset).r;
+    // actual BRDF result
+    vec3 num = ndf * geom * fresnel;
+    float denom = 4.0 * max(dot(normal, view), 0.0) * n_dot_l + 0.0001;
+    vec3 specular = num / denom;
+
+    return (k_diffuse * base_color / PI + specular) * radiance * n_dot_l;
+}
+
+// 0 if fully shadowed, 1 if fully lit, filtered over a 3x3 texel neighbourhood
+float get_shadow_factor(vec3 normal, vec3 light_dir) {
+    vec4 light_clip = ubo.matrices.light_view_proj * vec4(worldPosition, 1.0);
+    vec3 light_ndc = light_clip.xyz / light_clip.w;
+
+    // the shadow map is rendered with the same flipped viewport as everything else
+    vec2 uv = vec2(light_ndc.x * 0.5 + 0.5, 0.5 - light_ndc.y * 0.5);
+
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))) || light_ndc.z > 1.0) {
+        return 1.0;
+    }
+
+    // rasterizer depth bias handles most acne, this takes care of grazing angles
+    float bias = 0.002 * (1.0 - max(dot(normal, light_dir), 0.0));
+
+    ivec2 size = textureSize(shadowMapSampler, 0);
+    ivec2 texel = ivec2(uv * vec2(size));
+    float lit = 0.0;
+
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            ivec2 coords = clamp(texel + ivec2(x, y), ivec2(0), size - 1);
+            float occluder_depth = texelFetch(shadowMapSampler, coords, 0).r;
+            lit += light_ndc.z - bias <= occluder_depth ? 1.0 : 0.0;
         }
     }
 
-    return result / (4.0 * 4.0);
+    return lit / 9.0;
+}
+
+uint get_cluster_index() {
+    vec2 framebuffer_size = vec2(light_buffer.framebuffer_width, light_buffer.framebuffer_height);
+    uvec2 tile = uvec2(gl_FragCoord.xy / framebuffer_size * vec2(CLUSTER_GRID_SIZE_X, CLUSTER_GRID_SIZE_Y));
+    tile = min(tile, uvec2(CLUSTER_GRID_SIZE_X - 1, CLUSTER_GRID_SIZE_Y - 1));
+
+    float view_depth = -(ubo.matrices.view * vec4(worldPosition, 1.0)).z;
+    float slice = log(view_depth / ubo.misc.z_near) / log(ubo.misc.z_far / ubo.misc.z_near) * CLUSTER_GRID_SIZE_Z;
+    uint z = uint(clamp(slice, 0.0, float(CLUSTER_GRID_SIZE_Z - 1)));
+
+    return (z * CLUSTER_GRID_SIZE_Y + tile.y) * CLUSTER_GRID_SIZE_X + tile.x;
+}
+
+vec3 evaluate_punctual_lights(vec3 normal, vec3 view, vec3 base_color, vec3 f0, vec3 k_diffuse, float roughness) {
+    uvec2 cluster = cluster_buffer.clusters[get_cluster_index()];
+    vec3 result = vec3(0.0);
+
+    for (uint i = 0; i < cluster.y; i++) {
+        PunctualLight light = light_buffer.lights[light_index_buffer.light_indices[cluster.x + i]];
+
+        vec3 to_light = light.position_range.xyz - worldPosition;
+        float dist_sq = max(dot(to_light, to_light), 1e-4);
+        vec3 light_dir = to_light * inversesqrt(dist_sq);
+
+        // inverse-square falloff, windowed so that it reaches zero at the light's range
+        float range = light.position_range.w;
+        float window = clamp(1.0 - pow(dist_sq / (range * range), 2.0), 0.0, 1.0);
+        float attenuation = window * window / dist_sq;
+
+        float cos_inner = light.radiance_cos_inner.w;
+        float cos_outer = light.direction_cos_outer.w;
+        float cos_angle = dot(-light_dir, light.direction_cos_outer.xyz);
+        float spot = clamp((cos_angle - cos_outer) / max(cos_inner - cos_outer, 1e-4), 0.0, 1.0);
+
+        vec3 radiance = light.radiance_cos_inner.rgb * attenuation * spot * spot;
+        result += evaluate_light(light_dir, radiance, normal, view, base_color, f0, k_diffuse, roughness);
+    }
+
+    return result;
 }
 
 void main() {
-    vec4 base_color = texture(baseColorSamplers[constants.material_id], fragTexCoord);
+    uint material_id = constants.material_id;
+    uint uses_arrays = constants.uses_texture_arrays;
+
+    vec4 base_color = sample_base_color(material_id, uses_arrays, fragTexCoord);
 
     if (base_color.a < 0.1) discard;
 
-    vec3 normal = texture(normalSamplers[constants.material_id], fragTexCoord).rgb;
+    vec3 normal = sample_normal(material_id, uses_arrays, fragTexCoord).rgb;
     normal = normalize(normal * 2.0 - 1.0);
     normal = normalize(TBN * normal);
 
+    vec3 orm = sample_orm(material_id, uses_arrays, fragTexCoord).rgb;
+
     float ao = ubo.misc.use_ssao == 1u
-        ? getBlurredSsao()
-        : texture(ormSamplers[constants.material_id], fragTexCoord).r;
-    float roughness = texture(ormSamplers[constants.material_id], fragTexCoord).g;
-    float metallic = texture(ormSamplers[constants.material_id], fragTexCoord).b;
+        ? texelFetch(ssaoSampler, ivec2(gl_FragCoord.xy), 0).r
+        : orm.r;
+    float roughness = orm.g;
+    float metallic = orm.b;
 
     // light related values
     vec3 light_dir = normalize(ubo.misc.light_direction);
@@ -71,29 +174,20 @@ void main() {
 
     // utility vectors
     vec3 view = normalize(ubo.misc.camera_pos - worldPosition);
-    vec3 halfway = normalize(view + light_dir);
-
-    // utility dot products
     float n_dot_v = max(dot(normal, view), 0.0);
-    float h_dot_v = max(dot(halfway, view), 0.0);
-    float n_dot_l = max(dot(normal, light_dir), 0.0);
 
-    // BRDF intermediate values
     vec3 f0 = mix(vec3(0.04), base_color.rgb, metallic);
-    vec3 fresnel = fresnel_schlick(max(dot(halfway, view), 0.0), f0);
-    float ndf = distribution_ggx(normal, halfway, roughness);
-    float geom = geometry_smith(normal, view, light_dir, roughness);
-
-    // actual BRDF result
-    vec3 num = ndf * geom * fresnel;
-    float denom = 4.0 * max(dot(normal, view), 0.0) * max(dot(normal, light_dir), 0.0) + 0.0001;
-    vec3 specular = num / denom;
 
     // k-terms specifying reflection vs refraction contributions
     vec3 k_specular = fresnel_schlick_roughness(n_dot_v, f0, roughness);
     vec3 k_diffuse = (vec3(1.0) - k_specular) * (1.0 - metallic);
 
-    vec3 out_radiance = (k_diffuse * base_color.rgb / PI + specular) * radiance * n_dot_l;
+    if (ubo.misc.use_shadows == 1u) {
+        radiance *= get_shadow_factor(normal, light_dir);
+    }
+
+    vec3 out_radiance = evaluate_light(light_dir, radiance, normal, view, base_color.rgb, f0, k_diffuse, roughness);
+    out_radiance += evaluate_punctual_lights(normal, view, base_color.rgb, f0, k_diffuse, roughness);
 
     vec3 ambient;
 
@@ -106,7 +200,7 @@ void main() {
         vec3 prefiltered_color = textureLod(prefilterMapSampler, reflection, roughness * MAX_REFLECTION_LOD).rgb;
 
         vec2 env_brdf = texture(brdfLutSampler, vec2(n_dot_v, roughness)).rg;
-        specular = prefiltered_color * (k_specular * env_brdf.x + env_brdf.y);
+        vec3 specular = prefiltered_color * (k_specular * env_brdf.x + env_brdf.y);
 
         // no need to multiply `specular` by `k_specular` as it's done implicitly by including fresnel
         ambient = (k_diffuse * diffuse + specular) * ao;
@@ -117,11 +211,6 @@ void main() {
 
     vec3 color = ambient + out_radiance;
 
-    // apply hdr tonemapping
-    color = color / (color + vec3(1.0));
-
-    // apply gamma correction
-    color = pow(color, vec3(1 / 2.2));
-
+    // output stays in linear hdr, tonemapping and gamma correction are applied after the taa resolve
     outColor = vec4(color, 1.0);
 }
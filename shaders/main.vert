@@ -1,18 +1,21 @@
 #version 450
 
 #include "utils/ubo.glsl"
+#include "utils/instance.glsl"
 
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec2 inTexCoord;
 layout (location = 2) in vec3 inNormal;
 layout (location = 3) in vec3 inTangent;
 layout (location = 4) in vec3 inBitangent;
-layout (location = 5) in mat4 inInstanceTransform;
 
 layout (location = 0) out vec3 worldPosition;
 layout (location = 1) out vec2 fragTexCoord;
 layout (location = 2) out mat3 TBN;
 
+// depth is tested against the prepass, which has to produce bit-identical positions
+invariant gl_Position;
+
 layout(binding = 0) uniform UniformBufferObject {
     WindowRes window;
     Matrices matrices;
@@ -20,7 +23,8 @@ layout(binding = 0) uniform UniformBufferObject {
 } ubo;
 
 void main() {
-    const mat4 model = ubo.matrices.model * inInstanceTransform;
+    const mat4 instance_transform = get_instance_transform();
+    const mat4 model = ubo.matrices.model * instance_transform;
     const mat4 mvp = ubo.matrices.proj * ubo.matrices.view * model;
 
     gl_Position = mvp * vec4(inPosition, 1.0);
@@ -28,7 +32,7 @@ void main() {
     worldPosition = (model * vec4(inPosition, 1.0)).xyz;
     fragTexCoord = inTexCoord;
 
-    mat3 normal_matrix = transpose(inverse(mat3(model)));
+    mat3 normal_matrix = mat3(ubo.matrices.model_normal) * get_instance_normal_matrix();
 
     vec3 T = normalize(normal_matrix * inTangent);
     vec3 B = normalize(normal_matrix * inBitangent);
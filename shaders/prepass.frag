@@ -1,13 +1,21 @@
 #version 450
 
 #include "utils/ubo.glsl"
+#include "utils/gbuffer.glsl"
+#include "utils/material.glsl"
 
 layout (location = 0) in vec2 texCoord;
-layout (location = 1) in vec3 fragPos;
-layout (location = 2) in vec3 normal;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec4 currentClipPos;
+layout (location = 3) in vec4 prevClipPos;
 
-layout (location = 0) out vec3 outNormal;
-layout (location = 1) out vec3 outPos;
+layout (location = 0) out ivec2 outNormal;
+layout (location = 1) out vec2 outVelocity;
+
+layout (push_constant) uniform PushConstants {
+    uint material_id;
+    uint uses_texture_arrays;
+} constants;
 
 layout (binding = 0) uniform UniformBufferObject {
     WindowRes window;
@@ -18,7 +26,13 @@ layout (binding = 0) uniform UniformBufferObject {
 layout (binding = 1) uniform sampler2D normalSampler;
 
 void main() {
-    outNormal = normalize(normal);
+    // same cutout as in the scene pass, otherwise transparent texels would occlude what's behind them
+    if (sample_base_color(constants.material_id, constants.uses_texture_arrays, texCoord).a < 0.1) discard;
+
+    outNormal = pack_normal(normalize(normal));
 
-    outPos = fragPos;
+    // uv offset from the previous frame's position, with y flipped as ndc y points up
+    vec2 current_ndc = currentClipPos.xy / currentClipPos.w;
+    vec2 prev_ndc = prevClipPos.xy / prevClipPos.w;
+    outVelocity = (current_ndc - prev_ndc) * vec2(0.5, -0.5);
 }
@@ -1,17 +1,21 @@
 #version 450
 
 #include "utils/ubo.glsl"
+#include "utils/instance.glsl"
 
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec2 inTexCoord;
 layout (location = 2) in vec3 inNormal;
 layout (location = 3) in vec3 inTangent;
 layout (location = 4) in vec3 inBitangent;
-layout (location = 5) in mat4 inInstanceTransform;
 
 layout (location = 0) out vec2 fragTexCoord;
-layout (location = 1) out vec3 fragPos;
-layout (location = 2) out vec3 normal;
+layout (location = 1) out vec3 normal;
+layout (location = 2) out vec4 currentClipPos;
+layout (location = 3) out vec4 prevClipPos;
+
+// the scene pass depth-tests against this pass' depth, so both have to produce bit-identical positions
+invariant gl_Position;
 
 layout(binding = 0) uniform UniformBufferObject {
     WindowRes window;
@@ -20,14 +24,20 @@ layout(binding = 0) uniform UniformBufferObject {
 } ubo;
 
 void main() {
-    const mat4 model = ubo.matrices.model * inInstanceTransform;
+    const mat4 instance_transform = get_instance_transform();
+    const mat4 model = ubo.matrices.model * instance_transform;
+    const mat4 mvp = ubo.matrices.proj * ubo.matrices.view * model;
+
+    gl_Position = mvp * vec4(inPosition, 1.0);
 
-    vec4 view_pos = ubo.matrices.view * model * vec4(inPosition, 1.0);
-    fragPos = view_pos.xyz;
-    gl_Position = ubo.matrices.proj * view_pos;
+    // instances have no previous transforms, so only the model matrix and the camera contribute to motion.
+    // they rarely change, and progressive accumulation restarts when they do
+    currentClipPos = ubo.matrices.unjittered_view_proj * model * vec4(inPosition, 1.0);
+    prevClipPos = ubo.matrices.prev_view_proj * ubo.matrices.prev_model * instance_transform * vec4(inPosition, 1.0);
 
     fragTexCoord = inTexCoord;
 
-    mat3 normal_matrix = transpose(inverse(mat3(ubo.matrices.view * model)));
+    // the view matrix is a rotation, so it's its own inverse transpose
+    mat3 normal_matrix = mat3(ubo.matrices.view) * mat3(ubo.matrices.model_normal) * get_instance_normal_matrix();
     normal = normal_matrix * inNormal;
 }
@@ -0,0 +1,15 @@
+#version 450
+
+#include "utils/material.glsl"
+
+layout (location = 0) in vec2 texCoord;
+
+layout (push_constant) uniform PushConstants {
+    uint material_id;
+    uint uses_texture_arrays;
+} constants;
+
+void main() {
+    // cutout texels shouldn't cast shadows, same as they don't occlude anything in the prepass
+    if (sample_base_color(constants.material_id, constants.uses_texture_arrays, texCoord).a < 0.1) discard;
+}
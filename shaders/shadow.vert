@@ -0,0 +1,27 @@
+#version 450
+
+#include "utils/ubo.glsl"
+#include "utils/instance.glsl"
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec2 inTexCoord;
+layout (location = 2) in vec3 inNormal;
+layout (location = 3) in vec3 inTangent;
+layout (location = 4) in vec3 inBitangent;
+
+layout (location = 0) out vec2 fragTexCoord;
+
+layout(binding = 0) uniform UniformBufferObject {
+    WindowRes window;
+    Matrices matrices;
+    MiscData misc;
+} ubo;
+
+void main() {
+    const mat4 instance_transform = get_instance_transform();
+    const mat4 model = ubo.matrices.model * instance_transform;
+
+    gl_Position = ubo.matrices.light_view_proj * model * vec4(inPosition, 1.0);
+
+    fragTexCoord = inTexCoord;
+}
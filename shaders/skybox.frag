@@ -17,7 +17,5 @@ layout(binding = 1) uniform samplerCube skyboxTexSampler;
 void main() {
     vec3 color = texture(skyboxTexSampler, texCoord).rgb;
 
-    color = pow(color, vec3(1 / 2.2));
-
     outColor = vec4(color, 1.0);
 }
@@ -7,5 +7,6 @@ layout(location = 0) out vec4 outColor;
 layout(binding = 0) uniform sampler2D texSampler;
 
 void main() {
-    outColor = vec4(texture(texSampler, texCoords).rgb, 1.0);
+    // the debug quad shows the single-channel ao texture
+    outColor = vec4(vec3(texture(texSampler, texCoords).r), 1.0);
 }
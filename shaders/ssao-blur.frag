@@ -0,0 +1,60 @@
+#version 450
+
+#include "utils/ubo.glsl"
+
+layout (location = 0) in vec2 texCoords;
+
+layout (location = 0) out float outAo;
+
+layout (push_constant) uniform PushConstants {
+    ivec2 direction;
+} constants;
+
+layout (binding = 0) uniform UniformBufferObject {
+    WindowRes window;
+    Matrices matrices;
+    MiscData misc;
+} ubo;
+
+layout (binding = 1) uniform sampler2D aoSampler;
+layout (binding = 2) uniform sampler2D gDepthSampler;
+
+#define BLUR_RADIUS 4
+
+// relative view-space depth difference at which a neighbour stops contributing
+#define DEPTH_SHARPNESS 0.05
+
+const float gauss_weights[BLUR_RADIUS + 1] = float[BLUR_RADIUS + 1](
+    0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216
+);
+
+float linearize_depth(float depth) {
+    float z_near = ubo.misc.z_near;
+    float z_far = ubo.misc.z_far;
+    return z_near * z_far / (z_far - depth * (z_far - z_near));
+}
+
+void main() {
+    ivec2 size = ivec2(ubo.window.render_width, ubo.window.render_height);
+    ivec2 center = ivec2(gl_FragCoord.xy);
+
+    float center_depth = linearize_depth(texelFetch(gDepthSampler, center, 0).r);
+
+    float result = texelFetch(aoSampler, center, 0).r * gauss_weights[0];
+    float weight_sum = gauss_weights[0];
+
+    for (int i = 1; i <= BLUR_RADIUS; i++) {
+        for (int side = -1; side <= 1; side += 2) {
+            ivec2 coords = clamp(center + constants.direction * i * side, ivec2(0), size - 1);
+
+            float sample_depth = linearize_depth(texelFetch(gDepthSampler, coords, 0).r);
+            float depth_weight = max(0.0, 1.0 - abs(sample_depth - center_depth) / (center_depth * DEPTH_SHARPNESS));
+            float weight = gauss_weights[i] * depth_weight;
+
+            result += texelFetch(aoSampler, coords, 0).r * weight;
+            weight_sum += weight;
+        }
+    }
+
+    outAo = result / weight_sum;
+}
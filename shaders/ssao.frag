@@ -1,6 +1,7 @@
 #version 450
 
 #include "utils/ubo.glsl"
+#include "utils/gbuffer.glsl"
 
 layout (location = 0) in vec2 texCoords;
 
@@ -13,11 +14,11 @@ layout (binding = 0) uniform UniformBufferObject {
 } ubo;
 
 layout (binding = 1) uniform sampler2D gDepthSampler;
-layout (binding = 2) uniform sampler2D gNormalSampler;
-layout (binding = 3) uniform sampler2D gPosSampler;
-layout (binding = 4) uniform sampler2D noiseSampler;
+layout (binding = 2) uniform isampler2D gNormalSampler;
+layout (binding = 3) uniform sampler2D noiseSampler;
 
 #define KERNEL_SIZE 64
+#define GOLDEN_ANGLE 2.39996323
 
 const vec3 ssao_kernel[KERNEL_SIZE] = vec3[KERNEL_SIZE](
     vec3(0.0497709, -0.0447092, 0.0499634),
@@ -86,21 +87,35 @@ const vec3 ssao_kernel[KERNEL_SIZE] = vec3[KERNEL_SIZE](
     vec3(-0.442722, -0.679282, 0.186503)
 );
 
+vec3 get_view_pos(vec2 tex_coords) {
+    // depth formats aren't guaranteed to support linear filtering, so fetch the nearest texel directly
+    ivec2 size = ivec2(ubo.window.render_width, ubo.window.render_height);
+    ivec2 texel = clamp(ivec2(tex_coords * vec2(size)), ivec2(0), size - 1);
+    float depth = texelFetch(gDepthSampler, texel, 0).r;
+
+    return view_pos_from_depth(tex_coords, depth, ubo.matrices.inverse_proj);
+}
+
 void main() {
     const float radius = 0.2;
 
-    vec3 normal = normalize(texture(gNormalSampler, texCoords).xyz);
-    vec3 frag_pos = texture(gPosSampler, texCoords).xyz;
+    vec3 normal = unpack_normal(texelFetch(gNormalSampler, ivec2(gl_FragCoord.xy), 0).xy);
+    vec3 frag_pos = get_view_pos(texCoords);
 
     normal.y *= -1;
     frag_pos.y *= -1;
 
-    const vec2 noise_scale = vec2(ubo.window.width, ubo.window.height) / 4.0;
+    const vec2 noise_scale = vec2(ubo.window.render_width, ubo.window.render_height) / 4.0;
     vec3 random_vec = texture(noiseSampler, texCoords * noise_scale).xyz;
     random_vec = normalize(random_vec);
 
     vec3 tangent = normalize(random_vec - normal * dot(random_vec, normal)); // gramm-schmidt
     vec3 bitangent = cross(normal, tangent);
+
+    // while a static view is being accumulated, every frame rotates the kernel differently so the noise averages out
+    float noise_angle = float(ubo.misc.accumulated_frames) * GOLDEN_ANGLE;
+    tangent = cos(noise_angle) * tangent + sin(noise_angle) * bitangent;
+    bitangent = cross(normal, tangent);
     mat3 tbn = mat3(tangent, bitangent, normal);
 
     float occlusion = 0.0;
@@ -112,7 +127,7 @@ void main() {
         sample_clip_pos.xyz /= sample_clip_pos.w;
         sample_clip_pos.xyz = sample_clip_pos.xyz * 0.5 + 0.5;
 
-        float sample_depth = texture(gPosSampler, sample_clip_pos.xy).z;
+        float sample_depth = get_view_pos(sample_clip_pos.xy).z;
 
         float rangeCheck = smoothstep(0.0, 1.0, radius / abs(frag_pos.z - sample_depth));
 
@@ -0,0 +1,149 @@
+#version 450
+
+#include "utils/ubo.glsl"
+
+layout (location = 0) in vec2 texCoords;
+
+layout (location = 0) out vec4 outColor;
+
+layout (push_constant) uniform PushConstants {
+    uint history_valid;
+} constants;
+
+layout (binding = 0) uniform UniformBufferObject {
+    WindowRes window;
+    Matrices matrices;
+    MiscData misc;
+} ubo;
+
+layout (binding = 1) uniform sampler2D sceneColorSampler;
+layout (binding = 2) uniform sampler2D historySampler;
+layout (binding = 3) uniform sampler2D gVelocitySampler;
+layout (binding = 4) uniform sampler2D gDepthSampler;
+
+#define HISTORY_WEIGHT 0.9
+#define VARIANCE_CLIP_GAMMA 1.0
+
+float luminance(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// the resolve works on luminance-compressed colors, otherwise a single very bright sample
+// would dominate both the neighborhood statistics and the blend, and flicker
+vec3 compress(vec3 color) {
+    return color / (1.0 + luminance(color));
+}
+
+vec3 uncompress(vec3 color) {
+    return color / max(1.0 - luminance(color), 1e-4);
+}
+
+vec3 rgb_to_ycocg(vec3 color) {
+    return vec3(
+        0.25 * color.r + 0.5 * color.g + 0.25 * color.b,
+        0.5 * color.r - 0.5 * color.b,
+        -0.25 * color.r + 0.5 * color.g - 0.25 * color.b
+    );
+}
+
+vec3 ycocg_to_rgb(vec3 color) {
+    return vec3(
+        color.x + color.y - color.z,
+        color.x + color.z,
+        color.x - color.y - color.z
+    );
+}
+
+// moves the history towards the center of the box instead of clamping every channel on its own,
+// which would shift its hue
+vec3 clip_to_box(vec3 history, vec3 box_min, vec3 box_max) {
+    vec3 center = 0.5 * (box_max + box_min);
+    vec3 extents = 0.5 * (box_max - box_min) + 1e-4;
+    vec3 offset = history - center;
+
+    vec3 units = abs(offset / extents);
+    float max_unit = max(units.x, max(units.y, units.z));
+
+    return max_unit > 1.0 ? center + offset / max_unit : history;
+}
+
+void main() {
+    ivec2 size = ivec2(ubo.window.render_width, ubo.window.render_height);
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    vec3 current = texelFetch(sceneColorSampler, pixel, 0).rgb;
+
+    // progressive accumulation of a static view: nothing moved, so there's nothing to reproject or reject,
+    // and the history is an unbiased average of its frames
+    if (constants.history_valid == 1u && ubo.misc.accumulated_frames > 0u) {
+        vec3 history = texelFetch(historySampler, pixel, 0).rgb;
+        outColor = vec4(mix(history, current, 1.0 / float(ubo.misc.accumulated_frames + 1u)), 1.0);
+        return;
+    }
+
+    // neighborhood statistics, and the closest surface around the pixel. using its motion
+    // lets edges of foreground objects keep their history when moving over the background
+
+    vec3 moment1 = vec3(0.0);
+    vec3 moment2 = vec3(0.0);
+    float closest_depth = 1.0;
+    ivec2 closest_pixel = pixel;
+
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            ivec2 coords = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+
+            vec3 color = rgb_to_ycocg(compress(texelFetch(sceneColorSampler, coords, 0).rgb));
+            moment1 += color;
+            moment2 += color * color;
+
+            float depth = texelFetch(gDepthSampler, coords, 0).r;
+            if (depth < closest_depth) {
+                closest_depth = depth;
+                closest_pixel = coords;
+            }
+        }
+    }
+
+    vec2 uv = (vec2(pixel) + 0.5) / vec2(size);
+    vec2 velocity;
+
+    if (closest_depth < 1.0) {
+        velocity = texelFetch(gVelocitySampler, closest_pixel, 0).rg;
+    } else {
+        // the background isn't rasterized by the prepass, so its motion comes from the camera alone
+        vec4 world_pos = ubo.matrices.inverse_vp * vec4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, 1.0, 1.0);
+        world_pos /= world_pos.w;
+
+        vec4 current_clip = ubo.matrices.unjittered_view_proj * world_pos;
+        vec4 prev_clip = ubo.matrices.prev_view_proj * world_pos;
+        velocity = (current_clip.xy / current_clip.w - prev_clip.xy / prev_clip.w) * vec2(0.5, -0.5);
+    }
+
+    vec2 prev_uv = uv - velocity;
+
+    bool is_on_screen = all(greaterThanEqual(prev_uv, vec2(0.0))) && all(lessThanEqual(prev_uv, vec2(1.0)));
+
+    if (constants.history_valid == 0u || !is_on_screen) {
+        outColor = vec4(current, 1.0);
+        return;
+    }
+
+    // the history only covers the top-left part of a screen-sized texture
+    vec2 history_size = vec2(textureSize(historySampler, 0));
+    vec2 history_pos = clamp(prev_uv * vec2(size), vec2(0.5), vec2(size) - 0.5);
+    vec3 history = textureLod(historySampler, history_pos / history_size, 0.0).rgb;
+
+    vec3 mean = moment1 / 9.0;
+    vec3 sigma = sqrt(max(moment2 / 9.0 - mean * mean, vec3(0.0)));
+
+    vec3 clipped_history = clip_to_box(
+        rgb_to_ycocg(compress(history)),
+        mean - VARIANCE_CLIP_GAMMA * sigma,
+        mean + VARIANCE_CLIP_GAMMA * sigma
+    );
+
+    vec3 resolved = mix(rgb_to_ycocg(compress(current)), clipped_history, HISTORY_WEIGHT);
+
+    outColor = vec4(uncompress(ycocg_to_rgb(resolved)), 1.0);
+}
@@ -0,0 +1,64 @@
+#version 450
+
+layout (location = 0) in vec2 texCoords;
+
+layout (location = 0) out vec4 outColor;
+
+layout (push_constant) uniform PushConstants {
+    vec2 uv_scale; // part of the scene color texture that was rendered into this frame
+} constants;
+
+layout (binding = 0) uniform sampler2D sceneColorSampler; // linear hdr
+
+// catmull-rom bicubic filter, with the 4x4 texel footprint folded into 9 bilinear taps
+vec3 sample_catmull_rom(vec2 uv) {
+    vec2 tex_size = vec2(textureSize(sceneColorSampler, 0));
+    vec2 sample_pos = uv * tex_size;
+    vec2 tex_pos1 = floor(sample_pos - 0.5) + 0.5;
+    vec2 f = sample_pos - tex_pos1;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 offset12 = w2 / w12;
+
+    // texels outside the rendered region hold stale contents from frames rendered at a higher scale
+    vec2 min_pos = vec2(0.5);
+    vec2 max_pos = constants.uv_scale * tex_size - 0.5;
+
+    vec2 uv0 = clamp(tex_pos1 - 1.0, min_pos, max_pos) / tex_size;
+    vec2 uv12 = clamp(tex_pos1 + offset12, min_pos, max_pos) / tex_size;
+    vec2 uv3 = clamp(tex_pos1 + 2.0, min_pos, max_pos) / tex_size;
+
+    vec3 result = vec3(0.0);
+
+    result += textureLod(sceneColorSampler, vec2(uv0.x, uv0.y), 0.0).rgb * w0.x * w0.y;
+    result += textureLod(sceneColorSampler, vec2(uv12.x, uv0.y), 0.0).rgb * w12.x * w0.y;
+    result += textureLod(sceneColorSampler, vec2(uv3.x, uv0.y), 0.0).rgb * w3.x * w0.y;
+
+    result += textureLod(sceneColorSampler, vec2(uv0.x, uv12.y), 0.0).rgb * w0.x * w12.y;
+    result += textureLod(sceneColorSampler, vec2(uv12.x, uv12.y), 0.0).rgb * w12.x * w12.y;
+    result += textureLod(sceneColorSampler, vec2(uv3.x, uv12.y), 0.0).rgb * w3.x * w12.y;
+
+    result += textureLod(sceneColorSampler, vec2(uv0.x, uv3.y), 0.0).rgb * w0.x * w3.y;
+    result += textureLod(sceneColorSampler, vec2(uv12.x, uv3.y), 0.0).rgb * w12.x * w3.y;
+    result += textureLod(sceneColorSampler, vec2(uv3.x, uv3.y), 0.0).rgb * w3.x * w3.y;
+
+    // the negative lobes can overshoot on hard edges
+    return max(result, vec3(0.0));
+}
+
+void main() {
+    vec3 color = sample_catmull_rom(texCoords * constants.uv_scale);
+
+    // apply hdr tonemapping
+    color = color / (color + vec3(1.0));
+
+    // apply gamma correction
+    color = pow(color, vec3(1 / 2.2));
+
+    outColor = vec4(color, 1.0);
+}
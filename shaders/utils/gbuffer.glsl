@@ -0,0 +1,36 @@
+// octahedral normal encoding, see "A Survey of Efficient Representations for Independent Unit Vectors"
+
+vec2 oct_wrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 encode_normal(vec3 normal) {
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    return normal.z >= 0.0 ? normal.xy : oct_wrap(normal.xy);
+}
+
+vec3 decode_normal(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -t : t;
+    normal.y += normal.y >= 0.0 ? -t : t;
+    return normalize(normal);
+}
+
+// the g-buffer stores the encoding as integers, so that the msaa resolve picks one sample
+// instead of averaging encodings from both sides of the octahedron fold
+ivec2 pack_normal(vec3 normal) {
+    return ivec2(round(encode_normal(normal) * 32767.0));
+}
+
+vec3 unpack_normal(ivec2 packed) {
+    return decode_normal(vec2(packed) / 32767.0);
+}
+
+// reconstructs a view-space position from a depth buffer value at given texture coordinates.
+// texture rows go top to bottom while NDC y goes bottom to top (the viewport is flipped), hence the `1 - y`.
+vec3 view_pos_from_depth(vec2 tex_coords, float depth, mat4 inverse_proj) {
+    vec4 ndc = vec4(tex_coords.x * 2.0 - 1.0, 1.0 - tex_coords.y * 2.0, depth, 1.0);
+    vec4 view_pos = inverse_proj * ndc;
+    return view_pos.xyz / view_pos.w;
+}
@@ -0,0 +1,20 @@
+// per-instance vertex attributes, keep in sync with `ModelInstance` and `ModelVertex::getAttributeDescriptions`
+
+// top three rows of the instance's affine transform
+layout (location = 5) in vec4 inInstanceTransformRows[3];
+
+// columns of the instance's normal matrix, arbitrarily scaled
+layout (location = 8) in vec3 inInstanceNormalMatrix[3];
+
+mat4 get_instance_transform() {
+    return transpose(mat4(
+        inInstanceTransformRows[0],
+        inInstanceTransformRows[1],
+        inInstanceTransformRows[2],
+        vec4(0.0, 0.0, 0.0, 1.0)
+    ));
+}
+
+mat3 get_instance_normal_matrix() {
+    return mat3(inInstanceNormalMatrix[0], inInstanceNormalMatrix[1], inInstanceNormalMatrix[2]);
+}
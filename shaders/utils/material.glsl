@@ -0,0 +1,43 @@
+// keep in sync with `VulkanRenderer::createMaterialsDescriptorSet`
+#define MATERIAL_TEX_ARRAY_SIZE 32
+#define MAX_MATERIAL_TEXTURE_ARRAYS (3 * MATERIAL_TEX_ARRAY_SIZE)
+
+layout (set = 1, binding = 0) uniform sampler2D baseColorSamplers[MATERIAL_TEX_ARRAY_SIZE];
+layout (set = 1, binding = 1) uniform sampler2D normalSamplers[MATERIAL_TEX_ARRAY_SIZE];
+layout (set = 1, binding = 2) uniform sampler2D ormSamplers[MATERIAL_TEX_ARRAY_SIZE];
+
+// only used if the model's material textures were packed, in which case the bindings above are unused
+layout (set = 1, binding = 3) uniform sampler2DArray materialTextureArrays[MAX_MATERIAL_TEXTURE_ARRAYS];
+
+// x: index into `materialTextureArrays`, y: layer within that array
+struct MaterialTextureLayers {
+    uvec2 base_color;
+    uvec2 normal;
+    uvec2 orm;
+};
+
+layout (std430, set = 1, binding = 4) readonly buffer MaterialTextureLayersBuffer {
+    MaterialTextureLayers materials[];
+} material_layers_buffer;
+
+vec4 sample_packed(uvec2 location, vec2 uv) {
+    return texture(materialTextureArrays[location.x], vec3(uv, float(location.y)));
+}
+
+vec4 sample_base_color(uint material_id, uint uses_texture_arrays, vec2 uv) {
+    return uses_texture_arrays == 1u
+        ? sample_packed(material_layers_buffer.materials[material_id].base_color, uv)
+        : texture(baseColorSamplers[material_id], uv);
+}
+
+vec4 sample_normal(uint material_id, uint uses_texture_arrays, vec2 uv) {
+    return uses_texture_arrays == 1u
+        ? sample_packed(material_layers_buffer.materials[material_id].normal, uv)
+        : texture(normalSamplers[material_id], uv);
+}
+
+vec4 sample_orm(uint material_id, uint uses_texture_arrays, vec2 uv) {
+    return uses_texture_arrays == 1u
+        ? sample_packed(material_layers_buffer.materials[material_id].orm, uv)
+        : texture(ormSamplers[material_id], uv);
+}
@@ -1,6 +1,8 @@
 struct WindowRes {
     uint width;
     uint height;
+    uint render_width; // internal resolution, which only covers the top-left part of screen-sized targets
+    uint render_height;
 };
 
 struct Matrices {
@@ -8,9 +10,15 @@ struct Matrices {
     mat4 view;
     mat4 proj;
     mat4 inverse_vp;
+    mat4 inverse_proj;
     mat4 static_view;
     mat4 cubemap_capture_views[6];
     mat4 cubemap_capture_proj;
+    mat4 light_view_proj;
+    mat4 unjittered_view_proj; // without the taa jitter, which motion vectors shouldn't include
+    mat4 prev_view_proj; // previous frame's, also unjittered
+    mat4 prev_model;
+    mat4 model_normal; // inverse transpose of the model matrix' upper 3x3, instances carry their own
 };
 
 struct MiscData {
@@ -19,6 +27,8 @@ struct MiscData {
     float z_far;
     uint use_ssao;
     uint use_ibl;
+    uint use_shadows;
+    uint accumulated_frames; // frames of a static view already averaged into the taa history, zero if not accumulating
     float light_intensity;
     vec3 light_direction;
     vec3 light_color;
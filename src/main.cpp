@@ -9,6 +9,7 @@
 
 #include "render/renderer.h"
 #include "render/gui/gui.h"
+#include "thumbnail-batch.h"
 #include "utils/input-manager.h"
 #include "utils/file-type.h"
 
@@ -56,6 +57,11 @@ private:
         inputManager->tick(deltaTime);
         renderer.tick(deltaTime);
 
+        if (!renderer.needsRedraw()) {
+            renderer.waitForEvents();
+            return;
+        }
+
         if (renderer.startFrame()) {
             if (isGuiEnabled) {
                 renderer.renderGui([&] {
@@ -64,14 +70,22 @@ private:
                 });
             }
 
+            renderer.runSkinningPass();
+            renderer.runShadowPass();
             renderer.runPrepass();
+            renderer.runCullingPass();
             renderer.runSsaoPass();
+            renderer.runSsaoBlurPass();
             renderer.drawScene();
+            renderer.runTaaPass();
+            renderer.runFxaaPass();
 
             if (showDebugQuad) {
                 renderer.drawDebugQuad();
             }
 
+            renderer.runUpscalePass();
+
             renderer.endFrame();
         }
 
@@ -300,12 +314,29 @@ void generateSsaoKernelSamples() {
     }
 }
 
-int main() {
+static int runThumbnailBatch(const std::vector<std::string> &args) {
+    try {
+        ThumbnailBatch batch(ThumbnailBatchSettings::fromArgs(args));
+        return batch.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+int main(const int argc, char *argv[]) {
     if (!glfwInit()) {
         showErrorBox("Fatal error: GLFW initialization failed.");
         return EXIT_FAILURE;
     }
 
+    // batch mode, reporting to the console instead of showing anything
+    if (argc > 1 && std::string_view(argv[1]) == "--thumbnails") {
+        const int result = runThumbnailBatch({argv + 2, argv + argc});
+        glfwTerminate();
+        return result;
+    }
+
 #ifdef NDEBUG
     try {
         Engine engine;
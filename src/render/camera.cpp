@@ -83,6 +83,12 @@ void Camera::tick(const float deltaTime) {
     updateVecs();
 }
 
+void Camera::setOrbit(const glm::vec2 rotation, const float radius) {
+    isLockedCam = true;
+    lockedRotator = rotation;
+    lockedRadius = radius;
+}
+
 glm::mat4 Camera::getViewMatrix() const {
     return glm::lookAt(pos, pos + front, glm::vec3(0, 1, 0));
 }
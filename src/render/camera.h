@@ -62,6 +62,12 @@ public:
 
     [[nodiscard]] std::pair<float, float> getClippingPlanes() const { return {zNear, zFar}; }
 
+    /**
+     * Switches to the locked mode, orbiting the origin at `radius` with the given yaw and pitch.
+     * Takes effect on the next tick.
+     */
+    void setOrbit(glm::vec2 rotation, float radius);
+
     void renderGuiSection();
 
 private:
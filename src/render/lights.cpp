@@ -0,0 +1,141 @@
+#include "lights.h"
+
+#include <algorithm>
+#include <cmath>
+
+LightClusterGrid::LightClusterGrid() : clusters(CLUSTER_COUNT) {
+    lightData.reserve(MAX_LIGHTS);
+    lightClusterRanges.reserve(MAX_LIGHTS);
+}
+
+void LightClusterGrid::build(const std::vector<PunctualLight> &lights, const glm::mat4 &view, const glm::mat4 &proj,
+                             const float zNear, const float zFar) {
+    lightData.clear();
+    lightClusterRanges.clear();
+    lightIndices.clear();
+    std::ranges::fill(clusters, glm::uvec2(0));
+
+    // maps a range of ndc coordinates to a range of tiles, returns false if it's entirely off-screen
+    const auto getTileRange = [](const float ndcMin, const float ndcMax, const uint32_t gridSize,
+                                 uint32_t &tileMin, uint32_t &tileMax) {
+        if (ndcMax < -1.0f || ndcMin > 1.0f) {
+            return false;
+        }
+
+        const auto toTile = [&](const float ndc) {
+            const auto tile = static_cast<int32_t>(std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(gridSize)));
+            return static_cast<uint32_t>(std::clamp(tile, 0, static_cast<int32_t>(gridSize) - 1));
+        };
+
+        tileMin = toTile(ndcMin);
+        tileMax = toTile(ndcMax);
+        return true;
+    };
+
+    for (const auto &light: lights) {
+        if (lightData.size() == MAX_LIGHTS) {
+            break;
+        }
+
+        const glm::vec3 center = view * glm::vec4(light.position, 1.0f);
+        const float depth = -center.z;
+        const float r = light.range;
+
+        if (depth + r < zNear || depth - r > zFar) {
+            continue;
+        }
+
+        const float depthMin = std::max(depth - r, zNear);
+        const float depthMax = std::min(depth + r, zFar);
+
+        // conservative ndc bounds of the sphere's view-space bounding box: a coordinate projects furthest
+        // from the center of the screen at the nearest depth if it points away from it, and at the farthest otherwise
+        const auto getNdcBounds = [&](const float coordMin, const float coordMax, const float scale) {
+            const float lo = scale * (coordMin < 0 ? coordMin / depthMin : coordMin / depthMax);
+            const float hi = scale * (coordMax > 0 ? coordMax / depthMin : coordMax / depthMax);
+            return glm::vec2(lo, hi);
+        };
+
+        const glm::vec2 ndcX = getNdcBounds(center.x - r, center.x + r, proj[0][0]);
+        const glm::vec2 ndcY = getNdcBounds(center.y - r, center.y + r, proj[1][1]);
+
+        ClusterRange range{};
+
+        if (!getTileRange(ndcX.x, ndcX.y, GRID_SIZE_X, range.min.x, range.max.x)) {
+            continue;
+        }
+
+        // tile rows go from the top of the screen, while ndc y points up
+        if (!getTileRange(-ndcY.y, -ndcY.x, GRID_SIZE_Y, range.min.y, range.max.y)) {
+            continue;
+        }
+
+        range.min.z = getDepthSlice(depthMin, zNear, zFar);
+        range.max.z = getDepthSlice(depthMax, zNear, zFar);
+
+        const bool isSpot = light.type == LightType::Spot;
+
+        lightData.push_back(LightData{
+            .positionAndRange = glm::vec4(light.position, light.range),
+            .radianceAndCosInner = glm::vec4(
+                light.color * light.intensity,
+                isSpot ? std::cos(light.innerConeAngle) : -1.0f
+            ),
+            .directionAndCosOuter = glm::vec4(
+                glm::normalize(light.direction),
+                isSpot ? std::cos(light.outerConeAngle) : -2.0f
+            ),
+        });
+
+        lightClusterRanges.push_back(range);
+    }
+
+    const auto getClusterIndex = [](const uint32_t x, const uint32_t y, const uint32_t z) {
+        return (z * GRID_SIZE_Y + y) * GRID_SIZE_X + x;
+    };
+
+    // first pass counts lights per cluster, then offsets are assigned and the second pass fills the lists
+
+    for (const auto &[min, max]: lightClusterRanges) {
+        for (uint32_t z = min.z; z <= max.z; z++) {
+            for (uint32_t y = min.y; y <= max.y; y++) {
+                for (uint32_t x = min.x; x <= max.x; x++) {
+                    clusters[getClusterIndex(x, y, z)].y++;
+                }
+            }
+        }
+    }
+
+    uint32_t offset = 0;
+    for (auto &cluster: clusters) {
+        cluster.x = offset;
+        cluster.y = std::min(cluster.y, MAX_LIGHT_INDICES - offset);
+        offset += cluster.y;
+    }
+
+    lightIndices.resize(offset);
+
+    std::vector<uint32_t> writtenCounts(CLUSTER_COUNT, 0);
+
+    for (uint32_t lightIdx = 0; lightIdx < lightClusterRanges.size(); lightIdx++) {
+        const auto &[min, max] = lightClusterRanges[lightIdx];
+
+        for (uint32_t z = min.z; z <= max.z; z++) {
+            for (uint32_t y = min.y; y <= max.y; y++) {
+                for (uint32_t x = min.x; x <= max.x; x++) {
+                    const uint32_t clusterIdx = getClusterIndex(x, y, z);
+                    const auto &cluster = clusters[clusterIdx];
+
+                    if (writtenCounts[clusterIdx] < cluster.y) {
+                        lightIndices[cluster.x + writtenCounts[clusterIdx]++] = lightIdx;
+                    }
+                }
+            }
+        }
+    }
+}
+
+uint32_t LightClusterGrid::getDepthSlice(const float depth, const float zNear, const float zFar) {
+    const float slice = std::log(depth / zNear) / std::log(zFar / zNear) * static_cast<float>(GRID_SIZE_Z);
+    return static_cast<uint32_t>(std::clamp(static_cast<int32_t>(slice), 0, static_cast<int32_t>(GRID_SIZE_Z) - 1));
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+
+#include "libs.h"
+#include "globals.h"
+
+enum class LightType {
+    Point,
+    Spot,
+};
+
+/**
+ * Point or spot light, defined in world space.
+ */
+struct PunctualLight {
+    LightType type = LightType::Point;
+    glm::vec3 position{};
+    glm::vec3 direction{0, -1, 0}; // spot lights only
+    glm::vec3 color{1};
+    float intensity = 1.0f;
+    float range = 5.0f; // distance at which the light's contribution fades out completely
+    float innerConeAngle = glm::radians(20.0f); // spot lights only
+    float outerConeAngle = glm::radians(30.0f); // spot lights only
+};
+
+/**
+ * Layout of a single light as seen by shaders (std430).
+ * Point lights use cone cosines below -1, so that their spot attenuation is always 1.
+ */
+struct LightData {
+    glm::vec4 positionAndRange;
+    glm::vec4 radianceAndCosInner;
+    glm::vec4 directionAndCosOuter;
+};
+
+/**
+ * Header preceding the light array in the light storage buffer.
+ */
+struct LightBufferHeader {
+    uint32_t lightCount;
+    uint32_t framebufferWidth;
+    uint32_t framebufferHeight;
+    uint32_t padding;
+};
+
+/**
+ * Bins punctual lights into view-space froxels: a screen-space tile grid, sliced exponentially along depth.
+ * Every cluster references a contiguous range of light indices, which is what the scene pass
+ * iterates over instead of all lights. Binning is done on the CPU and is conservative,
+ * as each light is assigned to the whole box of clusters covered by its bounding sphere.
+ */
+class LightClusterGrid {
+public:
+    static constexpr uint32_t GRID_SIZE_X = 16;
+    static constexpr uint32_t GRID_SIZE_Y = 9;
+    static constexpr uint32_t GRID_SIZE_Z = 24;
+    static constexpr uint32_t CLUSTER_COUNT = GRID_SIZE_X * GRID_SIZE_Y * GRID_SIZE_Z;
+
+    static constexpr uint32_t MAX_LIGHTS = 1024;
+    static constexpr uint32_t MAX_LIGHT_INDICES = CLUSTER_COUNT * 64;
+
+private:
+    std::vector<LightData> lightData;
+    std::vector<glm::uvec2> clusters; // x: offset into `lightIndices`, y: light count
+    std::vector<uint32_t> lightIndices;
+
+    struct ClusterRange {
+        glm::uvec3 min;
+        glm::uvec3 max;
+    };
+
+    std::vector<ClusterRange> lightClusterRanges;
+
+public:
+    LightClusterGrid();
+
+    /**
+     * Rebuilds light data and cluster lists for a given camera.
+     * Lights which don't intersect the view frustum are dropped, as are lights beyond `MAX_LIGHTS`.
+     */
+    void build(const std::vector<PunctualLight> &lights, const glm::mat4 &view, const glm::mat4 &proj,
+               float zNear, float zFar);
+
+    [[nodiscard]] const std::vector<LightData> &getLightData() const { return lightData; }
+
+    [[nodiscard]] const std::vector<glm::uvec2> &getClusters() const { return clusters; }
+
+    [[nodiscard]] const std::vector<uint32_t> &getLightIndices() const { return lightIndices; }
+
+private:
+    [[nodiscard]] static uint32_t getDepthSlice(float depth, float zNear, float zFar);
+};
@@ -1,12 +1,22 @@
 #include "model.h"
 
+#include <algorithm>
 #include <iostream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <glm/gtx/matrix_decompose.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 #include "vertex.h"
 #include "src/render/vk/image.h"
+#include "src/render/vk/cmd.h"
 
 static glm::vec3 assimpVecToGlm(const aiVector3D &v) {
     return {v.x, v.y, v.z};
@@ -38,14 +48,120 @@ static glm::mat4 assimpMatrixToGlm(const aiMatrix4x4 &m) {
     return res;
 }
 
+static glm::vec4 getBoundingSphere(const std::vector<ModelVertex> &vertices) {
+    if (vertices.empty()) {
+        return glm::vec4(0.0f);
+    }
+
+    // centered on the bounding box, which is loose but cheap and good enough for culling
+    glm::vec3 min = vertices[0].pos;
+    glm::vec3 max = vertices[0].pos;
+
+    for (const auto &vertex: vertices) {
+        min = glm::min(min, vertex.pos);
+        max = glm::max(max, vertex.pos);
+    }
+
+    const glm::vec3 center = (min + max) * 0.5f;
+    float radius = 0.0f;
+
+    for (const auto &vertex: vertices) {
+        radius = std::max(radius, glm::length(vertex.pos - center));
+    }
+
+    return glm::vec4(center, radius);
+}
+
+// keeps the largest four bone weights of every assimp vertex, with bone indices into the mesh's own bones.
+// vertices without any influences are left with zero weights
+static std::vector<VertexSkin> getSourceVertexSkins(const aiMesh *assimpMesh) {
+    std::vector<std::vector<std::pair<float, uint16_t> > > influences(assimpMesh->mNumVertices);
+
+    for (uint32_t boneIdx = 0; boneIdx < assimpMesh->mNumBones; boneIdx++) {
+        const aiBone *bone = assimpMesh->mBones[boneIdx];
+
+        for (uint32_t i = 0; i < bone->mNumWeights; i++) {
+            const aiVertexWeight &weight = bone->mWeights[i];
+            influences[weight.mVertexId].emplace_back(weight.mWeight, static_cast<uint16_t>(boneIdx));
+        }
+    }
+
+    std::vector<VertexSkin> skins;
+    skins.reserve(influences.size());
+
+    for (uint32_t vertexIdx = 0; vertexIdx < influences.size(); vertexIdx++) {
+        auto &vertexInfluences = influences[vertexIdx];
+        std::ranges::sort(vertexInfluences, std::greater{});
+
+        VertexSkin vertexSkin{
+            .vertexIndex = vertexIdx,
+            .boneIndices{},
+            .weights{},
+        };
+
+        float weightSum = 0.0f;
+
+        for (size_t i = 0; i < std::min<size_t>(vertexInfluences.size(), vertexSkin.weights.size()); i++) {
+            vertexSkin.boneIndices[i] = vertexInfluences[i].second;
+            vertexSkin.weights[i] = vertexInfluences[i].first;
+            weightSum += vertexInfluences[i].first;
+        }
+
+        if (weightSum > 0.0f) {
+            for (auto &weight: vertexSkin.weights) {
+                weight /= weightSum;
+            }
+        }
+
+        skins.push_back(vertexSkin);
+    }
+
+    return skins;
+}
+
+namespace {
+    // identical attributes aren't enough to merge skinned vertices, they also have to follow the same bones
+    struct VertexKey {
+        ModelVertex vertex;
+        std::array<uint16_t, 4> boneIndices;
+        std::array<float, 4> weights;
+
+        bool operator==(const VertexKey &other) const {
+            return vertex == other.vertex
+                   && boneIndices == other.boneIndices
+                   && weights == other.weights;
+        }
+    };
+}
+
+template<>
+struct std::hash<VertexKey> {
+    size_t operator()(VertexKey const &key) const noexcept {
+        size_t seed = hash<ModelVertex>()(key.vertex);
+
+        for (size_t i = 0; i < key.weights.size(); i++) {
+            seed = (seed << 1) ^ hash<uint16_t>()(key.boneIndices[i]) ^ (hash<float>()(key.weights[i]) >> 1);
+        }
+
+        return seed;
+    }
+};
+
 Mesh::Mesh(const aiMesh *assimpMesh) : materialID(assimpMesh->mMaterialIndex) {
-    std::unordered_map<ModelVertex, uint32_t> uniqueVertices;
+    std::vector<VertexSkin> sourceSkins; // indexed by assimp's vertex index, empty if the mesh isn't skinned
+
+    if (assimpMesh->HasBones()) {
+        sourceSkins = getSourceVertexSkins(assimpMesh);
+    }
+
+    std::unordered_map<VertexKey, uint32_t> uniqueVertices;
 
     for (size_t faceIdx = 0; faceIdx < assimpMesh->mNumFaces; faceIdx++) {
         const auto &face = assimpMesh->mFaces[faceIdx];
 
         for (size_t i = 0; i < face.mNumIndices; i++) {
-            ModelVertex vertex{};
+            VertexKey key{};
+            ModelVertex &vertex = key.vertex;
 
             if (assimpMesh->HasPositions()) {
                 vertex.pos = assimpVecToGlm(assimpMesh->mVertices[face.mIndices[i]]);
@@ -67,82 +183,85 @@ Mesh::Mesh(const aiMesh *assimpMesh) : materialID(assimpMesh->mMaterialIndex) {
                 vertex.bitangent = assimpVecToGlm(assimpMesh->mBitangents[face.mIndices[i]]);
             }
 
-            if (!uniqueVertices.contains(vertex)) {
-                uniqueVertices[vertex] = vertices.size();
-                vertices.push_back(vertex);
+            if (!sourceSkins.empty()) {
+                key.boneIndices = sourceSkins[face.mIndices[i]].boneIndices;
+                key.weights = sourceSkins[face.mIndices[i]].weights;
             }
 
-            indices.push_back(uniqueVertices.at(vertex));
-        }
-    }
-}
-
-Material::Material(const RendererContext &ctx, const aiMaterial *assimpMaterial,
-                   const std::filesystem::path &basePath) {
-    // base color
-
-    aiString baseColorRelPath;
-    aiReturn result = assimpMaterial->GetTexture(aiTextureType_BASE_COLOR, 0, &baseColorRelPath);
+            if (!uniqueVertices.contains(key)) {
+                const auto vertexIdx = static_cast<uint32_t>(vertices.size());
+                uniqueVertices[key] = vertexIdx;
+                vertices.push_back(vertex);
 
-    if (result == aiReturn_SUCCESS) {
-        auto path = basePath;
-        path /= baseColorRelPath.C_Str();
-        path.make_preferred();
+                // vertices without any influences are left out, so they simply stay in place
+                if (key.weights != std::array<float, 4>{}) {
+                    skin.push_back({
+                        .vertexIndex = vertexIdx,
+                        .boneIndices = key.boneIndices,
+                        .weights = key.weights,
+                    });
+                }
+            }
 
-        try {
-            baseColor = TextureBuilder()
-                    .makeMipmaps()
-                    .fromPaths({path})
-                    .create(ctx);
-        } catch (std::exception &e) {
-            std::cerr << "failed to allocate buffer for texture: " << path << std::endl;
-            baseColor = nullptr;
+            indices.push_back(uniqueVertices.at(key));
         }
     }
 
-    // normal map
+    boundingSphere = getBoundingSphere(vertices);
+}
 
-    aiString normalRelPath;
-    if (assimpMaterial->GetTexture(aiTextureType_NORMALS, 0, &normalRelPath) != aiReturn_SUCCESS) {
-        result = assimpMaterial->GetTexture(aiTextureType_NORMAL_CAMERA, 0, &normalRelPath);
-    }
+bool MaterialTextureSource::dependsOnAny(const std::set<std::filesystem::path> &files) const {
+    return std::ranges::any_of(paths, [&](const auto &path) { return files.contains(path); });
+}
 
-    if (result == aiReturn_SUCCESS) {
-        auto path = basePath;
-        path /= normalRelPath.C_Str();
-        path.make_preferred();
+static std::filesystem::path getMaterialTexturePath(const aiMaterial *assimpMaterial, const aiTextureType type,
+                                                    const std::filesystem::path &basePath) {
+    aiString relPath;
+    if (assimpMaterial->GetTexture(type, 0, &relPath) != aiReturn_SUCCESS) {
+        return {};
+    }
 
-        normal = TextureBuilder()
-                .useFormat(vk::Format::eR8G8B8A8Unorm)
-                .fromPaths({path})
-                .makeMipmaps()
-                .create(ctx);
+    // canonical, so that paths can be matched against reported file changes
+    std::error_code error;
+    auto path = std::filesystem::weakly_canonical(basePath / relPath.C_Str(), error);
+    if (error) {
+        path = basePath / relPath.C_Str();
     }
 
-    // orm
+    path.make_preferred();
+    return path;
+}
 
-    std::filesystem::path aoPath, roughnessPath, metallicPath;
+static unique_ptr<Texture> loadMaterialTexture(const RendererContext &ctx, const MaterialTextureSource &source) {
+    switch (source.type) {
+        case MaterialTextureType::BaseColor: {
+            const auto &path = source.paths[0];
+
+            try {
+                return TextureBuilder()
+                        .makeMipmaps()
+                        .fromPaths({path})
+                        .create(ctx);
+            } catch (std::exception &e) {
+                std::cerr << "failed to allocate buffer for texture: " << path << std::endl;
+                return nullptr;
+            }
+        }
 
-    aiString aoRelPath;
-    if (assimpMaterial->GetTexture(aiTextureType_AMBIENT_OCCLUSION, 0, &aoRelPath) == aiReturn_SUCCESS) {
-        aoPath = basePath;
-        aoPath /= aoRelPath.C_Str();
-        aoPath.make_preferred();
-    }
+        case MaterialTextureType::Normal:
+            return TextureBuilder()
+                    .useFormat(vk::Format::eR8G8B8A8Unorm)
+                    .fromPaths({source.paths[0]})
+                    .makeMipmaps()
+                    .create(ctx);
 
-    aiString roughnessRelPath;
-    if (assimpMaterial->GetTexture(aiTextureType_DIFFUSE_ROUGHNESS, 0, &roughnessRelPath) == aiReturn_SUCCESS) {
-        roughnessPath = basePath;
-        roughnessPath /= roughnessRelPath.C_Str();
-        roughnessPath.make_preferred();
+        case MaterialTextureType::Orm:
+            break;
     }
 
-    aiString metallicRelPath;
-    if (assimpMaterial->GetTexture(aiTextureType_METALNESS, 0, &metallicRelPath) == aiReturn_SUCCESS) {
-        metallicPath = basePath;
-        metallicPath /= metallicRelPath.C_Str();
-        metallicPath.make_preferred();
-    }
+    const auto &aoPath = source.paths[0];
+    const auto &roughnessPath = source.paths[1];
+    const auto &metallicPath = source.paths[2];
 
     auto ormBuilder = TextureBuilder()
             .useFormat(vk::Format::eR8G8B8A8Unorm)
@@ -170,30 +289,116 @@ Material::Material(const RendererContext &ctx, const aiMaterial *assimpMaterial,
         ormBuilder.asSeparateChannels().fromPaths({aoPath, roughnessPath, metallicPath});
     }
 
-    orm = ormBuilder.create(ctx);
+    return ormBuilder.create(ctx);
+}
+
+static unique_ptr<Texture> takeOrLoadMaterialTexture(const RendererContext &ctx, const MaterialTextureSource &source,
+                                                     ReusableTextures *reusableTextures) {
+    if (reusableTextures) {
+        if (const auto it = reusableTextures->find(source); it != reusableTextures->end() && it->second) {
+            auto texture = std::move(it->second);
+            reusableTextures->erase(it);
+            return texture;
+        }
+    }
+
+    return loadMaterialTexture(ctx, source);
+}
+
+Material::Material(const RendererContext &ctx, const aiMaterial *assimpMaterial,
+                   const std::filesystem::path &basePath, ReusableTextures *reusableTextures) {
+    if (auto path = getMaterialTexturePath(assimpMaterial, aiTextureType_BASE_COLOR, basePath); !path.empty()) {
+        baseColorSource = {MaterialTextureType::BaseColor, {std::move(path)}};
+        baseColor = takeOrLoadMaterialTexture(ctx, *baseColorSource, reusableTextures);
+    }
+
+    auto normalPath = getMaterialTexturePath(assimpMaterial, aiTextureType_NORMALS, basePath);
+    if (normalPath.empty()) {
+        normalPath = getMaterialTexturePath(assimpMaterial, aiTextureType_NORMAL_CAMERA, basePath);
+    }
+
+    if (!normalPath.empty()) {
+        normalSource = {MaterialTextureType::Normal, {std::move(normalPath)}};
+        normal = takeOrLoadMaterialTexture(ctx, *normalSource, reusableTextures);
+    }
+
+    ormSource = {
+        MaterialTextureType::Orm,
+        {
+            getMaterialTexturePath(assimpMaterial, aiTextureType_AMBIENT_OCCLUSION, basePath),
+            getMaterialTexturePath(assimpMaterial, aiTextureType_DIFFUSE_ROUGHNESS, basePath),
+            getMaterialTexturePath(assimpMaterial, aiTextureType_METALNESS, basePath),
+        }
+    };
+
+    orm = takeOrLoadMaterialTexture(ctx, *ormSource, reusableTextures);
 }
 
-Model::Model(const RendererContext &ctx, const std::filesystem::path &path, const bool loadMaterials) {
-    Assimp::Importer importer;
+std::vector<MaterialTextureType> Material::reloadTextures(const RendererContext &ctx,
+                                                          const std::set<std::filesystem::path> &files) {
+    std::vector<MaterialTextureType> reloadedTypes;
+
+    for (auto [texture, source]: {
+             std::pair{&baseColor, &baseColorSource},
+             std::pair{&normal, &normalSource},
+             std::pair{&orm, &ormSource},
+         }) {
+        if (!*source || !(*source)->dependsOnAny(files)) {
+            continue;
+        }
+
+        // a texture which fails to load keeps its previous contents, its file is likely still being written
+        try {
+            if (auto reloaded = loadMaterialTexture(ctx, **source)) {
+                *texture = std::move(reloaded);
+                reloadedTypes.push_back((*source)->type);
+            }
+        } catch (std::exception &e) {
+            std::cerr << "failed to reload texture: " << e.what() << std::endl;
+        }
+    }
+
+    return reloadedTypes;
+}
 
-    const aiScene *scene = importer.ReadFile(
+ModelImport::ModelImport(const std::filesystem::path &path)
+    : path(path), importer(make_unique<Assimp::Importer>()) {
+    scene = importer->ReadFile(
         path.string(),
         aiProcess_RemoveRedundantMaterials
         | aiProcess_FindInstances
         | aiProcess_OptimizeMeshes
-        | aiProcess_OptimizeGraph
         | aiProcess_FixInfacingNormals
         | aiProcess_Triangulate
         | aiProcess_JoinIdenticalVertices
         | aiProcess_CalcTangentSpace
+        | aiProcess_LimitBoneWeights
         | aiProcess_SortByPType
         | aiProcess_ImproveCacheLocality
         | aiProcess_ValidateDataStructure
     );
 
     if (!scene) {
-        throw std::runtime_error(importer.GetErrorString());
+        throw std::runtime_error(importer->GetErrorString());
+    }
+
+    for (size_t i = 0; i < scene->mNumMeshes; i++) {
+        meshes.emplace_back(scene->mMeshes[i]);
     }
+}
+
+// defined here, where the importer is a complete type
+ModelImport::~ModelImport() = default;
+
+Model::Model(const RendererContext &ctx, const std::filesystem::path &path, const bool loadMaterials,
+             const bool packTextures)
+    : Model(ctx, ModelImport(path), loadMaterials, packTextures) {
+}
+
+Model::Model(const RendererContext &ctx, ModelImport &&import, const bool loadMaterials, const bool packTextures,
+             ReusableTextures *reusableTextures)
+    : path(import.path), meshes(std::move(import.meshes)) {
+    const aiScene *scene = import.scene;
 
     if (loadMaterials) {
         constexpr size_t MAX_MATERIAL_COUNT = 32;
@@ -203,33 +408,291 @@ Model::Model(const RendererContext &ctx, const std::filesystem::path &path, cons
 
         for (size_t i = 0; i < scene->mNumMaterials; i++) {
             std::filesystem::path basePath = path.parent_path();
-            materials.emplace_back(ctx, scene->mMaterials[i], basePath);
+            materials.emplace_back(ctx, scene->mMaterials[i], basePath, reusableTextures);
         }
-    }
 
-    for (size_t i = 0; i < scene->mNumMeshes; i++) {
-        meshes.emplace_back(scene->mMeshes[i]);
+        if (packTextures) {
+            packMaterialTextures(ctx);
+        }
+    }
 
-        if (!loadMaterials) {
-            meshes.back().materialID = 0;
+    if (!loadMaterials) {
+        for (auto &mesh: meshes) {
+            mesh.materialID = 0;
         }
     }
 
-    addInstances(scene->mRootNode, glm::identity<glm::mat4>());
+    loadedInstances.resize(meshes.size());
+    addSceneNodes(scene->mRootNode, -1);
+    loadBones(scene);
+    loadAnimations(scene);
+
+    nodeWorldTransforms.resize(sceneNodes.size());
+    nodeDirtyFlags.resize(sceneNodes.size());
+    markNodeDirty(0);
+    updateNodeWorldTransforms();
 
     normalizeScale();
 }
 
-void Model::addInstances(const aiNode *node, const glm::mat4 &baseTransform) {
-    const glm::mat4 transform = baseTransform * assimpMatrixToGlm(node->mTransformation);
+std::vector<std::filesystem::path> Model::getSourceFiles() const {
+    std::set<std::filesystem::path> files{path};
+
+    for (const auto &material: materials) {
+        for (const auto *source: {&material.baseColorSource, &material.normalSource, &material.ormSource}) {
+            if (*source) {
+                for (const auto &sourcePath: (*source)->paths) {
+                    if (!sourcePath.empty()) {
+                        files.insert(sourcePath);
+                    }
+                }
+            }
+        }
+    }
 
-    for (size_t i = 0; i < node->mNumMeshes; i++) {
-        meshes[node->mMeshes[i]].instances.push_back(transform);
+    return {files.begin(), files.end()};
+}
+
+std::vector<std::pair<uint32_t, MaterialTextureType> > Model::reloadTextures(
+    const RendererContext &ctx, const std::set<std::filesystem::path> &files) {
+    std::vector<std::pair<uint32_t, MaterialTextureType> > reloaded;
+
+    if (hasPackedMaterialTextures()) {
+        return reloaded;
     }
 
-    for (size_t i = 0; i < node->mNumChildren; i++) {
-        addInstances(node->mChildren[i], transform);
+    for (uint32_t i = 0; i < materials.size(); i++) {
+        for (const auto type: materials[i].reloadTextures(ctx, files)) {
+            reloaded.emplace_back(i, type);
+        }
+    }
+
+    return reloaded;
+}
+
+ReusableTextures Model::takeReusableTextures(const std::set<std::filesystem::path> &changedFiles) {
+    ReusableTextures textures;
+
+    for (auto &material: materials) {
+        for (auto [texture, source]: {
+                 std::pair{&material.baseColor, &material.baseColorSource},
+                 std::pair{&material.normal, &material.normalSource},
+                 std::pair{&material.orm, &material.ormSource},
+             }) {
+            // materials sharing a texture load it separately, so only one of the copies can be reused
+            if (*texture && *source && !(*source)->dependsOnAny(changedFiles) && !textures.contains(**source)) {
+                textures.emplace(**source, std::move(*texture));
+            }
+        }
+    }
+
+    return textures;
+}
+
+void Model::restoreTextures(const RendererContext &ctx) {
+    if (hasPackedMaterialTextures()) {
+        return;
+    }
+
+    for (auto &material: materials) {
+        for (auto [texture, source]: {
+                 std::pair{&material.baseColor, &material.baseColorSource},
+                 std::pair{&material.normal, &material.normalSource},
+                 std::pair{&material.orm, &material.ormSource},
+             }) {
+            if (!*texture && *source) {
+                *texture = loadMaterialTexture(ctx, **source);
+            }
+        }
+    }
+}
+
+void Model::setNodeLocalTransform(const uint32_t nodeIdx, const glm::mat4 &transform) {
+    if (nodeIdx >= sceneNodes.size()) {
+        throw std::runtime_error("scene node index out of range!");
+    }
+
+    sceneNodes[nodeIdx].localTransform = transform;
+    markNodeDirty(nodeIdx);
+}
+
+void Model::markNodeDirty(const uint32_t nodeIdx) {
+    if (!nodeDirtyFlags[nodeIdx]) {
+        nodeDirtyFlags[nodeIdx] = true;
+        dirtyNodeIndices.push_back(nodeIdx);
+    }
+}
+
+std::vector<uint32_t> Model::updateNodeWorldTransforms() {
+    std::vector<uint32_t> movedInstances;
+
+    if (dirtyNodeIndices.empty()) {
+        return movedInstances;
+    }
+
+    // where each mesh's instances start in `getInstances` order
+    std::vector<uint32_t> meshInstanceOffsets;
+    meshInstanceOffsets.reserve(meshes.size());
+
+    uint32_t instanceCount = 0;
+    for (const auto &mesh: meshes) {
+        meshInstanceOffsets.push_back(instanceCount);
+        instanceCount += static_cast<uint32_t>(mesh.instances.size());
+    }
+
+    // in depth-first order, a dirty node within the subtree of a preceding one is updated along with it
+    std::ranges::sort(dirtyNodeIndices);
+    uint32_t updatedUntil = 0;
+
+    for (const uint32_t dirtyIdx: dirtyNodeIndices) {
+        nodeDirtyFlags[dirtyIdx] = false;
+
+        if (dirtyIdx < updatedUntil) {
+            continue;
+        }
+
+        updatedUntil = sceneNodes[dirtyIdx].subtreeEnd;
+
+        for (uint32_t nodeIdx = dirtyIdx; nodeIdx < updatedUntil; nodeIdx++) {
+            const auto &node = sceneNodes[nodeIdx];
+            const glm::mat4 &parentTransform = node.parentIndex >= 0
+                                                   ? nodeWorldTransforms[node.parentIndex]
+                                                   : sceneTransform;
+
+            nodeWorldTransforms[nodeIdx] = parentTransform * node.localTransform;
+
+            for (uint32_t i = node.firstInstance; i < node.firstInstance + node.instanceCount; i++) {
+                const auto [meshIdx, instanceIdx] = nodeInstances[i];
+                auto &mesh = meshes[meshIdx];
+                auto &loaded = loadedInstances[meshIdx];
+
+                // skinned vertices end up in the space of the scene's root, whichever node the mesh is attached to
+                const glm::mat4 &transform = mesh.isSkinned() ? sceneTransform : nodeWorldTransforms[nodeIdx];
+                loaded[instanceIdx] = transform;
+
+                for (size_t copyIdx = 0; copyIdx < copyTransforms.size(); copyIdx++) {
+                    const auto meshInstanceIdx = static_cast<uint32_t>(copyIdx * loaded.size() + instanceIdx);
+                    const glm::mat4 copyTransform = copyTransforms[copyIdx] * transform;
+
+                    mesh.instances[meshInstanceIdx] = copyTransform;
+                    movedInstances.push_back(meshInstanceOffsets[meshIdx] + meshInstanceIdx);
+
+                    // moved parts may leave the bounds, which are only ever grown here to keep updates incremental
+                    const glm::vec3 center = copyTransform * glm::vec4(glm::vec3(mesh.boundingSphere), 1.0f);
+                    const float scale = std::max({
+                        glm::length(glm::vec3(copyTransform[0])),
+                        glm::length(glm::vec3(copyTransform[1])),
+                        glm::length(glm::vec3(copyTransform[2])),
+                    });
+
+                    boundingRadius = std::max(boundingRadius, glm::length(center) + scale * mesh.boundingSphere.w);
+                }
+            }
+        }
+    }
+
+    dirtyNodeIndices.clear();
+    std::ranges::sort(movedInstances);
+
+    return movedInstances;
+}
+
+// uniformly distributed over all rotations (Shoemake 1992)
+static glm::quat getRandomRotation(std::default_random_engine &generator) {
+    std::uniform_real_distribution<float> randomFloats(0.0, 1.0);
+
+    const float u1 = randomFloats(generator);
+    const float angle1 = glm::two_pi<float>() * randomFloats(generator);
+    const float angle2 = glm::two_pi<float>() * randomFloats(generator);
+    const float a = std::sqrt(1.0f - u1);
+    const float b = std::sqrt(u1);
+
+    return {b * std::cos(angle2), a * std::sin(angle1), a * std::cos(angle1), b * std::sin(angle2)};
+}
+
+void Model::generateStressScene(const StressSceneSettings &settings) {
+    const auto copyCount = static_cast<uint32_t>(std::max(settings.copyCount, 1));
+
+    std::uniform_real_distribution<float> randomFloats(0.0, 1.0);
+    std::default_random_engine generator(settings.seed);
+
+    // every copy fits into a sphere of the normalized radius before it's scaled
+    const float copyRadius = NORMALIZED_RADIUS * std::max(settings.minScale, settings.maxScale);
+    const float cellSize = 2.0f * copyRadius * settings.spacing;
+
+    uint32_t gridSide = 1;
+    while (gridSide * gridSide * gridSide < copyCount) {
+        gridSide++;
+    }
+
+    // scattered copies fill a sphere of the same volume as the cells a grid of them would take
+    const float scatterRadius = cellSize * std::cbrt(3.0f * static_cast<float>(copyCount) / (4.0f * glm::pi<float>()));
+
+    copyTransforms.clear();
+    copyTransforms.reserve(copyCount);
+
+    float farthestCopyDistance = 0.0f;
+
+    for (uint32_t i = 0; i < copyCount; i++) {
+        glm::vec3 position;
+
+        if (settings.layout == StressSceneLayout::Grid) {
+            const glm::uvec3 cell{i % gridSide, i / gridSide % gridSide, i / (gridSide * gridSide)};
+            position = (glm::vec3(cell) - 0.5f * static_cast<float>(gridSide - 1)) * cellSize;
+        } else {
+            do {
+                position = glm::vec3(randomFloats(generator), randomFloats(generator), randomFloats(generator));
+                position = position * 2.0f - 1.0f;
+            } while (glm::dot(position, position) > 1.0f);
+
+            position *= scatterRadius;
+        }
+
+        glm::mat4 transform = glm::translate(glm::identity<glm::mat4>(), position);
+
+        if (settings.randomRotation) {
+            transform *= glm::mat4_cast(getRandomRotation(generator));
+        }
+
+        const float scale = glm::mix(settings.minScale, settings.maxScale, randomFloats(generator));
+        transform = glm::scale(transform, glm::vec3(scale));
+
+        copyTransforms.push_back(transform);
+        farthestCopyDistance = std::max(farthestCopyDistance, glm::length(position));
+    }
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        auto &instances = meshes[i].instances;
+        instances.clear();
+        instances.reserve(copyTransforms.size() * loadedInstances[i].size());
+
+        // copies are laid out one after another, as expected by `updateNodeWorldTransforms`
+        for (const auto &copyTransform: copyTransforms) {
+            for (const auto &transform: loadedInstances[i]) {
+                instances.push_back(copyTransform * transform);
+            }
+        }
+    }
+
+    boundingRadius = farthestCopyDistance + copyRadius;
+}
+
+vk::DeviceSize Model::getTextureMemoryUsage() const {
+    vk::DeviceSize size = 0;
+
+    for (const auto &material: materials) {
+        for (const auto *texture: {&material.baseColor, &material.normal, &material.orm}) {
+            if (*texture) {
+                size += (*texture)->getImage().getAllocationSize();
+            }
+        }
+    }
+
+    for (const auto &textureArray: textureArrays) {
+        size += textureArray->getImage().getAllocationSize();
     }
+
+    return size;
 }
 
 std::vector<ModelVertex> Model::getVertices() const {
@@ -266,8 +729,8 @@ std::vector<uint32_t> Model::getIndices() const {
     return indices;
 }
 
-std::vector<glm::mat4> Model::getInstanceTransforms() const {
-    std::vector<glm::mat4> result;
+std::vector<ModelInstance> Model::getInstances() const {
+    std::vector<ModelInstance> result;
 
     size_t totalSize = 0;
     for (const auto &mesh: meshes) {
@@ -277,24 +740,424 @@ std::vector<glm::mat4> Model::getInstanceTransforms() const {
     result.reserve(totalSize);
 
     for (const auto &mesh: meshes) {
-        result.insert(result.end(), mesh.instances.begin(), mesh.instances.end());
+        std::ranges::transform(mesh.instances, std::back_inserter(result), ModelInstance::fromTransform);
     }
 
     return result;
 }
 
-void Model::normalizeScale() {
-    constexpr float standardScale = 10.0f;
-    const float largestDistance = getMaxVertexDistance();
-    const glm::mat4 scaleMatrix = glm::scale(glm::identity<glm::mat4>(), glm::vec3(standardScale / largestDistance));
+std::vector<VertexSkin> Model::getVertexSkins() const {
+    std::vector<VertexSkin> result;
+    uint32_t vertexOffset = 0;
+
+    for (const auto &mesh: meshes) {
+        for (auto vertexSkin: mesh.skin) {
+            vertexSkin.vertexIndex += vertexOffset;
+            result.push_back(vertexSkin);
+        }
+
+        vertexOffset += static_cast<uint32_t>(mesh.vertices.size());
+    }
+
+    return result;
+}
+
+template<typename T>
+static T interpolate(const T &a, const T &b, const float t) {
+    return glm::mix(a, b, t);
+}
+
+static glm::quat interpolate(const glm::quat &a, const glm::quat &b, const float t) {
+    return glm::slerp(a, b, t);
+}
+
+template<typename T>
+static T sampleKeys(const std::vector<AnimationKey<T> > &keys, const float time) {
+    const auto next = std::ranges::upper_bound(keys, time, {}, &AnimationKey<T>::time);
+
+    if (next == keys.begin()) {
+        return keys.front().value;
+    }
+
+    if (next == keys.end()) {
+        return keys.back().value;
+    }
+
+    const auto &prev = *std::prev(next);
+    return interpolate(prev.value, next->value, (time - prev.time) / (next->time - prev.time));
+}
+
+void Model::computeBoneMatrices(const std::optional<uint32_t> animationIdx, const float time,
+                                std::vector<glm::mat4> &boneMatrices) const {
+    std::vector<glm::mat4> nodeTransforms;
+    nodeTransforms.reserve(sceneNodes.size());
+
+    for (const auto &node: sceneNodes) {
+        nodeTransforms.push_back(node.localTransform);
+    }
+
+    if (animationIdx && *animationIdx < animations.size()) {
+        const auto &animation = animations[*animationIdx];
+
+        float wrappedTime = animation.duration > 0.0f ? std::fmod(time, animation.duration) : 0.0f;
+        if (wrappedTime < 0.0f) {
+            wrappedTime += animation.duration;
+        }
+
+        for (const auto &channel: animation.channels) {
+            glm::vec3 translation, scale, skew;
+            glm::quat rotation;
+            glm::vec4 perspective;
+
+            if (channel.positions.empty() || channel.rotations.empty() || channel.scales.empty()) {
+                glm::decompose(nodeTransforms[channel.nodeIndex], scale, rotation, translation, skew, perspective);
+            }
+
+            if (!channel.positions.empty()) {
+                translation = sampleKeys(channel.positions, wrappedTime);
+            }
+
+            if (!channel.rotations.empty()) {
+                rotation = glm::normalize(sampleKeys(channel.rotations, wrappedTime));
+            }
+
+            if (!channel.scales.empty()) {
+                scale = sampleKeys(channel.scales, wrappedTime);
+            }
+
+            nodeTransforms[channel.nodeIndex] = glm::translate(glm::identity<glm::mat4>(), translation)
+                                                * glm::mat4_cast(rotation)
+                                                * glm::scale(glm::identity<glm::mat4>(), scale);
+        }
+    }
+
+    // parents precede their children, so their global transforms are final by the time children are reached
+    for (size_t i = 0; i < sceneNodes.size(); i++) {
+        if (const int32_t parentIdx = sceneNodes[i].parentIndex; parentIdx >= 0) {
+            nodeTransforms[i] = nodeTransforms[parentIdx] * nodeTransforms[i];
+        }
+    }
+
+    boneMatrices.resize(bones.size());
+
+    for (size_t i = 0; i < bones.size(); i++) {
+        boneMatrices[i] = nodeTransforms[bones[i].nodeIndex] * bones[i].inverseBindMatrix;
+    }
+}
+
+std::vector<ModelInstance> Model::getInstances(uint32_t firstInstance, const uint32_t count) const {
+    std::vector<ModelInstance> result;
+    result.reserve(count);
+
+    for (const auto &mesh: meshes) {
+        if (result.size() == count) {
+            break;
+        }
+
+        if (firstInstance >= mesh.instances.size()) {
+            firstInstance -= static_cast<uint32_t>(mesh.instances.size());
+            continue;
+        }
+
+        const size_t takenCount = std::min(mesh.instances.size() - firstInstance, count - result.size());
+        const auto first = mesh.instances.begin() + firstInstance;
+
+        std::transform(first, first + static_cast<ptrdiff_t>(takenCount), std::back_inserter(result),
+                       ModelInstance::fromTransform);
+
+        firstInstance = 0;
+    }
+
+    if (result.size() != count) {
+        throw std::runtime_error("instance range out of bounds!");
+    }
+
+    return result;
+}
+
+std::vector<ModelInstance> Model::getExplodedInstances(const float factor) const {
+    std::vector<ModelInstance> result;
+
+    for (const auto &mesh: meshes) {
+        for (const auto &transform: mesh.instances) {
+            const glm::vec3 center = transform * glm::vec4(glm::vec3(mesh.boundingSphere), 1.0f);
+            const glm::mat4 offset = glm::translate(glm::identity<glm::mat4>(), center * factor);
+            result.push_back(ModelInstance::fromTransform(offset * transform));
+        }
+    }
+
+    return result;
+}
+
+void Model::packMaterialTextures(const RendererContext &ctx) {
+    struct TextureSlot {
+        unique_ptr<Texture> *texture;
+        glm::uvec2 *location;
+    };
+
+    using GroupKey = std::tuple<vk::Format, uint32_t, uint32_t, uint32_t>;
+    std::map<GroupKey, std::vector<TextureSlot> > groups;
+
+    materialTextureLayers.resize(materials.size());
+
+    for (size_t i = 0; i < materials.size(); i++) {
+        auto &material = materials[i];
+        auto &layers = materialTextureLayers[i];
+
+        for (auto [texture, location]: {
+                 TextureSlot{&material.baseColor, &layers.baseColor},
+                 TextureSlot{&material.normal, &layers.normal},
+                 TextureSlot{&material.orm, &layers.orm},
+             }) {
+            if (!*texture) {
+                // the texture failed to load, so it falls back to whatever the first layer of the first array holds
+                *location = glm::uvec2(0);
+                continue;
+            }
+
+            const auto extent = (*texture)->getImage().getExtent();
+            const GroupKey key{(*texture)->getFormat(), extent.width, extent.height, (*texture)->getMipLevels()};
+            groups[key].push_back({texture, location});
+        }
+    }
+
+    for (const auto &[key, slots]: groups) {
+        const auto &[format, width, height, mipLevels] = key;
+
+        auto textureArray = TextureBuilder()
+                .useFormat(format)
+                .asUninitialized({width, height, 1})
+                .asArray(static_cast<uint32_t>(slots.size()))
+                .makeMipmaps()
+                .create(ctx);
+
+        if (textureArray->getMipLevels() != mipLevels) {
+            throw std::runtime_error("mip level count mismatch while packing material textures!");
+        }
+
+        const auto arrayIndex = static_cast<uint32_t>(textureArrays.size());
+        const auto &dstImage = textureArray->getImage();
+
+        vkutils::cmd::doSingleTimeCommands(ctx, [&](const auto &cmdBuffer) {
+            dstImage.transitionLayout(
+                vk::ImageLayout::eShaderReadOnlyOptimal,
+                vk::ImageLayout::eTransferDstOptimal,
+                cmdBuffer
+            );
+
+            for (uint32_t layer = 0; layer < slots.size(); layer++) {
+                const auto &srcImage = (*slots[layer].texture)->getImage();
+
+                srcImage.transitionLayout(
+                    vk::ImageLayout::eShaderReadOnlyOptimal,
+                    vk::ImageLayout::eTransferSrcOptimal,
+                    cmdBuffer
+                );
+
+                std::vector<vk::ImageCopy> regions;
+
+                for (uint32_t mip = 0; mip < mipLevels; mip++) {
+                    regions.push_back({
+                        .srcSubresource = {
+                            .aspectMask = vk::ImageAspectFlagBits::eColor,
+                            .mipLevel = mip,
+                            .baseArrayLayer = 0,
+                            .layerCount = 1,
+                        },
+                        .dstSubresource = {
+                            .aspectMask = vk::ImageAspectFlagBits::eColor,
+                            .mipLevel = mip,
+                            .baseArrayLayer = layer,
+                            .layerCount = 1,
+                        },
+                        .extent = {std::max(width >> mip, 1u), std::max(height >> mip, 1u), 1},
+                    });
+                }
+
+                cmdBuffer.copyImage(
+                    **srcImage,
+                    vk::ImageLayout::eTransferSrcOptimal,
+                    **dstImage,
+                    vk::ImageLayout::eTransferDstOptimal,
+                    regions
+                );
+            }
+
+            dstImage.transitionLayout(
+                vk::ImageLayout::eTransferDstOptimal,
+                vk::ImageLayout::eShaderReadOnlyOptimal,
+                cmdBuffer
+            );
+        });
+
+        for (uint32_t layer = 0; layer < slots.size(); layer++) {
+            *slots[layer].location = {arrayIndex, layer};
+            slots[layer].texture->reset();
+        }
+
+        textureArrays.emplace_back(std::move(textureArray));
+    }
+}
+
+void Model::addSceneNodes(const aiNode *node, const int32_t parentIndex) {
+    const auto nodeIndex = static_cast<int32_t>(sceneNodes.size());
+
+    sceneNodes.push_back(SceneNode{
+        .name = node->mName.C_Str(),
+        .parentIndex = parentIndex,
+        .subtreeEnd = 0,
+        .localTransform = assimpMatrixToGlm(node->mTransformation),
+        .firstInstance = static_cast<uint32_t>(nodeInstances.size()),
+        .instanceCount = node->mNumMeshes,
+    });
+
+    // transforms are filled in by `updateNodeWorldTransforms`
+    for (size_t i = 0; i < node->mNumMeshes; i++) {
+        const uint32_t meshIdx = node->mMeshes[i];
+        auto &loaded = loadedInstances[meshIdx];
+
+        nodeInstances.push_back(NodeInstance{
+            .meshIndex = meshIdx,
+            .instanceIndex = static_cast<uint32_t>(loaded.size()),
+        });
+
+        loaded.emplace_back(1.0f);
+        meshes[meshIdx].instances.emplace_back(1.0f);
+    }
+
+    for (size_t i = 0; i < node->mNumChildren; i++) {
+        addSceneNodes(node->mChildren[i], nodeIndex);
+    }
+
+    sceneNodes[nodeIndex].subtreeEnd = static_cast<uint32_t>(sceneNodes.size());
+}
+
+static std::unordered_map<std::string, uint32_t> getNodeIndices(const std::vector<SceneNode> &nodes) {
+    std::unordered_map<std::string, uint32_t> nodeIndices;
+
+    // in case of duplicate names, the one closest to the root wins
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        nodeIndices.emplace(nodes[i].name, i);
+    }
 
-    for (auto &mesh: meshes) {
-        for (auto &transform: mesh.instances) {
-            transform = scaleMatrix * transform;
+    return nodeIndices;
+}
+
+void Model::loadBones(const aiScene *scene) {
+    const auto nodeIndices = getNodeIndices(sceneNodes);
+    std::unordered_map<std::string, uint16_t> boneIndices;
+
+    for (size_t meshIdx = 0; meshIdx < meshes.size(); meshIdx++) {
+        auto &mesh = meshes[meshIdx];
+
+        if (!mesh.isSkinned()) {
+            continue;
+        }
+
+        const aiMesh *assimpMesh = scene->mMeshes[meshIdx];
+        std::vector<uint16_t> modelBoneIndices;
+
+        for (uint32_t i = 0; i < assimpMesh->mNumBones; i++) {
+            const aiBone *bone = assimpMesh->mBones[i];
+            const std::string name = bone->mName.C_Str();
+
+            auto boneIt = boneIndices.find(name);
+
+            if (boneIt == boneIndices.end()) {
+                const auto nodeIt = nodeIndices.find(name);
+                if (nodeIt == nodeIndices.end()) {
+                    throw std::runtime_error("Bone '" + name + "' has no corresponding node");
+                }
+
+                if (bones.size() > std::numeric_limits<uint16_t>::max()) {
+                    throw std::runtime_error("Models with more than 65536 bones are not supported");
+                }
+
+                boneIt = boneIndices.emplace(name, static_cast<uint16_t>(bones.size())).first;
+
+                bones.push_back(Bone{
+                    .nodeIndex = nodeIt->second,
+                    .inverseBindMatrix = assimpMatrixToGlm(bone->mOffsetMatrix),
+                });
+            }
+
+            modelBoneIndices.push_back(boneIt->second);
+        }
+
+        for (auto &vertexSkin: mesh.skin) {
+            for (auto &boneIdx: vertexSkin.boneIndices) {
+                boneIdx = modelBoneIndices[boneIdx];
+            }
+        }
+    }
+}
+
+void Model::loadAnimations(const aiScene *scene) {
+    // animations only drive skinned meshes, rigid ones keep the transforms of their nodes in the rest pose
+    if (bones.empty()) {
+        return;
+    }
+
+    const auto nodeIndices = getNodeIndices(sceneNodes);
+
+    for (uint32_t animationIdx = 0; animationIdx < scene->mNumAnimations; animationIdx++) {
+        const aiAnimation *assimpAnimation = scene->mAnimations[animationIdx];
+
+        // key times are in ticks, which some formats leave unspecified
+        const double ticksPerSecond = assimpAnimation->mTicksPerSecond > 0.0 ? assimpAnimation->mTicksPerSecond : 25.0;
+        const auto toSeconds = [&](const double ticks) { return static_cast<float>(ticks / ticksPerSecond); };
+
+        Animation animation{
+            .name = assimpAnimation->mName.length > 0
+                        ? assimpAnimation->mName.C_Str()
+                        : "Animation " + std::to_string(animationIdx),
+            .duration = toSeconds(assimpAnimation->mDuration),
+            .channels{},
+        };
+
+        for (uint32_t channelIdx = 0; channelIdx < assimpAnimation->mNumChannels; channelIdx++) {
+            const aiNodeAnim *assimpChannel = assimpAnimation->mChannels[channelIdx];
+
+            const auto nodeIt = nodeIndices.find(assimpChannel->mNodeName.C_Str());
+            if (nodeIt == nodeIndices.end()) {
+                continue;
+            }
+
+            AnimationChannel channel{.nodeIndex = nodeIt->second};
+
+            for (uint32_t i = 0; i < assimpChannel->mNumPositionKeys; i++) {
+                const auto &key = assimpChannel->mPositionKeys[i];
+                channel.positions.push_back({toSeconds(key.mTime), assimpVecToGlm(key.mValue)});
+            }
+
+            for (uint32_t i = 0; i < assimpChannel->mNumRotationKeys; i++) {
+                const auto &key = assimpChannel->mRotationKeys[i];
+                const auto &q = key.mValue;
+                channel.rotations.push_back({toSeconds(key.mTime), glm::quat(q.w, q.x, q.y, q.z)});
+            }
+
+            for (uint32_t i = 0; i < assimpChannel->mNumScalingKeys; i++) {
+                const auto &key = assimpChannel->mScalingKeys[i];
+                channel.scales.push_back({toSeconds(key.mTime), assimpVecToGlm(key.mValue)});
+            }
+
+            animation.channels.push_back(std::move(channel));
         }
+
+        animations.push_back(std::move(animation));
     }
 }
 
+void Model::normalizeScale() {
+    const float largestDistance = getMaxVertexDistance();
+    sceneTransform = glm::scale(glm::identity<glm::mat4>(), glm::vec3(NORMALIZED_RADIUS / largestDistance));
+
+    markNodeDirty(0);
+    updateNodeWorldTransforms();
+
+    boundingRadius = NORMALIZED_RADIUS;
+}
+
 float Model::getMaxVertexDistance() const {
     float largestDistance = 0.0;
 
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "vertex.h"
@@ -15,46 +19,349 @@ struct aiNode;
 class DescriptorSet;
 class Texture;
 
+namespace Assimp {
+    class Importer;
+}
+
 struct Mesh {
     std::vector<ModelVertex> vertices;
     std::vector<uint32_t> indices;
     std::vector<glm::mat4> instances;
     uint32_t materialID;
+    glm::vec4 boundingSphere{}; // center and radius, in the mesh's own space
+
+    // empty if the mesh isn't skinned. vertex indices are relative to the mesh's own vertices
+    std::vector<VertexSkin> skin;
 
     explicit Mesh(const aiMesh *assimpMesh);
+
+    [[nodiscard]] bool isSkinned() const { return !skin.empty(); }
+};
+
+/**
+ * Node of the model's scene graph, which instances, bones and animations refer to. Stored in a flat array
+ * in depth-first order, so parents always precede their children and every subtree is a contiguous range.
+ */
+struct SceneNode {
+    std::string name;
+    int32_t parentIndex; // negative for the root
+    uint32_t subtreeEnd; // one past the node's last descendant
+    glm::mat4 localTransform;
+
+    // range of the node's mesh instances in the model's node instances
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+};
+
+/**
+ * Mesh instance placed by a scene node, as an index into the mesh's instances as they were loaded.
+ */
+struct NodeInstance {
+    uint32_t meshIndex;
+    uint32_t instanceIndex;
+};
+
+struct Bone {
+    uint32_t nodeIndex;
+    glm::mat4 inverseBindMatrix; // from the space of the meshes it influences into the bone's space
 };
 
+template<typename T>
+struct AnimationKey {
+    float time; // in seconds
+    T value;
+};
+
+/**
+ * Keyframes of a single node. Missing components keep the node's own local transform.
+ */
+struct AnimationChannel {
+    uint32_t nodeIndex;
+    std::vector<AnimationKey<glm::vec3> > positions;
+    std::vector<AnimationKey<glm::quat> > rotations;
+    std::vector<AnimationKey<glm::vec3> > scales;
+};
+
+struct Animation {
+    std::string name;
+    float duration; // in seconds
+    std::vector<AnimationChannel> channels;
+};
+
+enum class MaterialTextureType {
+    BaseColor,
+    Normal,
+    Orm,
+};
+
+/**
+ * Files a material texture is decoded from, which identify it across loads of a model.
+ */
+struct MaterialTextureSource {
+    MaterialTextureType type;
+    // ao, roughness and metallic for orm maps, any of which may be empty
+    std::vector<std::filesystem::path> paths;
+
+    auto operator<=>(const MaterialTextureSource &other) const = default;
+
+    [[nodiscard]] bool dependsOnAny(const std::set<std::filesystem::path> &files) const;
+};
+
+/**
+ * Textures taken from a previous load of a model, which a new load can take over instead of decoding them again.
+ */
+using ReusableTextures = std::map<MaterialTextureSource, unique_ptr<Texture> >;
+
 struct Material {
     unique_ptr<Texture> baseColor;
     unique_ptr<Texture> normal;
     unique_ptr<Texture> orm;
 
+    std::optional<MaterialTextureSource> baseColorSource;
+    std::optional<MaterialTextureSource> normalSource;
+    std::optional<MaterialTextureSource> ormSource;
+
     Material() = default;
 
+    /**
+     * Textures found in `reusableTextures` are moved out of it instead of being loaded.
+     */
     explicit Material(const RendererContext &ctx, const aiMaterial *assimpMaterial,
-                      const std::filesystem::path &basePath);
+                      const std::filesystem::path &basePath, ReusableTextures *reusableTextures = nullptr);
+
+    /**
+     * Loads again every texture decoded from any of `files`, and returns their types.
+     */
+    std::vector<MaterialTextureType> reloadTextures(const RendererContext &ctx,
+                                                    const std::set<std::filesystem::path> &files);
+};
+
+/**
+ * Location of a material's textures when they're packed into texture arrays:
+ * x holds the index of the array among the model's texture arrays, y the layer within it.
+ */
+struct MaterialTextureLayers {
+    glm::uvec2 baseColor;
+    glm::uvec2 normal;
+    glm::uvec2 orm;
+};
+
+enum class StressSceneLayout {
+    Grid,
+    Scatter,
+};
+
+/**
+ * How copies of a model are placed by `Model::generateStressScene`.
+ */
+struct StressSceneSettings {
+    StressSceneLayout layout = StressSceneLayout::Grid;
+    int copyCount = 1;
+    float spacing = 1.0f; // distance between neighbouring copies, relative to their bounding diameter
+    bool randomRotation = false;
+    float minScale = 1.0f;
+    float maxScale = 1.0f;
+    uint32_t seed = 0;
+};
+
+/**
+ * Contents of a model's file along with its meshes, parsed without touching the gpu. As such it can be created
+ * on any thread, and only turned into a `Model` on the rendering one.
+ */
+class ModelImport {
+    std::filesystem::path path;
+    unique_ptr<Assimp::Importer> importer;
+    const aiScene *scene = nullptr;
+    std::vector<Mesh> meshes;
+
+    friend class Model;
+
+public:
+    explicit ModelImport(const std::filesystem::path &path);
+
+    ~ModelImport();
+
+    ModelImport(const ModelImport &other) = delete;
+
+    ModelImport(ModelImport &&other) = delete;
+
+    ModelImport &operator=(const ModelImport &other) = delete;
+
+    ModelImport &operator=(ModelImport &&other) = delete;
+
+    [[nodiscard]] const std::filesystem::path &getPath() const { return path; }
 };
 
 class Model {
+public:
+    /**
+     * Every vertex of a loaded model lies within a sphere of this radius around the model-space origin.
+     */
+    static constexpr float NORMALIZED_RADIUS = 10.0f;
+
+private:
+    std::filesystem::path path;
     std::vector<Mesh> meshes;
     std::vector<Material> materials;
 
+    std::vector<SceneNode> sceneNodes;
+    std::vector<NodeInstance> nodeInstances;
+    std::vector<Bone> bones;
+    std::vector<Animation> animations;
+
+    // derived from local transforms, only recomputed for subtrees of dirty nodes
+    std::vector<glm::mat4> nodeWorldTransforms;
+    std::vector<uint8_t> nodeDirtyFlags;
+    std::vector<uint32_t> dirtyNodeIndices;
+
+    // parent of the scene graph's root, normalizes the model's scale
+    glm::mat4 sceneTransform = glm::identity<glm::mat4>();
+
+    // instances of every mesh as placed by the scene graph, before any replication
+    std::vector<std::vector<glm::mat4> > loadedInstances;
+    // every copy of the model, which mesh instances are made of as `copyTransform * loadedInstance`
+    std::vector<glm::mat4> copyTransforms{glm::identity<glm::mat4>()};
+    float boundingRadius = NORMALIZED_RADIUS;
+
+    // only used if material textures are packed, in which case individual materials hold no textures
+    std::vector<unique_ptr<Texture> > textureArrays;
+    std::vector<MaterialTextureLayers> materialTextureLayers;
+
 public:
-    explicit Model(const RendererContext &ctx, const std::filesystem::path &path, bool loadMaterials);
+    explicit Model(const RendererContext &ctx, const std::filesystem::path &path, bool loadMaterials,
+                   bool packTextures);
+
+    /**
+     * Creates the model out of an import, whose meshes are taken over. Textures found in `reusableTextures`
+     * are moved out of it instead of being loaded, unless they end up packed.
+     */
+    explicit Model(const RendererContext &ctx, ModelImport &&import, bool loadMaterials, bool packTextures,
+                   ReusableTextures *reusableTextures = nullptr);
+
+    [[nodiscard]] const std::filesystem::path &getPath() const { return path; }
+
+    /**
+     * Returns the model's file along with the files of all its material textures.
+     */
+    [[nodiscard]] std::vector<std::filesystem::path> getSourceFiles() const;
 
-    void addInstances(const aiNode *node, const glm::mat4 &baseTransform);
+    /**
+     * Loads again every material texture decoded from any of `files`. Returns the index of the material
+     * and the type of each reloaded texture. Packed textures aren't reloaded, as they belong to texture arrays.
+     */
+    std::vector<std::pair<uint32_t, MaterialTextureType> > reloadTextures(
+        const RendererContext &ctx, const std::set<std::filesystem::path> &files);
+
+    /**
+     * Moves out every material texture not decoded from any of `changedFiles`, for a new load of the model to reuse.
+     */
+    [[nodiscard]] ReusableTextures takeReusableTextures(const std::set<std::filesystem::path> &changedFiles);
+
+    /**
+     * Loads again every unpacked material texture which was taken out of the model.
+     */
+    void restoreTextures(const RendererContext &ctx);
+
+    /**
+     * Replaces instances of every mesh with those of `settings.copyCount` copies of the model as it was loaded,
+     * placed either on a cubic grid or scattered randomly within a sphere, each with an optional random rotation
+     * and uniform scale. A single unrotated and unscaled grid copy restores the model as it was loaded.
+     */
+    void generateStressScene(const StressSceneSettings &settings);
 
     [[nodiscard]] const std::vector<Mesh> &getMeshes() const { return meshes; }
 
+    [[nodiscard]] const std::vector<SceneNode> &getSceneNodes() const { return sceneNodes; }
+
+    /**
+     * Replaces a node's transform relative to its parent. Instances of the node and its descendants
+     * aren't moved until the next `updateNodeWorldTransforms`.
+     */
+    void setNodeLocalTransform(uint32_t nodeIdx, const glm::mat4 &transform);
+
+    /**
+     * Recomputes world transforms of every subtree whose root changed since the last update, and moves instances
+     * of all copies of the model placed by them. Returns indices of moved instances in `getInstances` order,
+     * in ascending order. The cost is linear in the number of nodes and instances in dirty subtrees.
+     */
+    std::vector<uint32_t> updateNodeWorldTransforms();
+
+    /**
+     * Radius of a sphere around the model-space origin containing all instances of the model.
+     */
+    [[nodiscard]] float getBoundingRadius() const { return boundingRadius; }
+
     [[nodiscard]] const std::vector<Material> &getMaterials() const { return materials; }
 
+    [[nodiscard]] bool hasPackedMaterialTextures() const { return !textureArrays.empty(); }
+
+    [[nodiscard]] const std::vector<unique_ptr<Texture> > &getTextureArrays() const { return textureArrays; }
+
+    [[nodiscard]] const std::vector<MaterialTextureLayers> &getMaterialTextureLayers() const {
+        return materialTextureLayers;
+    }
+
+    /**
+     * Returns the device memory taken up by textures of all materials, packed or not.
+     */
+    [[nodiscard]] vk::DeviceSize getTextureMemoryUsage() const;
+
     [[nodiscard]] std::vector<ModelVertex> getVertices() const;
 
     [[nodiscard]] std::vector<uint32_t> getIndices() const;
 
-    [[nodiscard]] std::vector<glm::mat4> getInstanceTransforms() const;
+    /**
+     * Returns instances of all meshes, in mesh order, along with their normal matrices.
+     */
+    [[nodiscard]] std::vector<ModelInstance> getInstances() const;
+
+    /**
+     * Returns `count` consecutive instances like `getInstances`, starting at `firstInstance`.
+     */
+    [[nodiscard]] std::vector<ModelInstance> getInstances(uint32_t firstInstance, uint32_t count) const;
+
+    /**
+     * Returns instances like `getInstances`, each moved away from the origin by `factor` times
+     * the distance to its mesh's transformed bounding sphere center.
+     */
+    [[nodiscard]] std::vector<ModelInstance> getExplodedInstances(float factor) const;
+
+    [[nodiscard]] bool isSkinned() const { return !bones.empty(); }
+
+    [[nodiscard]] const std::vector<Bone> &getBones() const { return bones; }
+
+    [[nodiscard]] const std::vector<Animation> &getAnimations() const { return animations; }
+
+    /**
+     * Returns skins of all skinned meshes, in mesh order, with vertex indices into `getVertices`.
+     */
+    [[nodiscard]] std::vector<VertexSkin> getVertexSkins() const;
+
+    /**
+     * Samples an animation at `time`, wrapped around its duration, and writes the resulting skinning matrix
+     * of every bone into `boneMatrices`. Without an animation, bones are left in their rest pose.
+     */
+    void computeBoneMatrices(std::optional<uint32_t> animationIdx, float time,
+                             std::vector<glm::mat4> &boneMatrices) const;
 
 private:
+    /**
+     * Moves textures of all materials into texture arrays, one array for every distinct combination
+     * of format, extent and mip level count. Original textures are released afterwards.
+     */
+    void packMaterialTextures(const RendererContext &ctx);
+
+    void addSceneNodes(const aiNode *node, int32_t parentIndex);
+
+    void markNodeDirty(uint32_t nodeIdx);
+
+    /**
+     * Gathers bones of all skinned meshes into the model's bones, remapping their skins' bone indices.
+     */
+    void loadBones(const aiScene *scene);
+
+    void loadAnimations(const aiScene *scene);
+
     void normalizeScale();
 
     [[nodiscard]] float getMaxVertexDistance() const;
@@ -1,5 +1,10 @@
 #include "vertex.h"
 
+#include <algorithm>
+
+#include <glm/gtc/packing.hpp>
+#include <glm/gtx/component_wise.hpp>
+
 std::vector<vk::VertexInputBindingDescription> ModelVertex::getBindingDescriptions() {
     return {
         {
@@ -9,7 +14,7 @@ std::vector<vk::VertexInputBindingDescription> ModelVertex::getBindingDescriptio
         },
         {
             .binding = 1u,
-            .stride = static_cast<uint32_t>(sizeof(glm::mat4)),
+            .stride = static_cast<uint32_t>(sizeof(ModelInstance)),
             .inputRate = vk::VertexInputRate::eInstance
         }
     };
@@ -51,29 +56,77 @@ std::vector<vk::VertexInputAttributeDescription> ModelVertex::getAttributeDescri
             .location = 5U,
             .binding = 1U,
             .format = vk::Format::eR32G32B32A32Sfloat,
-            .offset = 0U,
+            .offset = static_cast<uint32_t>(offsetof(ModelInstance, transformRows)),
         },
         {
             .location = 6U,
             .binding = 1U,
             .format = vk::Format::eR32G32B32A32Sfloat,
-            .offset = static_cast<uint32_t>(sizeof(glm::vec4)),
+            .offset = static_cast<uint32_t>(offsetof(ModelInstance, transformRows) + 4 * sizeof(float)),
         },
         {
             .location = 7U,
             .binding = 1U,
             .format = vk::Format::eR32G32B32A32Sfloat,
-            .offset = static_cast<uint32_t>(2 * sizeof(glm::vec4)),
+            .offset = static_cast<uint32_t>(offsetof(ModelInstance, transformRows) + 8 * sizeof(float)),
         },
         {
             .location = 8U,
             .binding = 1U,
-            .format = vk::Format::eR32G32B32A32Sfloat,
-            .offset = static_cast<uint32_t>(3 * sizeof(glm::vec4)),
+            .format = vk::Format::eR16G16B16A16Snorm,
+            .offset = static_cast<uint32_t>(offsetof(ModelInstance, packedNormalMatrix)),
+        },
+        {
+            .location = 9U,
+            .binding = 1U,
+            .format = vk::Format::eR16G16B16A16Snorm,
+            .offset = static_cast<uint32_t>(offsetof(ModelInstance, packedNormalMatrix) + 2 * sizeof(uint32_t)),
+        },
+        {
+            .location = 10U,
+            .binding = 1U,
+            .format = vk::Format::eR16G16B16A16Snorm,
+            .offset = static_cast<uint32_t>(offsetof(ModelInstance, packedNormalMatrix) + 4 * sizeof(uint32_t)),
         },
     };
 }
 
+ModelInstance ModelInstance::fromTransform(const glm::mat4 &transform) {
+    const glm::vec3 c0(transform[0]);
+    const glm::vec3 c1(transform[1]);
+    const glm::vec3 c2(transform[2]);
+
+    // rows of a 3x3 inverse are cross products of the other two columns over the determinant,
+    // so those are the columns of the inverse transpose. only the determinant's sign matters here,
+    // as a negative one mirrors the normals
+    std::array columns = {glm::cross(c1, c2), glm::cross(c2, c0), glm::cross(c0, c1)};
+    const float detSign = glm::dot(c0, columns[0]) < 0.0f ? -1.0f : 1.0f;
+
+    float largestComponent = 0.0f;
+    for (const auto &column: columns) {
+        largestComponent = std::max(largestComponent, glm::compMax(glm::abs(column)));
+    }
+
+    const float scale = largestComponent > 0.0f ? detSign / largestComponent : 0.0f;
+
+    ModelInstance instance{};
+
+    for (uint32_t row = 0; row < 3; row++) {
+        for (uint32_t col = 0; col < 4; col++) {
+            instance.transformRows[4 * row + col] = transform[col][row];
+        }
+    }
+
+    for (uint32_t i = 0; i < 3; i++) {
+        // the first component ends up in the low bits, i.e. first in memory
+        const uint64_t packed = glm::packSnorm4x16(glm::vec4(columns[i] * scale, 0.0f));
+        instance.packedNormalMatrix[2 * i] = static_cast<uint32_t>(packed);
+        instance.packedNormalMatrix[2 * i + 1] = static_cast<uint32_t>(packed >> 32);
+    }
+
+    return instance;
+}
+
 std::vector<vk::VertexInputBindingDescription> SkyboxVertex::getBindingDescriptions() {
     return {
         {
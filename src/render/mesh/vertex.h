@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include "src/render/libs.h"
 
 struct ModelVertex {
@@ -34,6 +36,31 @@ struct std::hash<ModelVertex> {
     }
 };
 
+/**
+ * Bones influencing a skinned vertex, read by the skinning shader. The largest four influences are kept,
+ * with weights normalized to sum up to one.
+ */
+struct VertexSkin {
+    uint32_t vertexIndex;
+    std::array<uint16_t, 4> boneIndices; // into the model's bones
+    std::array<float, 4> weights;
+};
+
+/**
+ * Per-instance data of model meshes, read from the instance vertex buffer and by the culling shader.
+ * Compactly encoded, as scenes can hold hundreds of thousands of instances.
+ */
+struct ModelInstance {
+    // top three rows of the affine transform, the last one is always (0, 0, 0, 1)
+    std::array<float, 12> transformRows;
+    // columns of the inverse transpose of the transform's upper 3x3, so that vertex shaders don't have to invert
+    // anything. quantized to snorm16 after scaling the largest component to 1, which is fine as transformed
+    // normals get normalized anyway. the fourth component of every column is padding
+    std::array<uint32_t, 6> packedNormalMatrix;
+
+    static ModelInstance fromTransform(const glm::mat4 &transform);
+};
+
 struct SkyboxVertex {
     glm::vec3 pos;
 
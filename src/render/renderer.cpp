@@ -10,7 +10,15 @@
 #include <vector>
 #include <filesystem>
 #include <array>
+#include <algorithm>
 #include <random>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <future>
+
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
 
 #include "gui/gui.h"
 #include "mesh/model.h"
@@ -20,6 +28,7 @@
 #include "camera.h"
 #include "vk/cmd.h"
 #include "src/utils/glfw-statics.h"
+#include "src/utils/file-watcher.h"
 #include "vk/descriptor.h"
 #include "vk/pipeline.h"
 
@@ -44,12 +53,33 @@ VmaAllocatorWrapper::~VmaAllocatorWrapper() {
     vmaDestroyAllocator(allocator);
 }
 
-VulkanRenderer::VulkanRenderer() {
+VulkanRenderer::VulkanRenderer(const RendererOptions &options) {
     constexpr int INIT_WINDOW_WIDTH = 1200;
     constexpr int INIT_WINDOW_HEIGHT = 800;
 
+    const bool isHeadless = options.headlessExtent.has_value();
+
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    window = glfwCreateWindow(INIT_WINDOW_WIDTH, INIT_WINDOW_HEIGHT, "PBR Model Viewer", nullptr, nullptr);
+
+    if (isHeadless) {
+        // the window only provides a surface to render into, and is never shown
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+        // every frame is rendered without waiting for the display, and a static view converges to a supersampled image
+        latencyState.presentMode = vk::PresentModeKHR::eImmediate;
+        idleRendering.isEnabled = false;
+        useTaa = true;
+        progressiveState.isEnabled = true;
+    }
+
+    window = glfwCreateWindow(
+        isHeadless ? static_cast<int>(options.headlessExtent->width) : INIT_WINDOW_WIDTH,
+        isHeadless ? static_cast<int>(options.headlessExtent->height) : INIT_WINDOW_HEIGHT,
+        "PBR Model Viewer",
+        nullptr,
+        nullptr
+    );
 
     initGlfwUserPointer(window);
     auto *userData = static_cast<GlfwStaticUserData *>(glfwGetWindowUserPointer(window));
@@ -61,7 +91,11 @@ VulkanRenderer::VulkanRenderer() {
     camera = make_unique<Camera>(window);
 
     inputManager = make_unique<InputManager>(window);
+
+    fileWatcher = make_unique<FileWatcher>();
+
     bindMouseDragActions();
+    bindInputEventCallbacks();
 
     createInstance();
     setupDebugMessenger();
@@ -76,7 +110,8 @@ VulkanRenderer::VulkanRenderer() {
         *surface,
         findQueueFamilies(*ctx.physicalDevice),
         window,
-        getMsaaSampleCount()
+        getMsaaSampleCount(),
+        latencyState.presentMode
     );
 
     createCommandPool();
@@ -85,18 +120,36 @@ VulkanRenderer::VulkanRenderer() {
     createDescriptorPool();
 
     createUniformBuffers();
+    createLightBuffers();
+    createInstanceStagingBuffers();
     updateGraphicsUniformBuffer();
 
     createDebugQuadDescriptorSet();
     createDebugQuadRenderInfos();
 
+    createMaterialsDescriptorSet();
+
     createPrepassTextures();
     createPrepassDescriptorSets();
     createPrepassRenderInfo();
 
+    createShadowMapTexture();
+    createShadowRenderInfo();
+
     createSsaoTextures();
     createSsaoDescriptorSets();
     createSsaoRenderInfo();
+    createSsaoBlurDescriptorSets();
+    createSsaoBlurRenderInfos();
+    createGtaoDescriptorSets();
+    createGtaoPipeline();
+
+    createDepthPyramidTexture();
+    createDepthPyramidDescriptorSets();
+    createCullingDescriptorSets();
+    createCullingPipelines();
+    createSkinningDescriptorSets();
+    createSkinningPipeline();
 
     createIblTextures();
     createIblDescriptorSet();
@@ -116,21 +169,33 @@ VulkanRenderer::VulkanRenderer() {
     createBrdfIntegrationRenderInfo();
     computeBrdfIntegrationMap();
 
-    createMaterialsDescriptorSet();
+    createSceneColorTexture();
     createSceneDescriptorSets();
     createSceneRenderInfos();
     createGuiRenderInfos();
 
-    loadModelWithMaterials("../assets/example models/sponza/Sponza.gltf");
+    createTaaTextures();
+    createTaaDescriptorSets();
+    createTaaRenderInfos();
+
+    createFxaaTexture();
+    createSceneColorDescriptorSets();
+    createFxaaRenderInfo();
+    createUpscaleRenderInfos();
+
+    if (!isHeadless) {
+        loadModelWithMaterials("../assets/example models/sponza/Sponza.gltf");
 
-    // loadModel("../assets/example models/kettle/kettle.obj");
-    // loadBaseColorTexture("../assets/example models/kettle/kettle-albedo.png");
-    // loadNormalMap("../assets/example models/kettle/kettle-normal.png");
-    // loadOrmMap("../assets/example models/kettle/kettle-orm.png");
+        // loadModel("../assets/example models/kettle/kettle.obj");
+        // loadBaseColorTexture("../assets/example models/kettle/kettle-albedo.png");
+        // loadNormalMap("../assets/example models/kettle/kettle-normal.png");
+        // loadOrmMap("../assets/example models/kettle/kettle-orm.png");
 
-    loadEnvironmentMap("../assets/envmaps/vienna.hdr");
+        loadEnvironmentMap("../assets/envmaps/vienna.hdr");
+    }
 
     createSyncObjects();
+    createTimestampQueryPools();
 
     initImgui();
 }
@@ -146,6 +211,31 @@ void VulkanRenderer::framebufferResizeCallback(GLFWwindow *window, const int wid
     userData->renderer->framebufferResized = true;
 }
 
+void VulkanRenderer::inputEventCallback(GLFWwindow *window) {
+    const auto userData = static_cast<GlfwStaticUserData *>(glfwGetWindowUserPointer(window));
+    if (!userData) throw std::runtime_error("unexpected null window user pointer");
+    userData->renderer->requestRedraw();
+}
+
+void VulkanRenderer::bindInputEventCallbacks() {
+    glfwSetKeyCallback(window, [](GLFWwindow *w, int, int, int, int) { inputEventCallback(w); });
+    glfwSetCharCallback(window, [](GLFWwindow *w, unsigned int) { inputEventCallback(w); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow *w, int, int, int) { inputEventCallback(w); });
+    glfwSetCursorPosCallback(window, [](GLFWwindow *w, double, double) { inputEventCallback(w); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow *w, int) { inputEventCallback(w); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow *w) { inputEventCallback(w); });
+
+    // the camera has already installed its own scroll callback
+    idleRendering.prevScrollCallback = glfwSetScrollCallback(window, [](GLFWwindow *w, double dx, double dy) {
+        inputEventCallback(w);
+
+        const auto userData = static_cast<GlfwStaticUserData *>(glfwGetWindowUserPointer(w));
+        if (const auto prevCallback = userData->renderer->idleRendering.prevScrollCallback) {
+            prevCallback(w, dx, dy);
+        }
+    });
+}
+
 void VulkanRenderer::bindMouseDragActions() {
     inputManager->bindMouseDragCallback(GLFW_MOUSE_BUTTON_RIGHT, [&](const double dx, const double dy) {
         static constexpr float speed = 0.002;
@@ -399,9 +489,27 @@ QueueFamilyIndices VulkanRenderer::findQueueFamilies(const vk::raii::PhysicalDev
         i++;
     }
 
+    std::optional<uint32_t> asyncComputeFamily;
+
+    if (graphicsComputeFamily.has_value()) {
+        for (uint32_t family = 0; family < queueFamilies.size(); family++) {
+            const auto flags = queueFamilies[family].queueFlags;
+
+            if ((flags & vk::QueueFlagBits::eCompute) && !(flags & vk::QueueFlagBits::eGraphics)) {
+                asyncComputeFamily = family;
+                break;
+            }
+        }
+
+        if (!asyncComputeFamily.has_value() && queueFamilies[*graphicsComputeFamily].queueCount > 1) {
+            asyncComputeFamily = graphicsComputeFamily;
+        }
+    }
+
     return {
         .graphicsComputeFamily = graphicsComputeFamily,
-        .presentFamily = presentFamily
+        .presentFamily = presentFamily,
+        .asyncComputeFamily = asyncComputeFamily,
     };
 }
 
@@ -418,20 +526,55 @@ bool VulkanRenderer::checkDeviceExtensionSupport(const vk::raii::PhysicalDevice
     return requiredExtensions.empty();
 }
 
+bool VulkanRenderer::checkPresentWaitSupport(const vk::raii::PhysicalDevice &physicalDevice) {
+    const std::vector<vk::ExtensionProperties> availableExtensions =
+            physicalDevice.enumerateDeviceExtensionProperties();
+
+    std::set<std::string> requiredExtensions = {
+        VK_KHR_PRESENT_ID_EXTENSION_NAME,
+        VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+    };
+
+    for (const auto &extension: availableExtensions) {
+        requiredExtensions.erase(extension.extensionName);
+    }
+
+    if (!requiredExtensions.empty()) {
+        return false;
+    }
+
+    const auto supportedFeatures2Chain = physicalDevice.getFeatures2<
+        vk::PhysicalDeviceFeatures2,
+        vk::PhysicalDevicePresentIdFeaturesKHR,
+        vk::PhysicalDevicePresentWaitFeaturesKHR>();
+
+    return supportedFeatures2Chain.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId
+           && supportedFeatures2Chain.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+}
+
 // ==================== logical device ====================
 
 void VulkanRenderer::createLogicalDevice() {
-    const auto [graphicsComputeFamily, presentFamily] = findQueueFamilies(*ctx.physicalDevice);
-    const std::set uniqueQueueFamilies = {graphicsComputeFamily.value(), presentFamily.value()};
+    const auto [graphicsComputeFamily, presentFamily, asyncComputeFamily] = findQueueFamilies(*ctx.physicalDevice);
+    std::set uniqueQueueFamilies = {graphicsComputeFamily.value(), presentFamily.value()};
+
+    if (asyncComputeFamily.has_value()) {
+        uniqueQueueFamilies.insert(*asyncComputeFamily);
+    }
+
+    // without a compute-only family, the async compute queue is the graphics family's second queue
+    const bool isAsyncComputeFamilyShared = asyncComputeFamily == graphicsComputeFamily;
 
-    constexpr float queuePriority = 1.0f;
+    static constexpr std::array queuePriorities = {1.0f, 1.0f};
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
 
     for (uint32_t queueFamily: uniqueQueueFamilies) {
+        const bool hasSecondQueue = isAsyncComputeFamilyShared && queueFamily == *graphicsComputeFamily;
+
         const vk::DeviceQueueCreateInfo queueCreateInfo{
             .queueFamilyIndex = queueFamily,
-            .queueCount = 1U,
-            .pQueuePriorities = &queuePriority
+            .queueCount = hasSecondQueue ? 2U : 1U,
+            .pQueuePriorities = queuePriorities.data()
         };
         queueCreateInfos.push_back(queueCreateInfo);
     }
@@ -441,20 +584,31 @@ void VulkanRenderer::createLogicalDevice() {
         .samplerAnisotropy = vk::True,
     };
 
-    const vk::StructureChain<
+    isPresentWaitSupported = checkPresentWaitSupport(*ctx.physicalDevice);
+
+    std::vector<const char *> enabledExtensions(deviceExtensions.begin(), deviceExtensions.end());
+
+    if (isPresentWaitSupported) {
+        enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
+
+    vk::StructureChain<
         vk::DeviceCreateInfo,
         vk::PhysicalDeviceVulkan12Features,
         vk::PhysicalDeviceSynchronization2FeaturesKHR,
         vk::PhysicalDeviceDynamicRenderingFeatures,
-        vk::PhysicalDeviceMultiviewFeatures
+        vk::PhysicalDeviceMultiviewFeatures,
+        vk::PhysicalDevicePresentIdFeaturesKHR,
+        vk::PhysicalDevicePresentWaitFeaturesKHR
     > createInfo{
         {
             .queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
             .pQueueCreateInfos = queueCreateInfos.data(),
             .enabledLayerCount = static_cast<uint32_t>(enableValidationLayers ? validationLayers.size() : 0),
             .ppEnabledLayerNames = enableValidationLayers ? validationLayers.data() : nullptr,
-            .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
-            .ppEnabledExtensionNames = deviceExtensions.data(),
+            .enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size()),
+            .ppEnabledExtensionNames = enabledExtensions.data(),
             .pEnabledFeatures = &deviceFeatures,
         },
         {
@@ -468,29 +622,157 @@ void VulkanRenderer::createLogicalDevice() {
         },
         {
             .multiview = vk::True,
+        },
+        {
+            .presentId = vk::True,
+        },
+        {
+            .presentWait = vk::True,
         }
     };
 
+    if (!isPresentWaitSupported) {
+        createInfo.unlink<vk::PhysicalDevicePresentIdFeaturesKHR>();
+        createInfo.unlink<vk::PhysicalDevicePresentWaitFeaturesKHR>();
+    }
+
     ctx.device = make_unique<vk::raii::Device>(*ctx.physicalDevice, createInfo.get<vk::DeviceCreateInfo>());
 
     ctx.graphicsQueue = make_unique<vk::raii::Queue>(ctx.device->getQueue(graphicsComputeFamily.value(), 0));
     presentQueue = make_unique<vk::raii::Queue>(ctx.device->getQueue(presentFamily.value(), 0));
+
+    if (asyncComputeFamily.has_value()) {
+        const uint32_t queueIndex = isAsyncComputeFamilyShared ? 1 : 0;
+        ctx.asyncComputeQueue = make_unique<vk::raii::Queue>(ctx.device->getQueue(*asyncComputeFamily, queueIndex));
+
+        if (!isAsyncComputeFamilyShared) {
+            ctx.concurrentQueueFamilies = {*graphicsComputeFamily, *asyncComputeFamily};
+        }
+    }
 }
 
 // ==================== models ====================
 
 void VulkanRenderer::loadModelWithMaterials(const std::filesystem::path &path) {
+    setModel(path, true);
+}
+
+void VulkanRenderer::loadModel(const std::filesystem::path &path) {
+    setModel(path, false);
+}
+
+void VulkanRenderer::loadModelWithMaterials(ModelImport &&import) {
+    setModel(import.getPath(), true, &import);
+}
+
+void VulkanRenderer::clearModelCache() {
+    waitIdle();
+    modelCache.entries.clear();
+}
+
+void VulkanRenderer::setModel(const std::filesystem::path &path, const bool withMaterials, ModelImport *import) {
     waitIdle();
+    requestRedraw();
+
+    // changes of the previous model's files don't concern the new one. waits for an import still in progress.
+    // if the load fails, nothing is left to watch until the next successful one
+    fileWatcher->clear();
+    hotReload.pendingImport = {};
+    hotReload.changedFiles.clear();
+
+    const ModelCacheKey key{
+        .path = std::filesystem::absolute(path).lexically_normal(),
+        .hasMaterials = withMaterials,
+        .hasPackedTextures = withMaterials && usePackedMaterialTextures,
+    };
+
+    const auto lastWriteTime = std::filesystem::last_write_time(key.path);
+
+    stashModel();
+
+    auto cachedIt = std::ranges::find_if(modelCache.entries, [&](const ResidentModel &entry) {
+        return entry.key == key;
+    });
+
+    if (cachedIt != modelCache.entries.end() && cachedIt->lastWriteTime != lastWriteTime) {
+        modelCache.entries.erase(cachedIt);
+        cachedIt = modelCache.entries.end();
+    }
+
+    if (cachedIt != modelCache.entries.end()) {
+        modelCache.hitCount++;
+
+        model = std::move(cachedIt->model);
+        vertexBuffer = std::move(cachedIt->vertexBuffer);
+        indexBuffer = std::move(cachedIt->indexBuffer);
+        materialTextureLayersBuffer = std::move(cachedIt->materialTextureLayersBuffer);
+        modelCache.entries.erase(cachedIt);
+
+        // stress scenes replicate the model, while edits of its scene graph are kept
+        model->generateStressScene({});
+        createInstanceBuffer(model->getInstances());
+    } else {
+        modelCache.missCount++;
+
+        // make room before loading, so that the new model doesn't have to fit alongside all cached ones
+        evictModels();
+
+        model = import
+                    ? make_unique<Model>(ctx, std::move(*import), withMaterials, key.hasPackedTextures)
+                    : make_unique<Model>(ctx, key.path, withMaterials, key.hasPackedTextures);
+
+        createModelBuffers();
+    }
 
-    model.reset();
-    model = make_unique<Model>(ctx, path, true);
+    modelKey = key;
+    modelLastWriteTime = lastWriteTime;
+    evictModels();
 
-    vertexBuffer.reset();
-    indexBuffer.reset();
+    onModelChanged();
+}
 
+void VulkanRenderer::createModelBuffers() {
     createModelVertexBuffer();
     createIndexBuffer();
 
+    // the shaders reference the layer buffer even when they don't read from it, so it has to be valid either way
+    auto materialTextureLayers = model->getMaterialTextureLayers();
+    materialTextureLayers.resize(std::max<size_t>(materialTextureLayers.size(), 1));
+
+    materialTextureLayersBuffer = createLocalBuffer(
+        materialTextureLayers,
+        vk::BufferUsageFlagBits::eStorageBuffer
+    );
+}
+
+void VulkanRenderer::onModelChanged() {
+    shadowMapState.isValid = false;
+    taaState.isHistoryValid = false;
+
+    // stress scenes replicate the previous model
+    modelExplodeFactor = 0.0f;
+    selectedSceneNode.reset();
+    stressSceneSettings.copyCount = 1;
+    instancingBenchmark.framesLeft = 0;
+    instancingBenchmark.pendingCopyCounts.clear();
+    instancingBenchmark.sceneResult = {};
+
+    createCullingBuffers();
+    createSkinningBuffers();
+
+    materialsDescriptorSet->queueUpdate(
+        4,
+        *materialTextureLayersBuffer,
+        vk::DescriptorType::eStorageBuffer,
+        sizeof(MaterialTextureLayers) * std::max<size_t>(model->getMaterialTextureLayers().size(), 1)
+    );
+
+    const auto &textureArrays = model->getTextureArrays();
+
+    for (uint32_t i = 0; i < textureArrays.size(); i++) {
+        materialsDescriptorSet->queueUpdate(ctx, 3, *textureArrays[i], i);
+    }
+
     const auto &materials = model->getMaterials();
 
     for (uint32_t i = 0; i < materials.size(); i++) {
@@ -510,25 +792,219 @@ void VulkanRenderer::loadModelWithMaterials(const std::filesystem::path &path) {
     }
 
     materialsDescriptorSet->commitUpdates(ctx);
+
+    watchModelFiles();
 }
 
-void VulkanRenderer::loadModel(const std::filesystem::path &path) {
+void VulkanRenderer::stashModel() {
+    if (!model) {
+        return;
+    }
+
+    const vk::DeviceSize memoryUsage = getModelMemoryUsage();
+
+    modelCache.entries.push_front(ResidentModel{
+        .key = *modelKey,
+        .lastWriteTime = modelLastWriteTime,
+        .model = std::move(model),
+        .vertexBuffer = std::move(vertexBuffer),
+        .indexBuffer = std::move(indexBuffer),
+        .materialTextureLayersBuffer = std::move(materialTextureLayersBuffer),
+        .memoryUsage = memoryUsage,
+    });
+
+    modelKey.reset();
+}
+
+void VulkanRenderer::evictModels() {
+    vk::DeviceSize totalUsage = getModelMemoryUsage();
+
+    for (const auto &entry: modelCache.entries) {
+        totalUsage += entry.memoryUsage;
+    }
+
+    // the current model is never evicted, even if it doesn't fit on its own
+    while (totalUsage > modelCache.budget && !modelCache.entries.empty()) {
+        totalUsage -= modelCache.entries.back().memoryUsage;
+        modelCache.entries.pop_back();
+    }
+}
+
+// ==================== hot reload ====================
+
+void VulkanRenderer::watchModelFiles() {
+    fileWatcher->clear();
+
+    for (const auto &path: model->getSourceFiles()) {
+        fileWatcher->watch(path);
+    }
+}
+
+void VulkanRenderer::pollFileChanges() {
+    // a failed load leaves no current model
+    if (!model) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto &path: fileWatcher->poll()) {
+        hotReload.changedFiles.insert(std::move(path));
+        hotReload.lastChangeTime = now;
+    }
+
+    if (hotReload.pendingImport.valid()) {
+        if (hotReload.pendingImport.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            finishModelReload();
+        }
+
+        return;
+    }
+
+    // exporters often write a file in several steps, or several files one after another
+    constexpr auto SETTLE_DURATION = std::chrono::milliseconds(300);
+
+    if (!hotReload.isEnabled || hotReload.changedFiles.empty() || now - hotReload.lastChangeTime < SETTLE_DURATION) {
+        return;
+    }
+
+    auto changedFiles = std::move(hotReload.changedFiles);
+    hotReload.changedFiles.clear();
+
+    std::error_code error;
+    const auto modelPath = std::filesystem::canonical(model->getPath(), error);
+
+    // packed textures are layers of shared arrays, which are simpler to rebuild along with the whole model
+    if (changedFiles.contains(modelPath) || model->hasPackedMaterialTextures()) {
+        hotReload.importChangedFiles = std::move(changedFiles);
+        hotReload.pendingImport = std::async(std::launch::async, [path = model->getPath()] {
+            return make_unique<ModelImport>(path);
+        });
+
+        return;
+    }
+
+    reloadModelTextures(changedFiles);
+}
+
+void VulkanRenderer::reloadModelTextures(const std::set<std::filesystem::path> &files) {
     waitIdle();
 
-    model.reset();
-    model = make_unique<Model>(ctx, path, false);
+    const auto reloaded = model->reloadTextures(ctx, files);
 
-    vertexBuffer.reset();
-    indexBuffer.reset();
+    if (reloaded.empty()) {
+        return;
+    }
 
-    createModelVertexBuffer();
-    createIndexBuffer();
+    const auto &materials = model->getMaterials();
+
+    for (const auto &[materialIdx, type]: reloaded) {
+        const auto &material = materials[materialIdx];
+
+        switch (type) {
+            case MaterialTextureType::BaseColor:
+                materialsDescriptorSet->queueUpdate(ctx, 0, *material.baseColor, materialIdx);
+                break;
+            case MaterialTextureType::Normal:
+                materialsDescriptorSet->queueUpdate(ctx, 1, *material.normal, materialIdx);
+                break;
+            case MaterialTextureType::Orm:
+                materialsDescriptorSet->queueUpdate(ctx, 2, *material.orm, materialIdx);
+                break;
+        }
+    }
+
+    materialsDescriptorSet->commitUpdates(ctx);
+
+    // base color alpha decides which texels cast shadows
+    shadowMapState.isValid = false;
+    taaState.isHistoryValid = false;
+    hotReload.reloadCount++;
+    requestRedraw();
+}
+
+void VulkanRenderer::finishModelReload() {
+    unique_ptr<ModelImport> import;
+
+    try {
+        import = hotReload.pendingImport.get();
+    } catch (std::exception &e) {
+        // keep showing the model as it was, its file is likely still being written
+        std::cerr << "failed to reload model: " << e.what() << std::endl;
+        return;
+    }
+
+    waitIdle();
+
+    auto reusableTextures = model->takeReusableTextures(hotReload.importChangedFiles);
+
+    try {
+        model = make_unique<Model>(ctx, std::move(*import), modelKey->hasMaterials, modelKey->hasPackedTextures,
+                                   &reusableTextures);
+    } catch (std::exception &e) {
+        std::cerr << "failed to reload model: " << e.what() << std::endl;
+
+        // the textures given away to the failed load are gone with it
+        model->restoreTextures(ctx);
+        onModelChanged();
+        return;
+    }
+
+    createModelBuffers();
+
+    std::error_code error;
+    modelLastWriteTime = std::filesystem::last_write_time(model->getPath(), error);
+
+    evictModels();
+    onModelChanged();
+
+    hotReload.reloadCount++;
+}
+
+vk::DeviceSize VulkanRenderer::getModelMemoryUsage() const {
+    if (!model) {
+        return 0;
+    }
+
+    return vertexBuffer->getAllocationSize()
+           + indexBuffer->getAllocationSize()
+           + materialTextureLayersBuffer->getAllocationSize()
+           + model->getTextureMemoryUsage();
+}
+
+void VulkanRenderer::updateInstances(const uint32_t firstInstance, const std::vector<ModelInstance> &instances) {
+    if (instances.empty()) {
+        return;
+    }
+
+    if (firstInstance + instances.size() > instanceData.size()) {
+        throw std::runtime_error("instance update out of range!");
+    }
+
+    std::ranges::copy(instances, instanceData.begin() + firstInstance);
+    dirtyInstanceRanges.emplace_back(firstInstance, firstInstance + static_cast<uint32_t>(instances.size()));
+
+    shadowMapState.isValid = false;
+    requestRedraw();
+}
+
+void VulkanRenderer::setSceneNodeTransform(const uint32_t nodeIdx, const glm::mat4 &localTransform) {
+    model->setNodeLocalTransform(nodeIdx, localTransform);
+
+    // bones may have moved without any instance being uploaded, which would otherwise pass for a static view
+    if (model->isSkinned()) {
+        shadowMapState.isValid = false;
+        taaState.isHistoryValid = false;
+    }
+
+    requestRedraw();
 }
 
 // ==================== assets ====================
 
 void VulkanRenderer::loadBaseColorTexture(const std::filesystem::path &path) {
     waitIdle();
+    requestRedraw();
 
     separateMaterial.baseColor.reset();
     separateMaterial.baseColor = TextureBuilder()
@@ -537,10 +1013,14 @@ void VulkanRenderer::loadBaseColorTexture(const std::filesystem::path &path) {
             .create(ctx);
 
     materialsDescriptorSet->updateBinding(ctx, 0, *separateMaterial.baseColor);
+
+    // base color alpha decides which texels cast shadows
+    shadowMapState.isValid = false;
 }
 
 void VulkanRenderer::loadNormalMap(const std::filesystem::path &path) {
     waitIdle();
+    requestRedraw();
 
     separateMaterial.normal.reset();
     separateMaterial.normal = TextureBuilder()
@@ -557,6 +1037,7 @@ void VulkanRenderer::loadNormalMap(const std::filesystem::path &path) {
 
 void VulkanRenderer::loadOrmMap(const std::filesystem::path &path) {
     waitIdle();
+    requestRedraw();
 
     separateMaterial.orm.reset();
     separateMaterial.orm = TextureBuilder()
@@ -570,6 +1051,7 @@ void VulkanRenderer::loadOrmMap(const std::filesystem::path &path) {
 void VulkanRenderer::loadOrmMap(const std::filesystem::path &aoPath, const std::filesystem::path &roughnessPath,
                                 const std::filesystem::path &metallicPath) {
     waitIdle();
+    requestRedraw();
 
     separateMaterial.orm.reset();
     separateMaterial.orm = TextureBuilder()
@@ -590,6 +1072,7 @@ void VulkanRenderer::loadOrmMap(const std::filesystem::path &aoPath, const std::
 
 void VulkanRenderer::loadRmaMap(const std::filesystem::path &path) {
     waitIdle();
+    requestRedraw();
 
     separateMaterial.orm.reset();
     separateMaterial.orm = TextureBuilder()
@@ -603,20 +1086,134 @@ void VulkanRenderer::loadRmaMap(const std::filesystem::path &path) {
 
 void VulkanRenderer::loadEnvironmentMap(const std::filesystem::path &path) {
     waitIdle();
+    requestRedraw();
 
-    envmapTexture = TextureBuilder()
-            .asHdr()
-            .useFormat(hdrEnvmapFormat)
-            .fromPaths({path})
-            .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
-            .makeMipmaps()
-            .create(ctx);
+    const auto absolutePath = std::filesystem::absolute(path).lexically_normal();
+    const auto lastWriteTime = std::filesystem::last_write_time(absolutePath);
+
+    stashIblSet();
+
+    auto cachedIt = std::ranges::find_if(iblCache.entries, [&](const IblSet &entry) {
+        return entry.path == absolutePath;
+    });
+
+    if (cachedIt != iblCache.entries.end() && cachedIt->lastWriteTime != lastWriteTime) {
+        iblCache.entries.erase(cachedIt);
+        cachedIt = iblCache.entries.end();
+    }
+
+    if (cachedIt != iblCache.entries.end()) {
+        iblCache.hitCount++;
+
+        skyboxTexture = std::move(cachedIt->skybox);
+        irradianceMapTexture = std::move(cachedIt->irradianceMap);
+        prefilteredEnvmapTexture = std::move(cachedIt->prefilteredEnvmap);
+        iblDescriptorSet = std::move(cachedIt->descriptorSet);
+        iblCache.entries.erase(cachedIt);
+    } else {
+        iblCache.missCount++;
+
+        // make room before baking, so that the new set doesn't have to fit alongside all cached ones
+        evictIblSets();
+
+        // the textures created on startup are only stashed once something was baked into them
+        if (!skyboxTexture) {
+            createEnvmapTextures();
+
+            auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, iblDescriptorSetLayout, 1);
+            iblDescriptorSet = make_unique<DescriptorSet>(std::move(sets[0]));
+
+            iblDescriptorSet->queueUpdate(ctx, 0, *irradianceMapTexture)
+                    .queueUpdate(ctx, 1, *prefilteredEnvmapTexture)
+                    .queueUpdate(ctx, 2, *brdfIntegrationMapTexture)
+                    .commitUpdates(ctx);
+
+            // the bake passes render into the new textures, reusing their pipelines
+            createCubemapCaptureRenderInfo();
+            createIrradianceCaptureRenderInfo();
+            prefilterRenderInfos.clear();
+            createPrefilterRenderInfos();
+
+            envmapConvoluteDescriptorSet->updateBinding(ctx, 1, *skyboxTexture);
+        }
+
+        envmapTexture = TextureBuilder()
+                .asHdr()
+                .useFormat(hdrEnvmapFormat)
+                .fromPaths({absolutePath})
+                .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
+                .makeMipmaps()
+                .create(ctx);
+
+        cubemapCaptureDescriptorSet->updateBinding(ctx, 1, *envmapTexture);
+
+        captureCubemap();
+        captureIrradianceMap();
+        prefilterEnvmap();
+
+        // only needed for baking
+        envmapTexture.reset();
+    }
+
+    envmapPath = absolutePath;
+    envmapLastWriteTime = lastWriteTime;
+    evictIblSets();
+
+    for (const auto &res: frameResources) {
+        res.skyboxDescriptorSet->updateBinding(ctx, 1, *skyboxTexture);
+    }
+}
+
+void VulkanRenderer::clearIblCache() {
+    waitIdle();
+    iblCache.entries.clear();
+}
 
-    cubemapCaptureDescriptorSet->updateBinding(ctx, 1, *envmapTexture);
+void VulkanRenderer::stashIblSet() {
+    if (!envmapPath) {
+        return;
+    }
+
+    const vk::DeviceSize memoryUsage = getIblSetMemoryUsage();
+
+    iblCache.entries.push_front(IblSet{
+        .path = *envmapPath,
+        .lastWriteTime = envmapLastWriteTime,
+        .skybox = std::move(skyboxTexture),
+        .irradianceMap = std::move(irradianceMapTexture),
+        .prefilteredEnvmap = std::move(prefilteredEnvmapTexture),
+        .descriptorSet = std::move(iblDescriptorSet),
+        .memoryUsage = memoryUsage,
+    });
+
+    envmapPath.reset();
+}
+
+void VulkanRenderer::evictIblSets() {
+    vk::DeviceSize totalUsage = getIblSetMemoryUsage();
+
+    for (const auto &entry: iblCache.entries) {
+        totalUsage += entry.memoryUsage;
+    }
+
+    // the current set is never evicted, even if it doesn't fit on its own
+    while (
+        (totalUsage > iblCache.budget || iblCache.entries.size() > MAX_CACHED_IBL_SETS)
+        && !iblCache.entries.empty()
+    ) {
+        totalUsage -= iblCache.entries.back().memoryUsage;
+        iblCache.entries.pop_back();
+    }
+}
+
+vk::DeviceSize VulkanRenderer::getIblSetMemoryUsage() const {
+    if (!skyboxTexture) {
+        return 0;
+    }
 
-    captureCubemap();
-    captureIrradianceMap();
-    prefilterEnvmap();
+    return skyboxTexture->getImage().getAllocationSize()
+           + irradianceMapTexture->getImage().getAllocationSize()
+           + prefilteredEnvmapTexture->getImage().getAllocationSize();
 }
 
 void VulkanRenderer::createPrepassTextures() {
@@ -628,18 +1225,20 @@ void VulkanRenderer::createPrepassTextures() {
         .depth = 1
     };
 
-    gBufferTextures.pos = TextureBuilder()
+    // the g-buffer's normal and depth are read by gtao, which might run on the async compute queue
+    gBufferTextures.normal = TextureBuilder()
             .asUninitialized(extent)
-            .useFormat(prepassColorFormat)
+            .useFormat(gBufferNormalFormat)
             .useUsage(vk::ImageUsageFlagBits::eTransferSrc
                       | vk::ImageUsageFlagBits::eTransferDst
                       | vk::ImageUsageFlagBits::eSampled
                       | vk::ImageUsageFlagBits::eColorAttachment)
+            .withConcurrentSharing(ctx.concurrentQueueFamilies)
             .create(ctx);
 
-    gBufferTextures.normal = TextureBuilder()
+    gBufferTextures.velocity = TextureBuilder()
             .asUninitialized(extent)
-            .useFormat(prepassColorFormat)
+            .useFormat(gBufferVelocityFormat)
             .useUsage(vk::ImageUsageFlagBits::eTransferSrc
                       | vk::ImageUsageFlagBits::eTransferDst
                       | vk::ImageUsageFlagBits::eSampled
@@ -653,15 +1252,71 @@ void VulkanRenderer::createPrepassTextures() {
                       | vk::ImageUsageFlagBits::eTransferDst
                       | vk::ImageUsageFlagBits::eSampled
                       | vk::ImageUsageFlagBits::eDepthStencilAttachment)
+            .withConcurrentSharing(ctx.concurrentQueueFamilies)
             .create(ctx);
 
+    gBufferTextures.multisampledNormal.reset();
+    gBufferTextures.multisampledVelocity.reset();
+
+    if (getMsaaSampleCount() != vk::SampleCountFlagBits::e1) {
+        vk::ImageCreateInfo imageInfo{
+            .imageType = vk::ImageType::e2D,
+            .format = gBufferNormalFormat,
+            .extent = extent,
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = getMsaaSampleCount(),
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .initialLayout = vk::ImageLayout::eUndefined,
+        };
+
+        gBufferTextures.multisampledNormal = make_unique<Image>(
+            ctx,
+            imageInfo,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::ImageAspectFlagBits::eColor
+        );
+
+        imageInfo.format = gBufferVelocityFormat;
+
+        gBufferTextures.multisampledVelocity = make_unique<Image>(
+            ctx,
+            imageInfo,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::ImageAspectFlagBits::eColor
+        );
+    }
+
     for (auto &res: frameResources) {
         if (res.ssaoDescriptorSet) {
             res.ssaoDescriptorSet->queueUpdate(ctx, 1, *gBufferTextures.depth)
                     .queueUpdate(ctx, 2, *gBufferTextures.normal)
-                    .queueUpdate(ctx, 3, *gBufferTextures.pos)
                     .commitUpdates(ctx);
         }
+
+        for (auto &set: res.ssaoBlurDescriptorSets) {
+            if (set) {
+                set->updateBinding(ctx, 2, *gBufferTextures.depth);
+            }
+        }
+
+        for (auto &set: res.gtaoDescriptorSets) {
+            if (set) {
+                set->queueUpdate(ctx, 1, *gBufferTextures.depth)
+                        .queueUpdate(ctx, 2, *gBufferTextures.normal)
+                        .commitUpdates(ctx);
+            }
+        }
+
+        for (auto &set: res.taaDescriptorSets) {
+            if (set) {
+                set->queueUpdate(ctx, 3, *gBufferTextures.velocity)
+                        .queueUpdate(ctx, 4, *gBufferTextures.depth)
+                        .commitUpdates(ctx);
+            }
+        }
     }
 }
 
@@ -683,6 +1338,140 @@ static std::vector<glm::vec4> makeSsaoNoise() {
     return ssaoNoise;
 }
 
+void VulkanRenderer::createSceneColorTexture() {
+    const auto &[width, height] = swapChain->getExtent();
+
+    sceneColorTexture = TextureBuilder()
+            .asUninitialized({width, height, 1})
+            .useFormat(sceneColorFormat)
+            .useUsage(vk::ImageUsageFlagBits::eTransferSrc
+                      | vk::ImageUsageFlagBits::eTransferDst
+                      | vk::ImageUsageFlagBits::eSampled
+                      | vk::ImageUsageFlagBits::eColorAttachment)
+            .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
+            .create(ctx);
+
+    multisampledSceneColor.reset();
+
+    if (getMsaaSampleCount() != vk::SampleCountFlagBits::e1) {
+        const vk::ImageCreateInfo imageInfo{
+            .imageType = vk::ImageType::e2D,
+            .format = sceneColorFormat,
+            .extent = {width, height, 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = getMsaaSampleCount(),
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .initialLayout = vk::ImageLayout::eUndefined,
+        };
+
+        multisampledSceneColor = make_unique<Image>(
+            ctx,
+            imageInfo,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::ImageAspectFlagBits::eColor
+        );
+    }
+
+    if (sceneColorDescriptorSets[0]) {
+        sceneColorDescriptorSets[0]->updateBinding(ctx, 0, *sceneColorTexture);
+    }
+
+    for (auto &res: frameResources) {
+        for (auto &set: res.taaDescriptorSets) {
+            if (set) {
+                set->updateBinding(ctx, 1, *sceneColorTexture);
+            }
+        }
+    }
+}
+
+void VulkanRenderer::createTaaTextures() {
+    const auto &[width, height] = swapChain->getExtent();
+
+    for (auto &texture: taaHistoryTextures) {
+        texture = TextureBuilder()
+                .asUninitialized({width, height, 1})
+                .useFormat(sceneColorFormat)
+                .useUsage(vk::ImageUsageFlagBits::eTransferDst
+                          | vk::ImageUsageFlagBits::eSampled
+                          | vk::ImageUsageFlagBits::eColorAttachment)
+                .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
+                .create(ctx);
+    }
+
+    taaState.isHistoryValid = false;
+
+    for (size_t i = 0; i < taaHistoryTextures.size(); i++) {
+        if (sceneColorDescriptorSets[1 + i]) {
+            sceneColorDescriptorSets[1 + i]->updateBinding(ctx, 0, *taaHistoryTextures[i]);
+        }
+
+        for (auto &res: frameResources) {
+            if (res.taaDescriptorSets[i]) {
+                res.taaDescriptorSets[i]->updateBinding(ctx, 2, *taaHistoryTextures[i]);
+            }
+        }
+    }
+}
+
+void VulkanRenderer::createFxaaTexture() {
+    const auto &[width, height] = swapChain->getExtent();
+
+    fxaaOutputTexture = TextureBuilder()
+            .asUninitialized({width, height, 1})
+            .useFormat(sceneColorFormat)
+            .useUsage(vk::ImageUsageFlagBits::eTransferDst
+                      | vk::ImageUsageFlagBits::eSampled
+                      | vk::ImageUsageFlagBits::eColorAttachment)
+            .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
+            .create(ctx);
+
+    if (sceneColorDescriptorSets[3]) {
+        sceneColorDescriptorSets[3]->updateBinding(ctx, 0, *fxaaOutputTexture);
+    }
+}
+
+void VulkanRenderer::createDepthPyramidTexture() {
+    const auto &[width, height] = swapChain->getExtent();
+
+    // the first level already halves the prepass depth, as reducing it 1:1 would merely copy it
+    depthPyramidTexture = TextureBuilder()
+            .asUninitialized({std::max(width / 2, 1u), std::max(height / 2, 1u), 1})
+            .useFormat(depthPyramidFormat)
+            .useUsage(vk::ImageUsageFlagBits::eTransferDst
+                      | vk::ImageUsageFlagBits::eSampled
+                      | vk::ImageUsageFlagBits::eStorage)
+            .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
+            .makeMipmaps()
+            .create(ctx);
+
+    if (depthPyramidTexture->getMipLevels() > MAX_DEPTH_PYRAMID_LEVELS) {
+        throw std::runtime_error("swap chain extent is too large for the depth pyramid!");
+    }
+
+    for (auto &res: frameResources) {
+        if (res.cullingDescriptorSet) {
+            res.cullingDescriptorSet->updateBinding(ctx, 1, *depthPyramidTexture);
+        }
+    }
+}
+
+void VulkanRenderer::createShadowMapTexture() {
+    shadowMapTexture = TextureBuilder()
+            .asUninitialized({SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1})
+            .useFormat(shadowMapFormat)
+            .useUsage(vk::ImageUsageFlagBits::eTransferSrc
+                      | vk::ImageUsageFlagBits::eTransferDst
+                      | vk::ImageUsageFlagBits::eSampled
+                      | vk::ImageUsageFlagBits::eDepthStencilAttachment)
+            .create(ctx);
+
+    shadowMapState.isValid = false;
+}
+
 void VulkanRenderer::createSsaoTextures() {
     const auto &[width, height] = swapChain->getExtent();
 
@@ -698,7 +1487,9 @@ void VulkanRenderer::createSsaoTextures() {
             .useUsage(vk::ImageUsageFlagBits::eTransferSrc
                       | vk::ImageUsageFlagBits::eTransferDst
                       | vk::ImageUsageFlagBits::eSampled
-                      | vk::ImageUsageFlagBits::eColorAttachment)
+                      | vk::ImageUsageFlagBits::eColorAttachment
+                      | vk::ImageUsageFlagBits::eStorage)
+            .withConcurrentSharing(ctx.concurrentQueueFamilies)
             .create(ctx);
 
     auto noise = makeSsaoNoise();
@@ -713,22 +1504,84 @@ void VulkanRenderer::createSsaoTextures() {
             .withSamplerAddressMode(vk::SamplerAddressMode::eRepeat)
             .create(ctx);
 
+    // the blur passes only carry the occlusion itself
+    ssaoBlurIntermediateTexture = TextureBuilder()
+            .asUninitialized(extent)
+            .useFormat(vk::Format::eR8Unorm)
+            .useUsage(vk::ImageUsageFlagBits::eSampled
+                      | vk::ImageUsageFlagBits::eColorAttachment)
+            .create(ctx);
+
+    ssaoBlurredTexture = TextureBuilder()
+            .asUninitialized(extent)
+            .useFormat(vk::Format::eR8Unorm)
+            .useUsage(vk::ImageUsageFlagBits::eTransferSrc
+                      | vk::ImageUsageFlagBits::eTransferDst
+                      | vk::ImageUsageFlagBits::eSampled
+                      | vk::ImageUsageFlagBits::eColorAttachment)
+            .create(ctx);
+
+    for (auto &texture: gtaoHistoryTextures) {
+        texture = TextureBuilder()
+                .asUninitialized(extent)
+                .useFormat(vk::Format::eR16G16B16A16Sfloat)
+                .useUsage(vk::ImageUsageFlagBits::eTransferDst
+                          | vk::ImageUsageFlagBits::eStorage)
+                .useLayout(vk::ImageLayout::eGeneral)
+                .withConcurrentSharing(ctx.concurrentQueueFamilies)
+                .create(ctx);
+    }
+
+    // old history doesn't match the new resolution, so it can't be reprojected
+    gtaoState.isHistoryValid = false;
+
     if (debugQuadDescriptorSet) {
-        debugQuadDescriptorSet->updateBinding(ctx, 0, *ssaoTexture);
+        debugQuadDescriptorSet->updateBinding(ctx, 0, *ssaoBlurredTexture);
     }
 
     for (auto &res: frameResources) {
         if (res.sceneDescriptorSet) {
-            res.sceneDescriptorSet->updateBinding(ctx, 1, *ssaoTexture);
+            res.sceneDescriptorSet->updateBinding(ctx, 1, *ssaoBlurredTexture);
         }
 
         if (res.ssaoDescriptorSet) {
-            res.ssaoDescriptorSet->updateBinding(ctx, 4, *ssaoNoiseTexture);
+            res.ssaoDescriptorSet->updateBinding(ctx, 3, *ssaoNoiseTexture);
+        }
+
+        if (res.ssaoBlurDescriptorSets[0]) {
+            res.ssaoBlurDescriptorSets[0]->updateBinding(ctx, 1, *ssaoTexture);
+        }
+
+        if (res.ssaoBlurDescriptorSets[1]) {
+            res.ssaoBlurDescriptorSets[1]->updateBinding(ctx, 1, *ssaoBlurIntermediateTexture);
+        }
+
+        for (size_t i = 0; i < res.gtaoDescriptorSets.size(); i++) {
+            if (res.gtaoDescriptorSets[i]) {
+                res.gtaoDescriptorSets[i]->queueUpdate(ctx, 3, *ssaoTexture, vk::DescriptorType::eStorageImage)
+                        .queueUpdate(ctx, 4, *gtaoHistoryTextures[i], vk::DescriptorType::eStorageImage)
+                        .queueUpdate(ctx, 5, *gtaoHistoryTextures[1 - i], vk::DescriptorType::eStorageImage)
+                        .commitUpdates(ctx);
+            }
         }
     }
 }
 
 void VulkanRenderer::createIblTextures() {
+    createEnvmapTextures();
+
+    brdfIntegrationMapTexture = TextureBuilder()
+            .asUninitialized({512, 512, 1})
+            .useFormat(brdfIntegrationMapFormat)
+            .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
+            .useUsage(vk::ImageUsageFlagBits::eTransferSrc
+                      | vk::ImageUsageFlagBits::eTransferDst
+                      | vk::ImageUsageFlagBits::eSampled
+                      | vk::ImageUsageFlagBits::eColorAttachment)
+            .create(ctx);
+}
+
+void VulkanRenderer::createEnvmapTextures() {
     const auto attachmentUsageFlags = vk::ImageUsageFlagBits::eTransferSrc
                                       | vk::ImageUsageFlagBits::eTransferDst
                                       | vk::ImageUsageFlagBits::eSampled
@@ -760,13 +1613,6 @@ void VulkanRenderer::createIblTextures() {
             .useUsage(attachmentUsageFlags)
             .makeMipmaps()
             .create(ctx);
-
-    brdfIntegrationMapTexture = TextureBuilder()
-            .asUninitialized({512, 512, 1})
-            .useFormat(brdfIntegrationMapFormat)
-            .withSamplerAddressMode(vk::SamplerAddressMode::eClampToEdge)
-            .useUsage(attachmentUsageFlags)
-            .create(ctx);
 }
 
 // ==================== swapchain ====================
@@ -782,25 +1628,42 @@ void VulkanRenderer::recreateSwapChain() {
 
     waitIdle();
 
+    // present ids are only meaningful for the swap chain they were passed to
+    latencyState.pendingPresents.clear();
+
     swapChain.reset();
     swapChain = make_unique<SwapChain>(
         ctx,
         *surface,
         findQueueFamilies(*ctx.physicalDevice),
         window,
-        getMsaaSampleCount()
+        getMsaaSampleCount(),
+        latencyState.presentMode
     );
 
+    // the scene pass depth-tests against the prepass depth, so its targets have to exist first
+    createPrepassTextures();
+    createPrepassRenderInfo();
+
+    createDepthPyramidTexture();
+    createDepthPyramidDescriptorSets();
+
+    createSceneColorTexture();
+    createTaaTextures();
+    createFxaaTexture();
+
     // todo - this shouldn't recreate pipelines
     createSceneRenderInfos();
     createSkyboxRenderInfos();
     createGuiRenderInfos();
     createDebugQuadRenderInfos();
+    createTaaRenderInfos();
+    createFxaaRenderInfo();
+    createUpscaleRenderInfos();
 
-    createPrepassTextures();
-    createPrepassRenderInfo();
     createSsaoTextures();
     createSsaoRenderInfo();
+    createSsaoBlurRenderInfos();
 }
 
 // ==================== descriptors ====================
@@ -816,14 +1679,27 @@ void VulkanRenderer::createDescriptorPool() {
         .descriptorCount = 1000u,
     };
 
+    static constexpr vk::DescriptorPoolSize storageImagePoolSize{
+        .type = vk::DescriptorType::eStorageImage,
+        .descriptorCount = 100u,
+    };
+
+    static constexpr vk::DescriptorPoolSize storageBufferPoolSize{
+        .type = vk::DescriptorType::eStorageBuffer,
+        .descriptorCount = 100u,
+    };
+
     static constexpr std::array poolSizes = {
         uboPoolSize,
-        samplerPoolSize
+        samplerPoolSize,
+        storageImagePoolSize,
+        storageBufferPoolSize
     };
 
     static constexpr vk::DescriptorPoolCreateInfo poolInfo{
         .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
-        .maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 4 + 5,
+        .maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * FrameResources::DESCRIPTOR_SET_COUNT + 9
+                   + MAX_DEPTH_PYRAMID_LEVELS + MAX_CACHED_IBL_SETS,
         .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
         .pPoolSizes = poolSizes.data(),
     };
@@ -838,6 +1714,8 @@ void VulkanRenderer::createSceneDescriptorSets() {
                 vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
             )
             .addBinding(vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment) // ssao
+            .addRepeatedBindings(3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment) // lights
+            .addBinding(vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment) // shadow map
             .create(ctx);
 
     const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
@@ -854,7 +1732,26 @@ void VulkanRenderer::createSceneDescriptorSets() {
                     vk::DescriptorType::eUniformBuffer,
                     sizeof(GraphicsUBO)
                 )
-                .queueUpdate(ctx, 1, *ssaoTexture)
+                .queueUpdate(ctx, 1, *ssaoBlurredTexture)
+                .queueUpdate(
+                    2,
+                    *res.lightBuffer,
+                    vk::DescriptorType::eStorageBuffer,
+                    sizeof(LightBufferHeader) + LightClusterGrid::MAX_LIGHTS * sizeof(LightData)
+                )
+                .queueUpdate(
+                    3,
+                    *res.lightClusterBuffer,
+                    vk::DescriptorType::eStorageBuffer,
+                    LightClusterGrid::CLUSTER_COUNT * sizeof(glm::uvec2)
+                )
+                .queueUpdate(
+                    4,
+                    *res.lightIndexBuffer,
+                    vk::DescriptorType::eStorageBuffer,
+                    LightClusterGrid::MAX_LIGHT_INDICES * sizeof(uint32_t)
+                )
+                .queueUpdate(ctx, 5, *shadowMapTexture)
                 .commitUpdates(ctx);
     }
 }
@@ -867,6 +1764,12 @@ void VulkanRenderer::createMaterialsDescriptorSet() {
                 vk::ShaderStageFlagBits::eFragment,
                 MATERIAL_TEX_ARRAY_SIZE
             )
+            .addBinding(
+                vk::DescriptorType::eCombinedImageSampler,
+                vk::ShaderStageFlagBits::eFragment,
+                MAX_MATERIAL_TEXTURE_ARRAYS
+            )
+            .addBinding(vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
             .create(ctx);
 
     const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
@@ -936,7 +1839,7 @@ void VulkanRenderer::createSsaoDescriptorSets() {
                 vk::DescriptorType::eUniformBuffer,
                 vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
             )
-            .addRepeatedBindings(4, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+            .addRepeatedBindings(3, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
             .create(ctx);
 
     const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
@@ -955,19 +1858,87 @@ void VulkanRenderer::createSsaoDescriptorSets() {
                 )
                 .queueUpdate(ctx, 1, *gBufferTextures.depth)
                 .queueUpdate(ctx, 2, *gBufferTextures.normal)
-                .queueUpdate(ctx, 3, *gBufferTextures.pos)
-                .queueUpdate(ctx, 4, *ssaoNoiseTexture)
+                .queueUpdate(ctx, 3, *ssaoNoiseTexture)
                 .commitUpdates(ctx);
     }
 }
 
+void VulkanRenderer::createSsaoBlurDescriptorSets() {
+    auto layout = DescriptorLayoutBuilder()
+            .addBinding(
+                vk::DescriptorType::eUniformBuffer,
+                vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
+            )
+            .addRepeatedBindings(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+            .create(ctx);
+
+    const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, layoutPtr, MAX_FRAMES_IN_FLIGHT * 2);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frameResources[i].ssaoBlurDescriptorSets[0] = make_unique<DescriptorSet>(std::move(sets[2 * i]));
+        frameResources[i].ssaoBlurDescriptorSets[1] = make_unique<DescriptorSet>(std::move(sets[2 * i + 1]));
+    }
+
+    for (auto &res: frameResources) {
+        const std::array<const Texture *, 2> inputs = {&*ssaoTexture, &*ssaoBlurIntermediateTexture};
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            res.ssaoBlurDescriptorSets[i]->queueUpdate(
+                        0,
+                        *res.graphicsUniformBuffer,
+                        vk::DescriptorType::eUniformBuffer,
+                        sizeof(GraphicsUBO)
+                    )
+                    .queueUpdate(ctx, 1, *inputs[i])
+                    .queueUpdate(ctx, 2, *gBufferTextures.depth)
+                    .commitUpdates(ctx);
+        }
+    }
+}
+
+void VulkanRenderer::createGtaoDescriptorSets() {
+    auto layout = DescriptorLayoutBuilder()
+            .addBinding(vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eCompute)
+            .addRepeatedBindings(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eCompute)
+            .addRepeatedBindings(3, vk::DescriptorType::eStorageImage, vk::ShaderStageFlagBits::eCompute)
+            .create(ctx);
+
+    const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, layoutPtr, MAX_FRAMES_IN_FLIGHT * 2);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frameResources[i].gtaoDescriptorSets[0] = make_unique<DescriptorSet>(std::move(sets[2 * i]));
+        frameResources[i].gtaoDescriptorSets[1] = make_unique<DescriptorSet>(std::move(sets[2 * i + 1]));
+    }
+
+    for (auto &res: frameResources) {
+        // set `i` reads history texture `i` and writes the other one
+        for (size_t i = 0; i < res.gtaoDescriptorSets.size(); i++) {
+            res.gtaoDescriptorSets[i]->queueUpdate(
+                        0,
+                        *res.graphicsUniformBuffer,
+                        vk::DescriptorType::eUniformBuffer,
+                        sizeof(GraphicsUBO)
+                    )
+                    .queueUpdate(ctx, 1, *gBufferTextures.depth)
+                    .queueUpdate(ctx, 2, *gBufferTextures.normal)
+                    .queueUpdate(ctx, 3, *ssaoTexture, vk::DescriptorType::eStorageImage)
+                    .queueUpdate(ctx, 4, *gtaoHistoryTextures[i], vk::DescriptorType::eStorageImage)
+                    .queueUpdate(ctx, 5, *gtaoHistoryTextures[1 - i], vk::DescriptorType::eStorageImage)
+                    .commitUpdates(ctx);
+        }
+    }
+}
+
 void VulkanRenderer::createIblDescriptorSet() {
     auto layout = DescriptorLayoutBuilder()
             .addRepeatedBindings(3, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
             .create(ctx);
 
-    const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
-    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, layoutPtr, 1);
+    // kept around, as every baked ibl set gets a descriptor set of its own
+    iblDescriptorSetLayout = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, iblDescriptorSetLayout, 1);
 
     iblDescriptorSet = make_unique<DescriptorSet>(std::move(sets[0]));
 
@@ -1028,8 +1999,130 @@ void VulkanRenderer::createDebugQuadDescriptorSet() {
 
     debugQuadDescriptorSet = make_unique<DescriptorSet>(std::move(sets[0]));
 
-    if (ssaoTexture) {
-        debugQuadDescriptorSet->updateBinding(ctx, 0, *ssaoTexture);
+    if (ssaoBlurredTexture) {
+        debugQuadDescriptorSet->updateBinding(ctx, 0, *ssaoBlurredTexture);
+    }
+}
+
+void VulkanRenderer::createTaaDescriptorSets() {
+    auto layout = DescriptorLayoutBuilder()
+            .addBinding(vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+            .addRepeatedBindings(4, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+            .create(ctx);
+
+    const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, layoutPtr, MAX_FRAMES_IN_FLIGHT * 2);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frameResources[i].taaDescriptorSets[0] = make_unique<DescriptorSet>(std::move(sets[2 * i]));
+        frameResources[i].taaDescriptorSets[1] = make_unique<DescriptorSet>(std::move(sets[2 * i + 1]));
+    }
+
+    for (auto &res: frameResources) {
+        // set `i` reads history texture `i`, the other one is written as a color attachment
+        for (size_t i = 0; i < res.taaDescriptorSets.size(); i++) {
+            res.taaDescriptorSets[i]->queueUpdate(
+                        0,
+                        *res.graphicsUniformBuffer,
+                        vk::DescriptorType::eUniformBuffer,
+                        sizeof(GraphicsUBO)
+                    )
+                    .queueUpdate(ctx, 1, *sceneColorTexture)
+                    .queueUpdate(ctx, 2, *taaHistoryTextures[i])
+                    .queueUpdate(ctx, 3, *gBufferTextures.velocity)
+                    .queueUpdate(ctx, 4, *gBufferTextures.depth)
+                    .commitUpdates(ctx);
+        }
+    }
+}
+
+void VulkanRenderer::createSceneColorDescriptorSets() {
+    auto layout = DescriptorLayoutBuilder()
+            .addBinding(vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+            .create(ctx);
+
+    const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, layoutPtr, sceneColorDescriptorSets.size());
+
+    for (size_t i = 0; i < sceneColorDescriptorSets.size(); i++) {
+        sceneColorDescriptorSets[i] = make_unique<DescriptorSet>(std::move(sets[i]));
+    }
+
+    sceneColorDescriptorSets[0]->updateBinding(ctx, 0, *sceneColorTexture);
+
+    for (size_t i = 0; i < taaHistoryTextures.size(); i++) {
+        sceneColorDescriptorSets[1 + i]->updateBinding(ctx, 0, *taaHistoryTextures[i]);
+    }
+
+    sceneColorDescriptorSets[3]->updateBinding(ctx, 0, *fxaaOutputTexture);
+}
+
+void VulkanRenderer::createDepthPyramidDescriptorSets() {
+    // kept across swap chain recreations, as the pipeline refers to it
+    if (!depthPyramidDescriptorLayout) {
+        auto layout = DescriptorLayoutBuilder()
+                .addBinding(vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eCompute)
+                .addRepeatedBindings(2, vk::DescriptorType::eStorageImage, vk::ShaderStageFlagBits::eCompute)
+                .create(ctx);
+
+        depthPyramidDescriptorLayout = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    }
+
+    const uint32_t levelCount = depthPyramidTexture->getMipLevels();
+
+    depthPyramidDescriptorSets.clear();
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, depthPyramidDescriptorLayout, levelCount);
+
+    for (uint32_t level = 0; level < levelCount; level++) {
+        auto &set = depthPyramidDescriptorSets.emplace_back(make_unique<DescriptorSet>(std::move(sets[level])));
+
+        // the first level is reduced from the prepass depth, so its source level binding is never read
+        set->queueUpdate(ctx, 0, *gBufferTextures.depth)
+                .queueMipUpdate(ctx, 1, *depthPyramidTexture, level == 0 ? 0 : level - 1,
+                                vk::DescriptorType::eStorageImage)
+                .queueMipUpdate(ctx, 2, *depthPyramidTexture, level, vk::DescriptorType::eStorageImage)
+                .commitUpdates(ctx);
+    }
+}
+
+void VulkanRenderer::createCullingDescriptorSets() {
+    auto layout = DescriptorLayoutBuilder()
+            .addBinding(vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eCompute)
+            .addBinding(vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eCompute)
+            .addRepeatedBindings(5, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+            .create(ctx);
+
+    const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, layoutPtr, MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frameResources[i].cullingDescriptorSet = make_unique<DescriptorSet>(std::move(sets[i]));
+    }
+
+    // the remaining bindings depend on the model, so they're filled in by `createCullingBuffers`
+    for (auto &res: frameResources) {
+        res.cullingDescriptorSet->queueUpdate(
+                    0,
+                    *res.graphicsUniformBuffer,
+                    vk::DescriptorType::eUniformBuffer,
+                    sizeof(GraphicsUBO)
+                )
+                .queueUpdate(ctx, 1, *depthPyramidTexture)
+                .commitUpdates(ctx);
+    }
+}
+
+void VulkanRenderer::createSkinningDescriptorSets() {
+    auto layout = DescriptorLayoutBuilder()
+            .addRepeatedBindings(4, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+            .create(ctx);
+
+    const auto layoutPtr = make_shared<vk::raii::DescriptorSetLayout>(std::move(layout));
+    auto sets = vkutils::desc::createDescriptorSets(ctx, *descriptorPool, layoutPtr, MAX_FRAMES_IN_FLIGHT);
+
+    // all bindings depend on the model, so they're filled in by `createSkinningBuffers`
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frameResources[i].skinningDescriptorSet = make_unique<DescriptorSet>(std::move(sets[i]));
     }
 }
 
@@ -1076,7 +2169,7 @@ vk::CommandBufferInheritanceRenderingInfo RenderInfo::getInheritanceRenderingInf
     return {
         .colorAttachmentCount = static_cast<uint32_t>(cachedColorAttachmentFormats.size()),
         .pColorAttachmentFormats = cachedColorAttachmentFormats.data(),
-        .depthAttachmentFormat = depthTarget->getFormat(),
+        .depthAttachmentFormat = depthTarget ? depthTarget->getFormat() : vk::Format::eUndefined,
         .rasterizationSamples = pipeline->getSampleCount(),
     };
 }
@@ -1097,8 +2190,6 @@ void RenderInfo::makeAttachmentInfos() {
 }
 
 void VulkanRenderer::createSceneRenderInfos() {
-    sceneRenderInfos.clear();
-
     auto builder = PipelineBuilder()
             .withVertexShader("../shaders/obj/main-vert.spv")
             .withFragmentShader("../shaders/obj/main-frag.spv")
@@ -1125,24 +2216,46 @@ void VulkanRenderer::createSceneRenderInfos() {
                     .size = sizeof(ScenePushConstants),
                 }
             })
-            .withColorFormats({swapChain->getImageFormat()})
-            .withDepthFormat(swapChain->getDepthFormat());
+            .withDepthStencil({
+                .depthTestEnable = vk::True,
+                .depthWriteEnable = vk::False,
+                .depthCompareOp = vk::CompareOp::eLessOrEqual,
+            })
+            .withColorFormats({sceneColorFormat})
+            .withDepthFormat(swapChain->getDepthFormat());
 
     auto pipeline = make_shared<Pipeline>(builder.create(ctx));
 
-    for (auto &target: swapChain->getRenderTargets(ctx)) {
-        std::vector<RenderTarget> colorTargets;
-        colorTargets.emplace_back(std::move(target.colorTarget));
+    const bool isMsaa = getMsaaSampleCount() != vk::SampleCountFlagBits::e1;
 
-        target.depthTarget.overrideAttachmentConfig(vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare);
+    // the scene is rendered into an intermediate hdr texture at the internal resolution,
+    // which then gets resolved by taa and tonemapped while being upscaled
+    std::vector<RenderTarget> colorTargets;
 
-        sceneRenderInfos.emplace_back(
-            builder,
-            pipeline,
-            std::move(colorTargets),
-            std::move(target.depthTarget)
+    if (isMsaa) {
+        colorTargets.emplace_back(
+            multisampledSceneColor->getView(ctx),
+            sceneColorTexture->getImage().getView(ctx),
+            sceneColorTexture->getFormat()
         );
+    } else {
+        colorTargets.emplace_back(ctx, *sceneColorTexture);
     }
+
+    // depth is already laid down by the prepass, so that every visible pixel is shaded exactly once.
+    // without msaa the prepass renders straight into the g-buffer depth, otherwise into the swap chain's one.
+    RenderTarget depthTarget = isMsaa
+                                   ? RenderTarget{swapChain->getDepthImage().getView(ctx), swapChain->getDepthFormat()}
+                                   : RenderTarget{ctx, *gBufferTextures.depth};
+
+    depthTarget.overrideAttachmentConfig(vk::AttachmentLoadOp::eLoad);
+
+    sceneRenderInfo = make_unique<RenderInfo>(
+        builder,
+        pipeline,
+        std::move(colorTargets),
+        std::move(depthTarget)
+    );
 }
 
 void VulkanRenderer::createSkyboxRenderInfos() {
@@ -1169,7 +2282,7 @@ void VulkanRenderer::createSkyboxRenderInfos() {
             .withDescriptorLayouts({
                 *frameResources[0].skyboxDescriptorSet->getLayout(),
             })
-            .withColorFormats({swapChain->getImageFormat()})
+            .withColorFormats({sceneColorFormat})
             .withDepthFormat(swapChain->getDepthFormat());
 
     auto pipeline = make_shared<Pipeline>(builder.create(ctx));
@@ -1202,10 +2315,33 @@ void VulkanRenderer::createGuiRenderInfos() {
 
 void VulkanRenderer::createPrepassRenderInfo() {
     std::vector<RenderTarget> colorTargets;
-    colorTargets.emplace_back(ctx, *gBufferTextures.normal);
-    colorTargets.emplace_back(ctx, *gBufferTextures.pos);
+    std::optional<RenderTarget> depthTarget;
+
+    // with msaa, the prepass rasterizes into the multisampled depth shared with the scene pass
+    // and resolves single-sampled copies into the g-buffer, which is what the ssao passes read
+    if (gBufferTextures.multisampledNormal) {
+        colorTargets.emplace_back(
+            gBufferTextures.multisampledNormal->getView(ctx),
+            gBufferTextures.normal->getImage().getView(ctx),
+            gBufferTextures.normal->getFormat()
+        );
+
+        colorTargets.emplace_back(
+            gBufferTextures.multisampledVelocity->getView(ctx),
+            gBufferTextures.velocity->getImage().getView(ctx),
+            gBufferTextures.velocity->getFormat()
+        );
 
-    RenderTarget depthTarget{ctx, *gBufferTextures.depth};
+        depthTarget.emplace(
+            swapChain->getDepthImage().getView(ctx),
+            gBufferTextures.depth->getImage().getView(ctx),
+            swapChain->getDepthFormat()
+        );
+    } else {
+        colorTargets.emplace_back(ctx, *gBufferTextures.normal);
+        colorTargets.emplace_back(ctx, *gBufferTextures.velocity);
+        depthTarget.emplace(ctx, *gBufferTextures.depth);
+    }
 
     std::vector<vk::Format> colorFormats;
     for (const auto &target: colorTargets) colorFormats.emplace_back(target.getFormat());
@@ -1216,15 +2352,26 @@ void VulkanRenderer::createPrepassRenderInfo() {
             .withVertices<ModelVertex>()
             .withRasterizer({
                 .polygonMode = vk::PolygonMode::eFill,
-                .cullMode = vk::CullModeFlagBits::eNone,
+                .cullMode = cullBackFaces ? vk::CullModeFlagBits::eBack : vk::CullModeFlagBits::eNone,
                 .frontFace = vk::FrontFace::eCounterClockwise,
                 .lineWidth = 1.0f,
             })
+            .withMultisampling({
+                .rasterizationSamples = getMsaaSampleCount(),
+            })
             .withDescriptorLayouts({
                 *frameResources[0].prepassDescriptorSet->getLayout(),
+                *materialsDescriptorSet->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eFragment,
+                    .offset = 0,
+                    .size = sizeof(ScenePushConstants),
+                }
             })
             .withColorFormats(colorFormats)
-            .withDepthFormat(depthTarget.getFormat());
+            .withDepthFormat(depthTarget->getFormat());
 
     auto pipeline = make_shared<Pipeline>(builder.create(ctx));
 
@@ -1232,6 +2379,46 @@ void VulkanRenderer::createPrepassRenderInfo() {
         builder,
         pipeline,
         std::move(colorTargets),
+        std::move(*depthTarget)
+    );
+}
+
+void VulkanRenderer::createShadowRenderInfo() {
+    RenderTarget depthTarget{ctx, *shadowMapTexture};
+
+    auto builder = PipelineBuilder()
+            .withVertexShader("../shaders/obj/shadow-vert.spv")
+            .withFragmentShader("../shaders/obj/shadow-frag.spv")
+            .withVertices<ModelVertex>()
+            .withRasterizer({
+                .polygonMode = vk::PolygonMode::eFill,
+                .cullMode = vk::CullModeFlagBits::eNone,
+                .frontFace = vk::FrontFace::eCounterClockwise,
+                .depthBiasEnable = vk::True,
+                .depthBiasConstantFactor = 1.25f,
+                .depthBiasSlopeFactor = 1.75f,
+                .lineWidth = 1.0f,
+            })
+            .withDescriptorLayouts({
+                *frameResources[0].prepassDescriptorSet->getLayout(),
+                *materialsDescriptorSet->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eFragment,
+                    .offset = 0,
+                    .size = sizeof(ScenePushConstants),
+                }
+            })
+            .withColorFormats({})
+            .withDepthFormat(depthTarget.getFormat());
+
+    auto pipeline = make_shared<Pipeline>(builder.create(ctx));
+
+    shadowRenderInfo = make_unique<RenderInfo>(
+        builder,
+        pipeline,
+        std::vector<RenderTarget>{},
         std::move(depthTarget)
     );
 }
@@ -1266,6 +2453,114 @@ void VulkanRenderer::createSsaoRenderInfo() {
     );
 }
 
+void VulkanRenderer::createSsaoBlurRenderInfos() {
+    ssaoBlurRenderInfos.clear();
+
+    const std::array<const Texture *, 2> outputs = {&*ssaoBlurIntermediateTexture, &*ssaoBlurredTexture};
+
+    // both directions share a pipeline, the direction itself comes from push constants
+    auto builder = PipelineBuilder()
+            .withVertexShader("../shaders/obj/ss-quad-vert.spv")
+            .withFragmentShader("../shaders/obj/ssao-blur-frag.spv")
+            .withVertices<ScreenSpaceQuadVertex>()
+            .withRasterizer({
+                .polygonMode = vk::PolygonMode::eFill,
+                .cullMode = vk::CullModeFlagBits::eNone,
+                .frontFace = vk::FrontFace::eCounterClockwise,
+                .lineWidth = 1.0f,
+            })
+            .withDescriptorLayouts({
+                *frameResources[0].ssaoBlurDescriptorSets[0]->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eFragment,
+                    .offset = 0,
+                    .size = sizeof(SsaoBlurPushConstants),
+                }
+            })
+            .withColorFormats({outputs[0]->getFormat()});
+
+    auto pipeline = make_shared<Pipeline>(builder.create(ctx));
+
+    for (const auto *output: outputs) {
+        std::vector<RenderTarget> targets;
+        targets.emplace_back(ctx, *output);
+
+        ssaoBlurRenderInfos.emplace_back(
+            builder,
+            pipeline,
+            std::move(targets)
+        );
+    }
+}
+
+void VulkanRenderer::createGtaoPipeline() {
+    gtaoPipelineBuilder = ComputePipelineBuilder()
+            .withComputeShader("../shaders/obj/gtao-comp.spv")
+            .withDescriptorLayouts({
+                *frameResources[0].gtaoDescriptorSets[0]->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute,
+                    .offset = 0,
+                    .size = sizeof(GtaoPushConstants),
+                }
+            });
+
+    gtaoPipeline = make_unique<Pipeline>(gtaoPipelineBuilder->create(ctx));
+}
+
+void VulkanRenderer::createCullingPipelines() {
+    depthPyramidPipelineBuilder = ComputePipelineBuilder()
+            .withComputeShader("../shaders/obj/depth-pyramid-comp.spv")
+            .withDescriptorLayouts({
+                **depthPyramidDescriptorLayout,
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute,
+                    .offset = 0,
+                    .size = sizeof(DepthPyramidPushConstants),
+                }
+            });
+
+    depthPyramidPipeline = make_unique<Pipeline>(depthPyramidPipelineBuilder->create(ctx));
+
+    cullingPipelineBuilder = ComputePipelineBuilder()
+            .withComputeShader("../shaders/obj/cull-comp.spv")
+            .withDescriptorLayouts({
+                *frameResources[0].cullingDescriptorSet->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute,
+                    .offset = 0,
+                    .size = sizeof(CullPushConstants),
+                }
+            });
+
+    cullingPipeline = make_unique<Pipeline>(cullingPipelineBuilder->create(ctx));
+}
+
+void VulkanRenderer::createSkinningPipeline() {
+    skinningPipelineBuilder = ComputePipelineBuilder()
+            .withComputeShader("../shaders/obj/skin-comp.spv")
+            .withDescriptorLayouts({
+                *frameResources[0].skinningDescriptorSet->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eCompute,
+                    .offset = 0,
+                    .size = sizeof(SkinningPushConstants),
+                }
+            });
+
+    skinningPipeline = make_unique<Pipeline>(skinningPipelineBuilder->create(ctx));
+}
+
 void VulkanRenderer::createCubemapCaptureRenderInfo() {
     RenderTarget target{
         skyboxTexture->getImage().getMipView(ctx, 0),
@@ -1447,11 +2742,11 @@ void VulkanRenderer::createDebugQuadRenderInfos() {
             .withDescriptorLayouts({
                 *debugQuadDescriptorSet->getLayout(),
             })
-            .withColorFormats({swapChain->getImageFormat()})
-            .withDepthFormat(swapChain->getDepthFormat());
+            .withColorFormats({swapChain->getImageFormat()});
 
     auto pipeline = make_shared<Pipeline>(builder.create(ctx));
 
+    // drawn within the upscale pass, after tonemapping, so that the displayed texture isn't altered
     for (auto &target: swapChain->getRenderTargets(ctx)) {
         std::vector<RenderTarget> colorTargets;
         colorTargets.emplace_back(std::move(target.colorTarget));
@@ -1459,8 +2754,129 @@ void VulkanRenderer::createDebugQuadRenderInfos() {
         debugQuadRenderInfos.emplace_back(
             builder,
             pipeline,
-            std::move(colorTargets),
-            std::move(target.depthTarget)
+            std::move(colorTargets)
+        );
+    }
+}
+
+void VulkanRenderer::createTaaRenderInfos() {
+    taaRenderInfos.clear();
+
+    auto builder = PipelineBuilder()
+            .withVertexShader("../shaders/obj/ss-quad-vert.spv")
+            .withFragmentShader("../shaders/obj/taa-frag.spv")
+            .withVertices<ScreenSpaceQuadVertex>()
+            .withRasterizer({
+                .polygonMode = vk::PolygonMode::eFill,
+                .cullMode = vk::CullModeFlagBits::eNone,
+                .frontFace = vk::FrontFace::eCounterClockwise,
+                .lineWidth = 1.0f,
+            })
+            .withDescriptorLayouts({
+                *frameResources[0].taaDescriptorSets[0]->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eFragment,
+                    .offset = 0,
+                    .size = sizeof(TaaPushConstants),
+                }
+            })
+            .withColorFormats({sceneColorFormat});
+
+    auto pipeline = make_shared<Pipeline>(builder.create(ctx));
+
+    for (const auto &texture: taaHistoryTextures) {
+        std::vector<RenderTarget> targets;
+        targets.emplace_back(ctx, *texture);
+
+        taaRenderInfos.emplace_back(
+            builder,
+            pipeline,
+            std::move(targets)
+        );
+    }
+}
+
+void VulkanRenderer::createFxaaRenderInfo() {
+    auto builder = PipelineBuilder()
+            .withVertexShader("../shaders/obj/ss-quad-vert.spv")
+            .withFragmentShader("../shaders/obj/fxaa-frag.spv")
+            .withVertices<ScreenSpaceQuadVertex>()
+            .withRasterizer({
+                .polygonMode = vk::PolygonMode::eFill,
+                .cullMode = vk::CullModeFlagBits::eNone,
+                .frontFace = vk::FrontFace::eCounterClockwise,
+                .lineWidth = 1.0f,
+            })
+            .withDescriptorLayouts({
+                *sceneColorDescriptorSets[0]->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eFragment,
+                    .offset = 0,
+                    .size = sizeof(FxaaPushConstants),
+                }
+            })
+            .withColorFormats({fxaaOutputTexture->getFormat()});
+
+    auto pipeline = make_shared<Pipeline>(builder.create(ctx));
+
+    std::vector<RenderTarget> targets;
+    targets.emplace_back(ctx, *fxaaOutputTexture);
+
+    fxaaRenderInfo = make_unique<RenderInfo>(
+        builder,
+        pipeline,
+        std::move(targets)
+    );
+}
+
+void VulkanRenderer::createUpscaleRenderInfos() {
+    upscaleRenderInfos.clear();
+
+    auto builder = PipelineBuilder()
+            .withVertexShader("../shaders/obj/ss-quad-vert.spv")
+            .withFragmentShader("../shaders/obj/upscale-frag.spv")
+            .withVertices<ScreenSpaceQuadVertex>()
+            .withRasterizer({
+                .polygonMode = vk::PolygonMode::eFill,
+                .cullMode = vk::CullModeFlagBits::eNone,
+                .frontFace = vk::FrontFace::eCounterClockwise,
+                .lineWidth = 1.0f,
+            })
+            .withMultisampling({
+                .rasterizationSamples = getMsaaSampleCount(),
+                .minSampleShading = 1.0f,
+            })
+            .withDepthStencil({
+                .depthTestEnable = vk::False,
+                .depthWriteEnable = vk::False,
+            })
+            .withDescriptorLayouts({
+                *sceneColorDescriptorSets[0]->getLayout(),
+            })
+            .withPushConstants({
+                vk::PushConstantRange{
+                    .stageFlags = vk::ShaderStageFlagBits::eFragment,
+                    .offset = 0,
+                    .size = sizeof(UpscalePushConstants),
+                }
+            })
+            .withColorFormats({swapChain->getImageFormat()});
+
+    auto pipeline = make_shared<Pipeline>(builder.create(ctx));
+
+    // with msaa, the gui pass loads the multisampled swap chain image, so the upscaled result has to go there too
+    for (auto &target: swapChain->getRenderTargets(ctx)) {
+        std::vector<RenderTarget> colorTargets;
+        colorTargets.emplace_back(std::move(target.colorTarget));
+
+        upscaleRenderInfos.emplace_back(
+            builder,
+            pipeline,
+            std::move(colorTargets)
         );
     }
 }
@@ -1470,15 +2886,24 @@ void VulkanRenderer::createDebugQuadRenderInfos() {
 void VulkanRenderer::reloadShaders() const {
     waitIdle();
 
-    sceneRenderInfos[0].reloadShaders(ctx);
+    sceneRenderInfo->reloadShaders(ctx);
     skyboxRenderInfos[0].reloadShaders(ctx);
     prepassRenderInfo->reloadShaders(ctx);
+    shadowRenderInfo->reloadShaders(ctx);
     ssaoRenderInfo->reloadShaders(ctx);
+    ssaoBlurRenderInfos[0].reloadShaders(ctx);
+    *gtaoPipeline = gtaoPipelineBuilder->create(ctx);
+    *depthPyramidPipeline = depthPyramidPipelineBuilder->create(ctx);
+    *cullingPipeline = cullingPipelineBuilder->create(ctx);
+    *skinningPipeline = skinningPipelineBuilder->create(ctx);
     cubemapCaptureRenderInfo->reloadShaders(ctx);
     irradianceCaptureRenderInfo->reloadShaders(ctx);
     prefilterRenderInfos[0].reloadShaders(ctx);
     brdfIntegrationRenderInfo->reloadShaders(ctx);
     debugQuadRenderInfos[0].reloadShaders(ctx);
+    taaRenderInfos[0].reloadShaders(ctx);
+    fxaaRenderInfo->reloadShaders(ctx);
+    upscaleRenderInfos[0].reloadShaders(ctx);
 }
 
 // ==================== multisampling ====================
@@ -1502,8 +2927,22 @@ vk::SampleCountFlagBits VulkanRenderer::getMaxUsableSampleCount() const {
 // ==================== buffers ====================
 
 void VulkanRenderer::createModelVertexBuffer() {
-    vertexBuffer = createLocalBuffer(model->getVertices(), vk::BufferUsageFlagBits::eVertexBuffer);
-    instanceDataBuffer = createLocalBuffer(model->getInstanceTransforms(), vk::BufferUsageFlagBits::eVertexBuffer);
+    // also read as the bind pose by the skinning pass
+    vertexBuffer = createLocalBuffer(
+        model->getVertices(),
+        vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+    );
+    createInstanceBuffer(model->getInstances());
+}
+
+void VulkanRenderer::createInstanceBuffer(const std::vector<ModelInstance> &instances) {
+    instanceData = instances;
+    dirtyInstanceRanges.clear();
+
+    instanceDataBuffer = createLocalBuffer(
+        instanceData,
+        vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+    );
 }
 
 void VulkanRenderer::createSkyboxVertexBuffer() {
@@ -1555,17 +2994,197 @@ void VulkanRenderer::createUniformBuffers() {
             **ctx.allocator,
             sizeof(GraphicsUBO),
             vk::BufferUsageFlagBits::eUniformBuffer,
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            ctx.concurrentQueueFamilies
         );
 
         res.graphicsUboMapped = res.graphicsUniformBuffer->map();
     }
 }
 
-// ==================== commands ====================
+void VulkanRenderer::createLightBuffers() {
+    for (auto &res: frameResources) {
+        res.lightBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            sizeof(LightBufferHeader) + LightClusterGrid::MAX_LIGHTS * sizeof(LightData),
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
 
-void VulkanRenderer::createCommandPool() {
-    const QueueFamilyIndices queueFamilyIndices = findQueueFamilies(*ctx.physicalDevice);
+        res.lightClusterBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            LightClusterGrid::CLUSTER_COUNT * sizeof(glm::uvec2),
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        res.lightIndexBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            LightClusterGrid::MAX_LIGHT_INDICES * sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        res.lightBufferMapped = res.lightBuffer->map();
+        res.lightClusterBufferMapped = res.lightClusterBuffer->map();
+        res.lightIndexBufferMapped = res.lightIndexBuffer->map();
+    }
+}
+
+void VulkanRenderer::createInstanceStagingBuffers() {
+    for (auto &res: frameResources) {
+        res.instanceStagingBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            INSTANCE_STAGING_BUFFER_SIZE,
+            vk::BufferUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        res.instanceStagingBufferMapped = res.instanceStagingBuffer->map();
+    }
+}
+
+void VulkanRenderer::createCullingBuffers() {
+    std::vector<CullInstanceData> cullInstances;
+    std::vector<vk::DrawIndexedIndirectCommand> drawCommands;
+
+    uint32_t indexOffset = 0;
+    std::int32_t vertexOffset = 0;
+    uint32_t instanceOffset = 0;
+
+    const auto &meshes = model->getMeshes();
+
+    for (uint32_t meshIdx = 0; meshIdx < meshes.size(); meshIdx++) {
+        const auto &mesh = meshes[meshIdx];
+
+        // visible instances of a mesh are compacted into the same range its instances occupy in the instance buffer
+        drawCommands.push_back(vk::DrawIndexedIndirectCommand{
+            .indexCount = static_cast<uint32_t>(mesh.indices.size()),
+            .instanceCount = 0,
+            .firstIndex = indexOffset,
+            .vertexOffset = vertexOffset,
+            .firstInstance = instanceOffset,
+        });
+
+        // animated vertices can leave their bind pose bounds, so skinned meshes are never culled
+        const glm::vec4 boundingSphere = mesh.isSkinned()
+                                             ? glm::vec4(0.0f, 0.0f, 0.0f, 1e30f)
+                                             : mesh.boundingSphere;
+
+        for (size_t i = 0; i < mesh.instances.size(); i++) {
+            cullInstances.push_back(CullInstanceData{
+                .boundingSphere = boundingSphere,
+                .meshIndex = meshIdx,
+            });
+        }
+
+        indexOffset += static_cast<uint32_t>(mesh.indices.size());
+        vertexOffset += static_cast<std::int32_t>(mesh.vertices.size());
+        instanceOffset += static_cast<uint32_t>(mesh.instances.size());
+    }
+
+    cullInstanceBuffer = createLocalBuffer(cullInstances, vk::BufferUsageFlagBits::eStorageBuffer);
+    drawCommandTemplateBuffer = createLocalBuffer(drawCommands, vk::BufferUsageFlagBits::eTransferSrc);
+
+    const vk::DeviceSize cullInstancesSize = sizeof(CullInstanceData) * cullInstances.size();
+    const vk::DeviceSize drawCommandsSize = sizeof(vk::DrawIndexedIndirectCommand) * drawCommands.size();
+    const vk::DeviceSize instancesSize = sizeof(ModelInstance) * cullInstances.size();
+
+    for (auto &res: frameResources) {
+        res.drawCommandBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            drawCommandsSize,
+            vk::BufferUsageFlagBits::eIndirectBuffer
+            | vk::BufferUsageFlagBits::eStorageBuffer
+            | vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eDeviceLocal
+        );
+
+        res.visibleInstanceBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            instancesSize,
+            vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal
+        );
+
+        res.cullStatsBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            sizeof(CullStats),
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        res.cullStatsBufferMapped = res.cullStatsBuffer->map();
+        res.hasCullStats = false;
+
+        res.cullingDescriptorSet->queueUpdate(2, *cullInstanceBuffer, vk::DescriptorType::eStorageBuffer,
+                                              cullInstancesSize)
+                .queueUpdate(3, *instanceDataBuffer, vk::DescriptorType::eStorageBuffer, instancesSize)
+                .queueUpdate(4, *res.drawCommandBuffer, vk::DescriptorType::eStorageBuffer, drawCommandsSize)
+                .queueUpdate(5, *res.visibleInstanceBuffer, vk::DescriptorType::eStorageBuffer, instancesSize)
+                .queueUpdate(6, *res.cullStatsBuffer, vk::DescriptorType::eStorageBuffer, sizeof(CullStats))
+                .commitUpdates(ctx);
+    }
+
+    cullingStats = {};
+    cullingStats.instanceCount = static_cast<uint32_t>(cullInstances.size());
+}
+
+void VulkanRenderer::createSkinningBuffers() {
+    vertexSkinBuffer.reset();
+    skinnedVertexCount = 0;
+
+    for (auto &res: frameResources) {
+        res.skinnedVertexBuffer.reset();
+        res.boneBuffer.reset();
+        res.boneBufferMapped = nullptr;
+    }
+
+    animationState.animationIdx = 0;
+    animationState.time = 0.0f;
+
+    if (!model->isSkinned()) {
+        return;
+    }
+
+    const auto vertices = model->getVertices();
+    const auto vertexSkins = model->getVertexSkins();
+
+    vertexSkinBuffer = createLocalBuffer(vertexSkins, vk::BufferUsageFlagBits::eStorageBuffer);
+    skinnedVertexCount = static_cast<uint32_t>(vertexSkins.size());
+
+    const vk::DeviceSize verticesSize = sizeof(ModelVertex) * vertices.size();
+    const vk::DeviceSize vertexSkinsSize = sizeof(VertexSkin) * vertexSkins.size();
+    const vk::DeviceSize bonesSize = sizeof(glm::mat4) * model->getBones().size();
+
+    for (auto &res: frameResources) {
+        // unskinned vertices are never written by the skinning pass, so they're only uploaded here
+        res.skinnedVertexBuffer = createLocalBuffer(
+            vertices,
+            vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+        );
+
+        res.boneBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            bonesSize,
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        res.boneBufferMapped = res.boneBuffer->map();
+
+        res.skinningDescriptorSet->queueUpdate(0, *vertexBuffer, vk::DescriptorType::eStorageBuffer, verticesSize)
+                .queueUpdate(1, *vertexSkinBuffer, vk::DescriptorType::eStorageBuffer, vertexSkinsSize)
+                .queueUpdate(2, *res.boneBuffer, vk::DescriptorType::eStorageBuffer, bonesSize)
+                .queueUpdate(3, *res.skinnedVertexBuffer, vk::DescriptorType::eStorageBuffer, verticesSize)
+                .commitUpdates(ctx);
+    }
+}
+
+// ==================== commands ====================
+
+void VulkanRenderer::createCommandPool() {
+    const QueueFamilyIndices queueFamilyIndices = findQueueFamilies(*ctx.physicalDevice);
 
     const vk::CommandPoolCreateInfo poolInfo{
         .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
@@ -1573,6 +3192,15 @@ void VulkanRenderer::createCommandPool() {
     };
 
     ctx.commandPool = make_unique<vk::raii::CommandPool>(*ctx.device, poolInfo);
+
+    if (queueFamilyIndices.asyncComputeFamily.has_value()) {
+        const vk::CommandPoolCreateInfo asyncComputePoolInfo{
+            .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+            .queueFamilyIndex = *queueFamilyIndices.asyncComputeFamily
+        };
+
+        asyncComputeCommandPool = make_unique<vk::raii::CommandPool>(*ctx.device, asyncComputePoolInfo);
+    }
 }
 
 void VulkanRenderer::createCommandBuffers() {
@@ -1589,70 +3217,288 @@ void VulkanRenderer::createCommandBuffers() {
     };
 
     vk::raii::CommandBuffers graphicsCommandBuffers{*ctx.device, primaryAllocInfo};
+    vk::raii::CommandBuffers prepassGraphicsCommandBuffers{*ctx.device, primaryAllocInfo};
+    vk::raii::CommandBuffers overlappedGraphicsCommandBuffers{*ctx.device, primaryAllocInfo};
 
     vk::raii::CommandBuffers sceneCommandBuffers{*ctx.device, secondaryAllocInfo};
     vk::raii::CommandBuffers guiCommandBuffers{*ctx.device, secondaryAllocInfo};
     vk::raii::CommandBuffers prepassCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers shadowCommandBuffers{*ctx.device, secondaryAllocInfo};
     vk::raii::CommandBuffers debugCommandBuffers{*ctx.device, secondaryAllocInfo};
     vk::raii::CommandBuffers ssaoCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers ssaoHorizontalBlurCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers ssaoVerticalBlurCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers gtaoCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers cullingCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers skinningCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers taaCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers fxaaCommandBuffers{*ctx.device, secondaryAllocInfo};
+    vk::raii::CommandBuffers upscaleCommandBuffers{*ctx.device, secondaryAllocInfo};
 
     for (size_t i = 0; i < graphicsCommandBuffers.size(); i++) {
         frameResources[i].graphicsCmdBuffer =
                 make_unique<vk::raii::CommandBuffer>(std::move(graphicsCommandBuffers[i]));
+        frameResources[i].prepassGraphicsCmdBuffer =
+                make_unique<vk::raii::CommandBuffer>(std::move(prepassGraphicsCommandBuffers[i]));
+        frameResources[i].overlappedGraphicsCmdBuffer =
+                make_unique<vk::raii::CommandBuffer>(std::move(overlappedGraphicsCommandBuffers[i]));
         frameResources[i].sceneCmdBuffer =
                 {make_unique<vk::raii::CommandBuffer>(std::move(sceneCommandBuffers[i]))};
         frameResources[i].guiCmdBuffer =
                 {make_unique<vk::raii::CommandBuffer>(std::move(guiCommandBuffers[i]))};
         frameResources[i].prepassCmdBuffer =
                 {make_unique<vk::raii::CommandBuffer>(std::move(prepassCommandBuffers[i]))};
+        frameResources[i].shadowCmdBuffer =
+                {make_unique<vk::raii::CommandBuffer>(std::move(shadowCommandBuffers[i]))};
         frameResources[i].debugCmdBuffer =
                 {make_unique<vk::raii::CommandBuffer>(std::move(debugCommandBuffers[i]))};
         frameResources[i].ssaoCmdBuffer =
                 {make_unique<vk::raii::CommandBuffer>(std::move(ssaoCommandBuffers[i]))};
+        frameResources[i].ssaoBlurCmdBuffers[0] =
+                {make_unique<vk::raii::CommandBuffer>(std::move(ssaoHorizontalBlurCommandBuffers[i]))};
+        frameResources[i].ssaoBlurCmdBuffers[1] =
+                {make_unique<vk::raii::CommandBuffer>(std::move(ssaoVerticalBlurCommandBuffers[i]))};
+        frameResources[i].gtaoCmdBuffer =
+                {make_unique<vk::raii::CommandBuffer>(std::move(gtaoCommandBuffers[i]))};
+        frameResources[i].cullingCmdBuffer =
+                {make_unique<vk::raii::CommandBuffer>(std::move(cullingCommandBuffers[i]))};
+        frameResources[i].skinningCmdBuffer =
+                {make_unique<vk::raii::CommandBuffer>(std::move(skinningCommandBuffers[i]))};
+        frameResources[i].taaCmdBuffer =
+                {make_unique<vk::raii::CommandBuffer>(std::move(taaCommandBuffers[i]))};
+        frameResources[i].fxaaCmdBuffer =
+                {make_unique<vk::raii::CommandBuffer>(std::move(fxaaCommandBuffers[i]))};
+        frameResources[i].upscaleCmdBuffer =
+                {make_unique<vk::raii::CommandBuffer>(std::move(upscaleCommandBuffers[i]))};
+    }
+
+    if (!asyncComputeCommandPool) {
+        return;
+    }
+
+    const vk::CommandBufferAllocateInfo asyncComputeAllocInfo{
+        .commandPool = **asyncComputeCommandPool,
+        .level = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = static_cast<uint32_t>(frameResources.size()),
+    };
+
+    vk::raii::CommandBuffers asyncComputeCommandBuffers{*ctx.device, asyncComputeAllocInfo};
+
+    for (size_t i = 0; i < asyncComputeCommandBuffers.size(); i++) {
+        frameResources[i].asyncComputeCmdBuffer =
+                make_unique<vk::raii::CommandBuffer>(std::move(asyncComputeCommandBuffers[i]));
     }
 }
 
 void VulkanRenderer::recordGraphicsCommandBuffer() {
-    const auto &commandBuffer = *frameResources[currentFrameIdx].graphicsCmdBuffer;
-
-    constexpr auto renderingFlags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+    const auto &res = frameResources[currentFrameIdx];
+    const auto &commandBuffer = *res.graphicsCmdBuffer;
 
     constexpr vk::CommandBufferBeginInfo beginInfo;
-    commandBuffer.begin(beginInfo);
 
-    swapChain->transitionToAttachmentLayout(commandBuffer);
+    const auto &timestampQueryPool = res.timestampQueryPool;
 
-    // prepass
+    const auto writeStartTimestamp = [&](const vk::raii::CommandBuffer &cmdBuffer) {
+        if (timestampQueryPool) {
+            cmdBuffer.resetQueryPool(**timestampQueryPool, 0, 2);
+            cmdBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, **timestampQueryPool, 0);
+        }
+    };
 
-    if (frameResources[currentFrameIdx].prepassCmdBuffer.wasRecordedThisFrame) {
-        commandBuffer.beginRendering(prepassRenderInfo->get(swapChain->getExtent(), 1, renderingFlags));
-        commandBuffer.executeCommands(**frameResources[currentFrameIdx].prepassCmdBuffer);
-        commandBuffer.endRendering();
+    if (res.hasAsyncComputeWork) {
+        // the async compute work only depends on the prepass, so it goes first and is submitted on its own
+        const auto &prepassCommandBuffer = *res.prepassGraphicsCmdBuffer;
+        prepassCommandBuffer.begin(beginInfo);
+        writeStartTimestamp(prepassCommandBuffer);
+
+        recordInstanceUploads(prepassCommandBuffer);
+
+        if (res.skinningCmdBuffer.wasRecordedThisFrame) {
+            prepassCommandBuffer.executeCommands(**res.skinningCmdBuffer);
+        }
+
+        recordPrepassCommands(prepassCommandBuffer);
+
+        ssaoTexture->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eGeneral,
+            prepassCommandBuffer
+        );
+
+        prepassCommandBuffer.end();
+
+        // work which doesn't need the async compute results, executed while it's still running
+        const auto &overlappedCommandBuffer = *res.overlappedGraphicsCmdBuffer;
+        overlappedCommandBuffer.begin(beginInfo);
+
+        recordShadowPassCommands(overlappedCommandBuffer);
+
+        if (res.cullingCmdBuffer.wasRecordedThisFrame) {
+            overlappedCommandBuffer.executeCommands(**res.cullingCmdBuffer);
+        }
+
+        overlappedCommandBuffer.end();
+
+        // the rest of the frame, submitted with a wait on the async compute work
+        commandBuffer.begin(beginInfo);
+
+        swapChain->transitionToAttachmentLayout(commandBuffer);
+
+        ssaoTexture->getImage().transitionLayout(
+            vk::ImageLayout::eGeneral,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+
+        recordAmbientOcclusionCommands(commandBuffer);
+    } else {
+        commandBuffer.begin(beginInfo);
+        writeStartTimestamp(commandBuffer);
+
+        recordInstanceUploads(commandBuffer);
+
+        if (res.skinningCmdBuffer.wasRecordedThisFrame) {
+            commandBuffer.executeCommands(**res.skinningCmdBuffer);
+        }
+
+        swapChain->transitionToAttachmentLayout(commandBuffer);
+
+        recordShadowPassCommands(commandBuffer);
+        recordPrepassCommands(commandBuffer);
+        recordAmbientOcclusionCommands(commandBuffer);
+
+        // culling pass, reduces the prepass depth into a pyramid and writes the main pass' draw commands
+
+        if (res.cullingCmdBuffer.wasRecordedThisFrame) {
+            commandBuffer.executeCommands(**res.cullingCmdBuffer);
+        }
     }
 
-    // ssao pass
+    constexpr auto renderingFlags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
 
-    if (frameResources[currentFrameIdx].ssaoCmdBuffer.wasRecordedThisFrame) {
-        commandBuffer.beginRendering(ssaoRenderInfo->get(swapChain->getExtent(), 1, renderingFlags));
-        commandBuffer.executeCommands(**frameResources[currentFrameIdx].ssaoCmdBuffer);
-        commandBuffer.endRendering();
+    const bool isMsaa = getMsaaSampleCount() != vk::SampleCountFlagBits::e1;
+
+    // the main pass loads the prepass depth. without msaa it lives in the g-buffer
+    // and has to be moved back into an attachment layout, otherwise it's the swap chain's multisampled depth.
+
+    const bool usesSceneDepth = frameResources[currentFrameIdx].sceneCmdBuffer.wasRecordedThisFrame;
+
+    if (usesSceneDepth) {
+        if (isMsaa) {
+            constexpr vk::MemoryBarrier depthBarrier{
+                .srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                .dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead
+                                 | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+            };
+
+            commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                {},
+                depthBarrier,
+                nullptr,
+                nullptr
+            );
+        } else {
+            gBufferTextures.depth->getImage().transitionLayout(
+                vk::ImageLayout::eShaderReadOnlyOptimal,
+                vk::ImageLayout::eDepthStencilAttachmentOptimal,
+                commandBuffer
+            );
+        }
+    }
+
+    if (usesSceneDepth) {
+        sceneColorTexture->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
     }
 
     // main pass
 
     if (frameResources[currentFrameIdx].sceneCmdBuffer.wasRecordedThisFrame) {
-        const auto &renderInfo = sceneRenderInfos[swapChain->getCurrentImageIndex()];
-        commandBuffer.beginRendering(renderInfo.get(swapChain->getExtent(), 1, renderingFlags));
+        commandBuffer.beginRendering(sceneRenderInfo->get(renderExtent, 1, renderingFlags));
         commandBuffer.executeCommands(**frameResources[currentFrameIdx].sceneCmdBuffer);
         commandBuffer.endRendering();
     }
 
-    // debug quad pass
+    if (usesSceneDepth) {
+        sceneColorTexture->getImage().transitionLayout(
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+
+    if (usesSceneDepth && !isMsaa) {
+        gBufferTextures.depth->getImage().transitionLayout(
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+
+    // taa resolve pass
+
+    if (frameResources[currentFrameIdx].taaCmdBuffer.wasRecordedThisFrame) {
+        const Image &outputImage = taaHistoryTextures[taaState.outputIdx]->getImage();
+
+        outputImage.transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        commandBuffer.beginRendering(taaRenderInfos[taaState.outputIdx].get(renderExtent, 1, renderingFlags));
+        commandBuffer.executeCommands(**frameResources[currentFrameIdx].taaCmdBuffer);
+        commandBuffer.endRendering();
+
+        outputImage.transitionLayout(
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+
+    // fxaa pass
+
+    if (frameResources[currentFrameIdx].fxaaCmdBuffer.wasRecordedThisFrame) {
+        fxaaOutputTexture->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        commandBuffer.beginRendering(fxaaRenderInfo->get(renderExtent, 1, renderingFlags));
+        commandBuffer.executeCommands(**frameResources[currentFrameIdx].fxaaCmdBuffer);
+        commandBuffer.endRendering();
+
+        fxaaOutputTexture->getImage().transitionLayout(
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+
+    // upscale pass, from the internal resolution to the swap chain's one. the debug quad
+    // is drawn on top of the tonemapped result, so it shares the render pass
+
+    std::vector<vk::CommandBuffer> upscalePassCmdBuffers;
+
+    if (frameResources[currentFrameIdx].upscaleCmdBuffer.wasRecordedThisFrame) {
+        upscalePassCmdBuffers.push_back(**frameResources[currentFrameIdx].upscaleCmdBuffer);
+    }
 
     if (frameResources[currentFrameIdx].debugCmdBuffer.wasRecordedThisFrame) {
-        const auto &renderInfo = sceneRenderInfos[swapChain->getCurrentImageIndex()];
+        upscalePassCmdBuffers.push_back(**frameResources[currentFrameIdx].debugCmdBuffer);
+    }
+
+    if (!upscalePassCmdBuffers.empty()) {
+        const auto &renderInfo = upscaleRenderInfos[swapChain->getCurrentImageIndex()];
         commandBuffer.beginRendering(renderInfo.get(swapChain->getExtent(), 1, renderingFlags));
-        commandBuffer.executeCommands(**frameResources[currentFrameIdx].debugCmdBuffer);
+        commandBuffer.executeCommands(upscalePassCmdBuffers);
         commandBuffer.endRendering();
     }
 
@@ -1665,182 +3511,1831 @@ void VulkanRenderer::recordGraphicsCommandBuffer() {
         commandBuffer.endRendering();
     }
 
+    if (frameResources[currentFrameIdx].captureCallback) {
+        recordFrameCapture(commandBuffer);
+    }
+
     swapChain->transitionToPresentLayout(commandBuffer);
 
+    if (timestampQueryPool) {
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, **timestampQueryPool, 1);
+        frameResources[currentFrameIdx].hasTimestamps = true;
+    }
+
     commandBuffer.end();
 }
 
-// ==================== sync ====================
+void VulkanRenderer::recordFrameCapture(const vk::raii::CommandBuffer &commandBuffer) const {
+    const auto &res = frameResources[currentFrameIdx];
 
-void VulkanRenderer::createSyncObjects() {
-    const vk::StructureChain<vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo> timelineSemaphoreInfo{
-        {},
-        {
-            .semaphoreType = vk::SemaphoreType::eTimeline,
-            .initialValue = 0,
-        }
+    const vk::ImageSubresourceRange range{
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
     };
 
-    constexpr vk::SemaphoreCreateInfo binarySemaphoreInfo;
+    const vk::ImageMemoryBarrier toTransferBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+        .dstAccessMask = vk::AccessFlagBits::eTransferRead,
+        .oldLayout = vk::ImageLayout::eColorAttachmentOptimal,
+        .newLayout = vk::ImageLayout::eTransferSrcOptimal,
+        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .image = swapChain->getCurrentImage(),
+        .subresourceRange = range,
+    };
 
-    for (auto &res: frameResources) {
-        res.sync = {
-            .imageAvailableSemaphore = make_unique<vk::raii::Semaphore>(*ctx.device, binarySemaphoreInfo),
-            .readyToPresentSemaphore = make_unique<vk::raii::Semaphore>(*ctx.device, binarySemaphoreInfo),
-            .renderFinishedTimeline = {
-                make_unique<vk::raii::Semaphore>(*ctx.device, timelineSemaphoreInfo.get<vk::SemaphoreCreateInfo>())
-            },
-        };
-    }
-}
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::PipelineStageFlagBits::eTransfer,
+        {},
+        nullptr,
+        nullptr,
+        toTransferBarrier
+    );
 
-// ==================== gui ====================
+    const vk::BufferImageCopy region{
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {res.captureBufferExtent.width, res.captureBufferExtent.height, 1},
+    };
 
-void VulkanRenderer::initImgui() {
-    const std::vector<vk::DescriptorPoolSize> poolSizes = {
-        {vk::DescriptorType::eSampler, 1000},
-        {vk::DescriptorType::eCombinedImageSampler, 1000},
-        {vk::DescriptorType::eSampledImage, 1000},
-        {vk::DescriptorType::eStorageImage, 1000},
-        {vk::DescriptorType::eUniformTexelBuffer, 1000},
-        {vk::DescriptorType::eStorageTexelBuffer, 1000},
-        {vk::DescriptorType::eUniformBuffer, 1000},
-        {vk::DescriptorType::eStorageBuffer, 1000},
-        {vk::DescriptorType::eUniformBufferDynamic, 1000},
-        {vk::DescriptorType::eStorageBufferDynamic, 1000},
-        {vk::DescriptorType::eInputAttachment, 1000}
+    commandBuffer.copyImageToBuffer(
+        swapChain->getCurrentImage(),
+        vk::ImageLayout::eTransferSrcOptimal,
+        **res.captureBuffer,
+        region
+    );
+
+    // back to where the present transition expects the image to be
+    const vk::ImageMemoryBarrier toAttachmentBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eTransferRead,
+        .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+        .oldLayout = vk::ImageLayout::eTransferSrcOptimal,
+        .newLayout = vk::ImageLayout::eColorAttachmentOptimal,
+        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .image = swapChain->getCurrentImage(),
+        .subresourceRange = range,
     };
 
-    const vk::DescriptorPoolCreateInfo poolInfo = {
-        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
-        .maxSets = 1000,
-        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
-        .pPoolSizes = poolSizes.data(),
+    const vk::BufferMemoryBarrier hostReadBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eHostRead,
+        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .buffer = **res.captureBuffer,
+        .offset = 0,
+        .size = vk::WholeSize,
     };
 
-    imguiDescriptorPool = make_unique<vk::raii::DescriptorPool>(*ctx.device, poolInfo);
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eHost,
+        {},
+        nullptr,
+        hostReadBarrier,
+        toAttachmentBarrier
+    );
+}
 
-    const uint32_t imageCount = SwapChain::getImageCount(ctx, *surface);
+void VulkanRenderer::recordInstanceUploads(const vk::raii::CommandBuffer &commandBuffer) {
+    auto &res = frameResources[currentFrameIdx];
+    res.hasInstanceUploads = false;
 
-    ImGui_ImplVulkan_InitInfo imguiInitInfo = {
-        .Instance = **instance,
-        .PhysicalDevice = **ctx.physicalDevice,
-        .Device = **ctx.device,
-        .Queue = **ctx.graphicsQueue,
-        .DescriptorPool = static_cast<VkDescriptorPool>(**imguiDescriptorPool),
-        .MinImageCount = imageCount,
-        .ImageCount = imageCount,
-        .MSAASamples = static_cast<VkSampleCountFlagBits>(getMsaaSampleCount()),
-        .UseDynamicRendering = true,
-        .ColorAttachmentFormat = static_cast<VkFormat>(swapChain->getImageFormat()),
-    };
+    if (dirtyInstanceRanges.empty()) {
+        return;
+    }
 
-    guiRenderer = make_unique<GuiRenderer>(window, imguiInitInfo);
-}
+    std::ranges::sort(dirtyInstanceRanges);
 
-void VulkanRenderer::renderGuiSection() {
-    constexpr auto sectionFlags = ImGuiTreeNodeFlags_DefaultOpen;
+    std::vector<std::pair<uint32_t, uint32_t> > mergedRanges;
 
-    if (ImGui::CollapsingHeader("Model ", sectionFlags)) {
-        if (ImGui::Button("Load model...")) {
-            ImGui::OpenPopup("Load model");
+    for (const auto &range: dirtyInstanceRanges) {
+        if (!mergedRanges.empty() && range.first <= mergedRanges.back().second) {
+            mergedRanges.back().second = std::max(mergedRanges.back().second, range.second);
+        } else {
+            mergedRanges.push_back(range);
         }
+    }
 
-        ImGui::Separator();
+    dirtyInstanceRanges.clear();
 
-        ImGui::DragFloat("Model scale", &modelScale, 0.01, 0, std::numeric_limits<float>::max());
+    static constexpr auto maxStagedInstances = static_cast<uint32_t>(
+        INSTANCE_STAGING_BUFFER_SIZE / sizeof(ModelInstance)
+    );
 
-        ImGui::gizmo3D("Model rotation", modelRotation, 160);
+    auto *stagedInstances = static_cast<ModelInstance *>(res.instanceStagingBufferMapped);
+    uint32_t stagedCount = 0;
+    std::vector<vk::BufferCopy> copyRegions;
 
-        if (ImGui::Button("Reset scale")) { modelScale = 1; }
-        ImGui::SameLine();
-        if (ImGui::Button("Reset rotation")) { modelRotation = {1, 0, 0, 0}; }
-        ImGui::SameLine();
-        if (ImGui::Button("Reset position")) { modelTranslate = {0, 0, 0}; }
-    }
+    for (const auto &[first, end]: mergedRanges) {
+        const uint32_t count = std::min(end - first, maxStagedInstances - stagedCount);
 
-    if (ImGui::CollapsingHeader("Renderer ", sectionFlags)) {
-        // todo - convert these 2 to dynamic states
-        if (ImGui::Checkbox("Cull backfaces", &cullBackFaces)) {
+        if (count > 0) {
+            memcpy(stagedInstances + stagedCount, &instanceData[first], count * sizeof(ModelInstance));
+
+            copyRegions.push_back(vk::BufferCopy{
+                .srcOffset = stagedCount * sizeof(ModelInstance),
+                .dstOffset = first * sizeof(ModelInstance),
+                .size = count * sizeof(ModelInstance),
+            });
+
+            stagedCount += count;
+        }
+
+        if (first + count < end) {
+            dirtyInstanceRanges.emplace_back(first + count, end);
+        }
+    }
+
+    // the shadow pass has already been recorded by now, so it has to catch up on whatever's left next frame
+    if (!dirtyInstanceRanges.empty()) {
+        shadowMapState.isValid = false;
+    }
+
+    // previous frames might still be reading the instances about to be overwritten
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eTransfer,
+        {},
+        nullptr,
+        nullptr,
+        nullptr
+    );
+
+    commandBuffer.copyBuffer(**res.instanceStagingBuffer, **instanceDataBuffer, copyRegions);
+
+    const vk::MemoryBarrier uploadBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eShaderRead,
+    };
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        uploadBarrier,
+        nullptr,
+        nullptr
+    );
+
+    res.hasInstanceUploads = true;
+}
+
+void VulkanRenderer::recordShadowPassCommands(const vk::raii::CommandBuffer &commandBuffer) const {
+    constexpr auto renderingFlags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+
+    // shadow pass, only recorded on frames where the cached shadow map went stale
+
+    if (frameResources[currentFrameIdx].shadowCmdBuffer.wasRecordedThisFrame) {
+        shadowMapTexture->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            commandBuffer
+        );
+
+        const vk::Extent2D shadowMapExtent = shadowMapTexture->getImage().getExtent2d();
+        commandBuffer.beginRendering(shadowRenderInfo->get(shadowMapExtent, 1, renderingFlags));
+        commandBuffer.executeCommands(**frameResources[currentFrameIdx].shadowCmdBuffer);
+        commandBuffer.endRendering();
+
+        shadowMapTexture->getImage().transitionLayout(
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+}
+
+void VulkanRenderer::recordPrepassCommands(const vk::raii::CommandBuffer &commandBuffer) const {
+    constexpr auto renderingFlags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+
+    const bool isMsaa = getMsaaSampleCount() != vk::SampleCountFlagBits::e1;
+
+    if (isMsaa) {
+        // multisampled attachments are cleared by the prepass, so their previous contents can be discarded
+        gBufferTextures.multisampledNormal->transitionLayout(
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        gBufferTextures.multisampledVelocity->transitionLayout(
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        multisampledSceneColor->transitionLayout(
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        swapChain->getDepthImage().transitionLayout(
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            commandBuffer
+        );
+    }
+
+    if (frameResources[currentFrameIdx].prepassCmdBuffer.wasRecordedThisFrame) {
+        gBufferTextures.normal->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        gBufferTextures.velocity->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        gBufferTextures.depth->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            commandBuffer
+        );
+
+        commandBuffer.beginRendering(prepassRenderInfo->get(renderExtent, 1, renderingFlags));
+        commandBuffer.executeCommands(**frameResources[currentFrameIdx].prepassCmdBuffer);
+        commandBuffer.endRendering();
+
+        // the ssao and taa passes read these, so they have to be visible to fragment shaders afterwards
+        gBufferTextures.normal->getImage().transitionLayout(
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+
+        gBufferTextures.velocity->getImage().transitionLayout(
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+
+        gBufferTextures.depth->getImage().transitionLayout(
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+}
+
+void VulkanRenderer::recordAmbientOcclusionCommands(const vk::raii::CommandBuffer &commandBuffer) const {
+    constexpr auto renderingFlags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+
+    // ssao pass
+
+    if (frameResources[currentFrameIdx].ssaoCmdBuffer.wasRecordedThisFrame) {
+        ssaoTexture->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        commandBuffer.beginRendering(ssaoRenderInfo->get(renderExtent, 1, renderingFlags));
+        commandBuffer.executeCommands(**frameResources[currentFrameIdx].ssaoCmdBuffer);
+        commandBuffer.endRendering();
+
+        ssaoTexture->getImage().transitionLayout(
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+
+    // gtao pass, runs as a compute dispatch outside of any rendering scope
+
+    if (frameResources[currentFrameIdx].gtaoCmdBuffer.wasRecordedThisFrame) {
+        ssaoTexture->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eGeneral,
+            commandBuffer
+        );
+
+        commandBuffer.executeCommands(**frameResources[currentFrameIdx].gtaoCmdBuffer);
+
+        ssaoTexture->getImage().transitionLayout(
+            vk::ImageLayout::eGeneral,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+
+    // ssao blur passes
+
+    const std::array<const Texture *, 2> ssaoBlurOutputs = {&*ssaoBlurIntermediateTexture, &*ssaoBlurredTexture};
+
+    for (size_t i = 0; i < ssaoBlurOutputs.size(); i++) {
+        if (!frameResources[currentFrameIdx].ssaoBlurCmdBuffers[i].wasRecordedThisFrame) {
+            continue;
+        }
+
+        ssaoBlurOutputs[i]->getImage().transitionLayout(
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::ImageLayout::eColorAttachmentOptimal,
+            commandBuffer
+        );
+
+        commandBuffer.beginRendering(ssaoBlurRenderInfos[i].get(renderExtent, 1, renderingFlags));
+        commandBuffer.executeCommands(**frameResources[currentFrameIdx].ssaoBlurCmdBuffers[i]);
+        commandBuffer.endRendering();
+
+        ssaoBlurOutputs[i]->getImage().transitionLayout(
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            commandBuffer
+        );
+    }
+}
+
+// ==================== sync ====================
+
+void VulkanRenderer::createSyncObjects() {
+    const vk::StructureChain<vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo> timelineSemaphoreInfo{
+        {},
+        {
+            .semaphoreType = vk::SemaphoreType::eTimeline,
+            .initialValue = 0,
+        }
+    };
+
+    constexpr vk::SemaphoreCreateInfo binarySemaphoreInfo;
+
+    for (auto &res: frameResources) {
+        res.sync = {
+            .imageAvailableSemaphore = make_unique<vk::raii::Semaphore>(*ctx.device, binarySemaphoreInfo),
+            .readyToPresentSemaphore = make_unique<vk::raii::Semaphore>(*ctx.device, binarySemaphoreInfo),
+            .renderFinishedTimeline = {
+                make_unique<vk::raii::Semaphore>(*ctx.device, timelineSemaphoreInfo.get<vk::SemaphoreCreateInfo>())
+            },
+            .prepassFinishedTimeline = {
+                make_unique<vk::raii::Semaphore>(*ctx.device, timelineSemaphoreInfo.get<vk::SemaphoreCreateInfo>())
+            },
+            .asyncComputeFinishedTimeline = {
+                make_unique<vk::raii::Semaphore>(*ctx.device, timelineSemaphoreInfo.get<vk::SemaphoreCreateInfo>())
+            },
+        };
+    }
+}
+
+void VulkanRenderer::createTimestampQueryPools() {
+    const vk::PhysicalDeviceLimits limits = ctx.physicalDevice->getProperties().limits;
+
+    if (!limits.timestampComputeAndGraphics) {
+        timestampPeriodNs = 0.0f;
+        return;
+    }
+
+    timestampPeriodNs = limits.timestampPeriod;
+
+    constexpr vk::QueryPoolCreateInfo queryPoolInfo{
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = 2,
+    };
+
+    for (auto &res: frameResources) {
+        res.timestampQueryPool = make_unique<vk::raii::QueryPool>(*ctx.device, queryPoolInfo);
+        res.hasTimestamps = false;
+    }
+}
+
+// ==================== gui ====================
+
+void VulkanRenderer::initImgui() {
+    const std::vector<vk::DescriptorPoolSize> poolSizes = {
+        {vk::DescriptorType::eSampler, 1000},
+        {vk::DescriptorType::eCombinedImageSampler, 1000},
+        {vk::DescriptorType::eSampledImage, 1000},
+        {vk::DescriptorType::eStorageImage, 1000},
+        {vk::DescriptorType::eUniformTexelBuffer, 1000},
+        {vk::DescriptorType::eStorageTexelBuffer, 1000},
+        {vk::DescriptorType::eUniformBuffer, 1000},
+        {vk::DescriptorType::eStorageBuffer, 1000},
+        {vk::DescriptorType::eUniformBufferDynamic, 1000},
+        {vk::DescriptorType::eStorageBufferDynamic, 1000},
+        {vk::DescriptorType::eInputAttachment, 1000}
+    };
+
+    const vk::DescriptorPoolCreateInfo poolInfo = {
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = 1000,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data(),
+    };
+
+    imguiDescriptorPool = make_unique<vk::raii::DescriptorPool>(*ctx.device, poolInfo);
+
+    const uint32_t imageCount = SwapChain::getImageCount(ctx, *surface);
+
+    ImGui_ImplVulkan_InitInfo imguiInitInfo = {
+        .Instance = **instance,
+        .PhysicalDevice = **ctx.physicalDevice,
+        .Device = **ctx.device,
+        .Queue = **ctx.graphicsQueue,
+        .DescriptorPool = static_cast<VkDescriptorPool>(**imguiDescriptorPool),
+        .MinImageCount = imageCount,
+        .ImageCount = imageCount,
+        .MSAASamples = static_cast<VkSampleCountFlagBits>(getMsaaSampleCount()),
+        .UseDynamicRendering = true,
+        .ColorAttachmentFormat = static_cast<VkFormat>(swapChain->getImageFormat()),
+    };
+
+    guiRenderer = make_unique<GuiRenderer>(window, imguiInitInfo);
+}
+
+void VulkanRenderer::renderGuiSection() {
+    constexpr auto sectionFlags = ImGuiTreeNodeFlags_DefaultOpen;
+
+    if (ImGui::CollapsingHeader("Model ", sectionFlags)) {
+        if (ImGui::Button("Load model...")) {
+            ImGui::OpenPopup("Load model");
+        }
+
+        ImGui::Separator();
+
+        ImGui::Checkbox("Pack textures on load", &usePackedMaterialTextures);
+
+        if (model && model->hasPackedMaterialTextures()) {
+            ImGui::Text("Material texture arrays: %zu", model->getTextureArrays().size());
+        }
+
+        ImGui::Separator();
+
+        static constexpr vk::DeviceSize mib = 1024 * 1024;
+
+        int modelCacheBudgetMib = static_cast<int>(modelCache.budget / mib);
+        ImGui::SliderInt("Model cache budget (MiB)", &modelCacheBudgetMib, 0, 8192);
+        modelCache.budget = static_cast<vk::DeviceSize>(modelCacheBudgetMib) * mib;
+
+        // evicted textures may still be referenced by unused slots of descriptor sets in flight
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            queuedFrameBeginActions.emplace([&] {
+                waitIdle();
+                evictModels();
+            });
+        }
+
+        vk::DeviceSize cachedModelsUsage = 0;
+        for (const auto &entry: modelCache.entries) {
+            cachedModelsUsage += entry.memoryUsage;
+        }
+
+        ImGui::Text(
+            "Current model: %.1f MiB, cached: %zu (%.1f MiB)",
+            static_cast<double>(getModelMemoryUsage()) / mib,
+            modelCache.entries.size(),
+            static_cast<double>(cachedModelsUsage) / mib
+        );
+
+        ImGui::Text("Cache hits: %u, misses: %u", modelCache.hitCount, modelCache.missCount);
+
+        if (ImGui::Button("Clear model cache")) {
+            queuedFrameBeginActions.emplace([&] { clearModelCache(); });
+        }
+
+        ImGui::Separator();
+
+        ImGui::BeginDisabled(!fileWatcher->isSupported());
+        ImGui::Checkbox("Hot reload", &hotReload.isEnabled);
+        ImGui::EndDisabled();
+
+        if (fileWatcher->isSupported()) {
+            ImGui::Text(
+                "Watched files: %zu, reloads: %u%s",
+                fileWatcher->getWatchedFileCount(),
+                hotReload.reloadCount,
+                hotReload.pendingImport.valid() ? " (importing...)" : ""
+            );
+        } else {
+            ImGui::Text("File changes can't be detected on this platform");
+        }
+
+        ImGui::Separator();
+
+        ImGui::DragFloat("Model scale", &modelScale, 0.01, 0, std::numeric_limits<float>::max());
+
+        if (model && ImGui::SliderFloat("Explode", &modelExplodeFactor, 0.0f, 2.0f, "%.2f")) {
+            updateInstances(0, model->getExplodedInstances(modelExplodeFactor));
+        }
+
+        if (model && model->isSkinned() && !model->getAnimations().empty()) {
+            const auto &animations = model->getAnimations();
+            auto &animation = animations[animationState.animationIdx];
+
+            if (ImGui::BeginCombo("Animation", animation.name.empty() ? "(unnamed)" : animation.name.c_str())) {
+                for (size_t i = 0; i < animations.size(); i++) {
+                    const char *name = animations[i].name.empty() ? "(unnamed)" : animations[i].name.c_str();
+                    const bool isSelected = static_cast<int>(i) == animationState.animationIdx;
+
+                    if (ImGui::Selectable(name, isSelected)) {
+                        animationState.animationIdx = static_cast<int>(i);
+                        animationState.time = 0.0f;
+                    }
+                }
+
+                ImGui::EndCombo();
+            }
+
+            ImGui::Checkbox("Play", &animationState.isPlaying);
+            ImGui::SameLine();
+            ImGui::SliderFloat("Speed", &animationState.speed, 0.0f, 4.0f, "%.2f");
+
+            // scrubbing a paused animation has to invalidate whatever was cached for the previous pose
+            if (ImGui::SliderFloat("Time", &animationState.time, 0.0f, animation.duration, "%.2f s")) {
+                shadowMapState.isValid = false;
+                requestRedraw();
+            }
+        }
+
+        if (model && ImGui::TreeNode("Scene graph")) {
+            renderSceneNodeTree(0);
+            ImGui::TreePop();
+        }
+
+        if (model && selectedSceneNode) {
+            const auto &node = model->getSceneNodes()[*selectedSceneNode];
+
+            glm::vec3 scale, translation, skew;
+            glm::quat rotation;
+            glm::vec4 perspective;
+            glm::decompose(node.localTransform, scale, rotation, translation, skew, perspective);
+
+            ImGui::Text("Selected node: %s", node.name.empty() ? "(unnamed)" : node.name.c_str());
+
+            bool isChanged = ImGui::DragFloat3("Node translation", &translation[0], 0.01f);
+            isChanged |= ImGui::DragFloat3("Node scale", &scale[0], 0.01f, 0.001f, std::numeric_limits<float>::max());
+            isChanged |= ImGui::gizmo3D("Node rotation", rotation, 120);
+
+            if (isChanged) {
+                setSceneNodeTransform(
+                    *selectedSceneNode,
+                    glm::translate(translation) * glm::mat4_cast(rotation) * glm::scale(scale)
+                );
+            }
+        }
+
+        ImGui::gizmo3D("Model rotation", modelRotation, 160);
+
+        if (ImGui::Button("Reset scale")) { modelScale = 1; }
+        ImGui::SameLine();
+        if (ImGui::Button("Reset rotation")) { modelRotation = {1, 0, 0, 0}; }
+        ImGui::SameLine();
+        if (ImGui::Button("Reset position")) { modelTranslate = {0, 0, 0}; }
+    }
+
+    if (ImGui::CollapsingHeader("Renderer ", sectionFlags)) {
+        // todo - convert these 2 to dynamic states
+        if (ImGui::Checkbox("Cull backfaces", &cullBackFaces)) {
             queuedFrameBeginActions.emplace([&] {
                 waitIdle();
-                sceneRenderInfos[0].reloadShaders(ctx);
+                // the prepass has to cull the same faces, otherwise its depth would hide what the scene pass draws
+                createPrepassRenderInfo();
+                createSceneRenderInfos();
             });
         }
 
-        if (ImGui::Checkbox("Wireframe mode", &wireframeMode)) {
-            queuedFrameBeginActions.emplace([&] {
-                waitIdle();
-                sceneRenderInfos[0].reloadShaders(ctx);
-            });
-        }
+        if (ImGui::Checkbox("Wireframe mode", &wireframeMode)) {
+            queuedFrameBeginActions.emplace([&] {
+                waitIdle();
+                sceneRenderInfo->reloadShaders(ctx);
+            });
+        }
+
+        ImGui::Checkbox("SSAO", &useSsao);
+
+        if (useSsao) {
+            static constexpr std::array aoTechniqueNames = {"SSAO", "GTAO"};
+
+            int techniqueIdx = static_cast<int>(aoTechnique);
+            if (ImGui::Combo("AO technique", &techniqueIdx, aoTechniqueNames.data(),
+                             static_cast<int>(aoTechniqueNames.size()))) {
+                aoTechnique = static_cast<AmbientOcclusionTechnique>(techniqueIdx);
+            }
+
+            if (aoTechnique == AmbientOcclusionTechnique::GTAO) {
+                ImGui::SliderFloat("GTAO radius", &gtaoState.radius, 0.05f, 2.0f, "%.2f");
+
+                // overlaps the dispatch with the shadow and culling passes, if the device has a queue for it
+                if (ctx.asyncComputeQueue) {
+                    ImGui::Checkbox("Async compute", &useAsyncCompute);
+                }
+            }
+        }
+
+        ImGui::Checkbox("IBL", &useIbl);
+        ImGui::Checkbox("Shadows", &useShadows);
+        ImGui::Checkbox("Occlusion culling", &useOcclusionCulling);
+
+        if (useOcclusionCulling && model) {
+            ImGui::Text("Occluded instances: %u / %u", cullingStats.occludedCount, cullingStats.instanceCount);
+            ImGui::Text("Outside frustum: %u", cullingStats.frustumCulledCount);
+        }
+
+        static bool useMsaaDummy = useMsaa;
+        if (ImGui::Checkbox("MSAA", &useMsaaDummy)) {
+            queuedFrameBeginActions.emplace([this] {
+                useMsaa = useMsaaDummy;
+
+                waitIdle();
+                recreateSwapChain();
+
+                createSceneRenderInfos();
+                createSkyboxRenderInfos();
+                createDebugQuadRenderInfos();
+
+                guiRenderer.reset();
+                initImgui();
+            });
+        }
+
+        if (ImGui::Checkbox("TAA", &useTaa)) {
+            taaState.isHistoryValid = false;
+        }
+
+        ImGui::SameLine();
+        ImGui::Checkbox("FXAA", &useFxaa);
+
+        if (useTaa) {
+            ImGui::Checkbox("Progressive accumulation", &progressiveState.isEnabled);
+
+            if (progressiveState.isEnabled) {
+                ImGui::Text("Accumulated frames: %u / %u", progressiveState.accumulatedFrames, PROGRESSIVE_MAX_FRAMES);
+            }
+        }
+
+        ImGui::Separator();
+
+        ImGui::Checkbox("Dynamic resolution", &dynamicResolution.isEnabled);
+
+        if (dynamicResolution.isEnabled) {
+            ImGui::SliderFloat("Target FPS", &dynamicResolution.targetFps, 15.0f, 240.0f, "%.0f");
+            ImGui::SliderFloat("Min render scale", &dynamicResolution.minScale, 0.25f, 1.0f, "%.2f");
+        } else {
+            ImGui::SliderFloat("Render scale", &dynamicResolution.scale, 0.25f, 1.0f, "%.2f");
+        }
+
+        ImGui::Text("Internal resolution: %ux%u", renderExtent.width, renderExtent.height);
+
+        if (timestampPeriodNs > 0.0f) {
+            ImGui::Text("GPU frame time: %.2f ms", dynamicResolution.smoothedGpuTimeMs);
+        }
+
+        ImGui::Separator();
+
+        static int framesInFlightDummy = static_cast<int>(framesInFlight);
+        if (ImGui::SliderInt("Frames in flight", &framesInFlightDummy, 1, static_cast<int>(MAX_FRAMES_IN_FLIGHT))) {
+            queuedFrameBeginActions.emplace([this] {
+                waitIdle();
+                framesInFlight = static_cast<uint32_t>(framesInFlightDummy);
+                currentFrameIdx = 0;
+            });
+        }
+
+        const vk::PresentModeKHR currentPresentMode = swapChain->getPresentMode();
+
+        if (ImGui::BeginCombo("Present mode", vk::to_string(currentPresentMode).c_str())) {
+            for (const auto &presentMode: swapChain->getAvailablePresentModes()) {
+                const bool isSelected = presentMode == currentPresentMode;
+
+                if (ImGui::Selectable(vk::to_string(presentMode).c_str(), isSelected) && !isSelected) {
+                    queuedFrameBeginActions.emplace([this, presentMode] {
+                        latencyState.presentMode = presentMode;
+                        recreateSwapChain();
+                    });
+                }
+
+                if (isSelected) {
+                    ImGui::SetItemDefaultFocus();
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        ImGui::Checkbox("Sample input before submit", &latencyState.sampleInputBeforeSubmit);
+
+        ImGui::Text("Input to submit: %.2f ms", latencyState.inputToSubmitMs);
+
+        if (latencyState.submitToPresentMs) {
+            ImGui::Text("Submit to present: %.2f ms", *latencyState.submitToPresentMs);
+        } else if (!isPresentWaitSupported) {
+            ImGui::Text("Submit to present: unsupported");
+        }
+
+        ImGui::Separator();
+
+        ImGui::Checkbox("Idle when static", &idleRendering.isEnabled);
+
+        if (idleRendering.isEnabled) {
+            ImGui::SliderInt("Frame cap", &idleRendering.frameCap, 0, 240,
+                             idleRendering.frameCap == 0 ? "Off" : "%d fps");
+        }
+
+#ifndef NDEBUG
+        ImGui::Separator();
+        ImGui::DragFloat("Debug number", &debugNumber, 0.01, 0, std::numeric_limits<float>::max());
+#endif
+    }
+
+    if (ImGui::CollapsingHeader("Lighting ", sectionFlags)) {
+        ImGui::SliderFloat("Light intensity", &lightIntensity, 0.0f, 100.0f, "%.2f");
+        ImGui::ColorEdit3("Light color", &lightColor.x);
+        ImGui::gizmo3D("Light direction", lightDirection, 160, imguiGizmo::modeDirection);
+
+        ImGui::Separator();
+
+        bool shouldRegenerate = false;
+        shouldRegenerate |= ImGui::SliderInt("Punctual lights", &lightRigSettings.lightCount, 0,
+                                             LightClusterGrid::MAX_LIGHTS);
+        shouldRegenerate |= ImGui::SliderFloat("Rig spread", &lightRigSettings.spread, 0.5f, 50.0f, "%.1f");
+        shouldRegenerate |= ImGui::SliderFloat("Light range", &lightRigSettings.range, 0.1f, 20.0f, "%.2f");
+        shouldRegenerate |= ImGui::SliderFloat("Punctual intensity", &lightRigSettings.intensity, 0.0f, 100.0f, "%.2f");
+        shouldRegenerate |= ImGui::SliderFloat("Spot light fraction", &lightRigSettings.spotFraction, 0.0f, 1.0f, "%.2f");
+
+        if (ImGui::Button("Reshuffle lights")) {
+            lightRigSettings.seed++;
+            shouldRegenerate = true;
+        }
+
+        if (shouldRegenerate) {
+            generateLightRig();
+        }
+
+        ImGui::Separator();
+
+        // switching to a cached environment only rebinds its descriptors, so they're listed for quick comparison
+        if (ImGui::BeginCombo("Environment", envmapPath ? envmapPath->filename().string().c_str() : "(none)")) {
+            for (const auto &entry: iblCache.entries) {
+                if (ImGui::Selectable(entry.path.filename().string().c_str(), false)) {
+                    queuedFrameBeginActions.emplace([&, path = entry.path] {
+                        loadEnvironmentMap(path);
+                    });
+                }
+            }
+
+            ImGui::EndCombo();
+        }
+
+        static constexpr vk::DeviceSize mib = 1024 * 1024;
+
+        int iblCacheBudgetMib = static_cast<int>(iblCache.budget / mib);
+        ImGui::SliderInt("IBL cache budget (MiB)", &iblCacheBudgetMib, 0, 8192);
+        iblCache.budget = static_cast<vk::DeviceSize>(iblCacheBudgetMib) * mib;
+
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            queuedFrameBeginActions.emplace([&] {
+                waitIdle();
+                evictIblSets();
+            });
+        }
+
+        ImGui::Text(
+            "Cached environments: %zu, hits: %u, misses: %u",
+            iblCache.entries.size(),
+            iblCache.hitCount,
+            iblCache.missCount
+        );
+
+        if (ImGui::Button("Clear IBL cache")) {
+            queuedFrameBeginActions.emplace([&] { clearIblCache(); });
+        }
+    }
+
+    if (model && ImGui::CollapsingHeader("Stress test ", sectionFlags)) {
+        auto &settings = stressSceneSettings;
+        auto &benchmark = instancingBenchmark;
+
+        static constexpr std::array layoutNames = {"Grid", "Scatter"};
+
+        bool shouldRegenerate = false;
+
+        int layoutIdx = static_cast<int>(settings.layout);
+        if (ImGui::Combo("Layout", &layoutIdx, layoutNames.data(), static_cast<int>(layoutNames.size()))) {
+            settings.layout = static_cast<StressSceneLayout>(layoutIdx);
+            shouldRegenerate = true;
+        }
+
+        shouldRegenerate |= ImGui::SliderInt("Copies", &settings.copyCount, 1, MAX_STRESS_SCENE_COPIES, "%d",
+                                             ImGuiSliderFlags_Logarithmic);
+        shouldRegenerate |= ImGui::SliderFloat("Spacing", &settings.spacing, 0.25f, 4.0f, "%.2f");
+        shouldRegenerate |= ImGui::Checkbox("Random rotation", &settings.randomRotation);
+        shouldRegenerate |= ImGui::SliderFloat("Min scale", &settings.minScale, 0.1f, settings.maxScale, "%.2f");
+        shouldRegenerate |= ImGui::SliderFloat("Max scale", &settings.maxScale, settings.minScale, 4.0f, "%.2f");
+
+        if (ImGui::Button("Reshuffle copies")) {
+            settings.seed++;
+            shouldRegenerate = true;
+        }
+
+        // regenerating waits for the device to go idle, so it can't happen in the middle of recording
+        if (shouldRegenerate && benchmark.framesLeft == 0) {
+            queuedFrameBeginActions.emplace([this] {
+                generateStressScene();
+            });
+        }
+
+        if (const auto &scene = benchmark.sceneResult; scene.instanceCount > 0) {
+            ImGui::Text("Instances: %u (%.1f MB, %.1f MB uncompacted)", scene.instanceCount,
+                        static_cast<float>(scene.uploadBytes) / 1e6f,
+                        static_cast<float>(scene.legacyUploadBytes) / 1e6f);
+            ImGui::Text("Pack: %.2f ms, upload: %.2f ms", scene.packTimeMs, scene.uploadTimeMs);
+        }
+
+        ImGui::Separator();
+
+        ImGui::Checkbox("Sweep copy counts", &benchmark.sweepCopyCounts);
+
+        if (benchmark.framesLeft > 0) {
+            ImGui::Text("Benchmarking... %zu runs left", benchmark.pendingCopyCounts.size() + 1);
+        } else if (ImGui::Button("Run benchmark")) {
+            queuedFrameBeginActions.emplace([this] {
+                startInstancingBenchmark();
+            });
+        }
+
+        for (const auto &result: benchmark.results) {
+            ImGui::Text("%u instances: frame %.2f ms, CPU %.2f ms, GPU %.2f ms", result.instanceCount,
+                        result.frameTimeMs, result.cpuRecordTimeMs, result.gpuTimeMs);
+        }
+    }
+
+    camera->renderGuiSection();
+}
+
+// ==================== frame capture ====================
+
+void VulkanRenderer::setCameraOrbit(const glm::vec2 rotation, const float radius) {
+    camera->setOrbit(rotation, radius);
+}
+
+void VulkanRenderer::captureFrame(std::function<void(CapturedFrame &&)> callback) {
+    if (!swapChain->isImageReadable()) {
+        throw std::runtime_error("swap chain images can't be copied from on this surface!");
+    }
+
+    if (vkutils::img::getFormatSizeInBytes(swapChain->getImageFormat()) != 4) {
+        throw std::runtime_error("unsupported swap chain format for frame captures!");
+    }
+
+    auto &res = frameResources[currentFrameIdx];
+    const vk::Extent2D extent = swapChain->getExtent();
+
+    // the previous capture of this frame has already been delivered, so the buffer is free
+    if (!res.captureBuffer || res.captureBufferExtent != extent) {
+        res.captureBuffer = make_unique<Buffer>(
+            **ctx.allocator,
+            4ull * extent.width * extent.height,
+            vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        res.captureBufferMapped = res.captureBuffer->map();
+        res.captureBufferExtent = extent;
+    }
+
+    res.captureCallback = std::move(callback);
+}
+
+void VulkanRenderer::flushCapturedFrames() {
+    waitIdle();
+
+    // in submission order, starting at the current index, which holds the oldest frame
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        deliverCapturedFrame(frameResources[(currentFrameIdx + i) % framesInFlight]);
+    }
+}
+
+void VulkanRenderer::deliverCapturedFrame(FrameResources &res) const {
+    if (!res.captureCallback) {
+        return;
+    }
+
+    const auto callback = std::move(res.captureCallback);
+    res.captureCallback = nullptr;
+
+    CapturedFrame frame{
+        .width = res.captureBufferExtent.width,
+        .height = res.captureBufferExtent.height,
+    };
+
+    const auto *data = static_cast<const uint8_t *>(res.captureBufferMapped);
+    frame.pixels.assign(data, data + 4ull * frame.width * frame.height);
+
+    const vk::Format format = swapChain->getImageFormat();
+    const bool isBgra = format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+
+    for (size_t i = 0; i < frame.pixels.size(); i += 4) {
+        if (isBgra) {
+            std::swap(frame.pixels[i], frame.pixels[i + 2]);
+        }
+
+        // the surface is opaque, whatever the passes left in alpha
+        frame.pixels[i + 3] = 255;
+    }
+
+    callback(std::move(frame));
+}
+
+// ==================== render loop ====================
+
+void VulkanRenderer::tick(const float deltaTime) {
+    limitFrameRate();
+    sampleCameraInput();
+    pollFileChanges();
+    applySceneGraphChanges();
+
+    if (isAnimating()) {
+        const float duration = model->getAnimations()[animationState.animationIdx].duration;
+        animationState.time = std::fmod(animationState.time + deltaTime * animationState.speed, duration);
+    }
+
+    if (
+        !ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow)
+        && !ImGui::IsAnyItemActive()
+        && !ImGui::IsAnyItemFocused()
+    ) {
+        inputManager->tick(deltaTime);
+    }
+}
+
+void VulkanRenderer::renderSceneNodeTree(const uint32_t nodeIdx) {
+    const auto &nodes = model->getSceneNodes();
+    const auto &node = nodes[nodeIdx];
+
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+
+    if (node.subtreeEnd == nodeIdx + 1) {
+        flags |= ImGuiTreeNodeFlags_Leaf;
+    }
+
+    if (selectedSceneNode == nodeIdx) {
+        flags |= ImGuiTreeNodeFlags_Selected;
+    }
+
+    const char *name = node.name.empty() ? "(unnamed)" : node.name.c_str();
+    const bool isOpen = ImGui::TreeNodeEx(reinterpret_cast<void *>(static_cast<uintptr_t>(nodeIdx)), flags, "%s", name);
+
+    if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
+        selectedSceneNode = nodeIdx;
+    }
+
+    if (isOpen) {
+        // children follow their parent, each one after the subtree of the previous one
+        for (uint32_t childIdx = nodeIdx + 1; childIdx < node.subtreeEnd; childIdx = nodes[childIdx].subtreeEnd) {
+            renderSceneNodeTree(childIdx);
+        }
+
+        ImGui::TreePop();
+    }
+}
+
+void VulkanRenderer::renderGui(const std::function<void()> &renderCommands) {
+    const auto &commandBuffer = *frameResources[currentFrameIdx].guiCmdBuffer.buffer;
+
+    const std::vector colorAttachmentFormats{swapChain->getImageFormat()};
+
+    const vk::StructureChain<
+        vk::CommandBufferInheritanceInfo,
+        vk::CommandBufferInheritanceRenderingInfo
+    > inheritanceInfo{
+        {},
+        {
+            .colorAttachmentCount = static_cast<uint32_t>(colorAttachmentFormats.size()),
+            .pColorAttachmentFormats = colorAttachmentFormats.data(),
+            .rasterizationSamples = getMsaaSampleCount(),
+        }
+    };
+
+    const vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &inheritanceInfo.get<vk::CommandBufferInheritanceInfo>(),
+    };
+
+    commandBuffer.begin(beginInfo);
+
+    guiRenderer->beginRendering();
+    renderCommands();
+    guiRenderer->endRendering(commandBuffer);
+
+    commandBuffer.end();
+
+    frameResources[currentFrameIdx].guiCmdBuffer.wasRecordedThisFrame = true;
+}
+
+bool VulkanRenderer::needsRedraw() {
+    if (!idleRendering.isEnabled) {
+        return true;
+    }
+
+    const bool hasTransformChanged = camera->getProjectionMatrix() * camera->getViewMatrix() != idleRendering.lastViewProj
+                                     || getModelMatrix() != idleRendering.lastModel;
+
+    if (
+        idleRendering.hasPendingChanges
+        || hasTransformChanged
+        || framebufferResized
+        || !queuedFrameBeginActions.empty()
+        || instancingBenchmark.framesLeft > 0
+        || !dirtyInstanceRanges.empty()
+        || isAnimating()
+    ) {
+        idleRendering.hasPendingChanges = false;
+        idleRendering.framesUntilIdle = getFramesToSettle();
+    }
+
+    return idleRendering.framesUntilIdle > 0;
+}
+
+void VulkanRenderer::waitForEvents() {
+    // there's nothing else to do, so the last frames' presentation can be waited on directly for exact timings
+    static constexpr uint64_t presentTimeoutNs = 100'000'000;
+    pollPresentTimes(presentTimeoutNs);
+
+    glfwWaitEventsTimeout(IDLE_WAIT_TIMEOUT);
+
+    // time spent idle shouldn't be integrated into camera movement once input arrives
+    latencyState.lastInputSampleTime = glfwGetTime();
+}
+
+uint32_t VulkanRenderer::getFramesToSettle() const {
+    uint32_t frames = GUI_SETTLE_FRAMES;
+
+    if (useTaa) {
+        frames = std::max(frames, progressiveState.isEnabled ? PROGRESSIVE_MAX_FRAMES : TAA_SETTLE_FRAMES);
+    }
+
+    if (useSsao && aoTechnique == AmbientOcclusionTechnique::GTAO) {
+        frames = std::max(frames, GTAO_SETTLE_FRAMES);
+    }
+
+    return frames;
+}
+
+void VulkanRenderer::limitFrameRate() const {
+    if (!idleRendering.isEnabled || idleRendering.frameCap <= 0) {
+        return;
+    }
+
+    const double nextFrameTime = idleRendering.lastFrameStartTime + 1.0 / idleRendering.frameCap;
+
+    if (const double remaining = nextFrameTime - glfwGetTime(); remaining > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+    }
+}
+
+bool VulkanRenderer::startFrame() {
+    idleRendering.lastFrameStartTime = glfwGetTime();
+
+    while (!queuedFrameBeginActions.empty()) {
+        queuedFrameBeginActions.front()();
+        queuedFrameBeginActions.pop();
+    }
+
+    const auto &sync = frameResources[currentFrameIdx].sync;
+
+    const std::vector waitSemaphores = {
+        **sync.renderFinishedTimeline.semaphore,
+    };
+
+    const std::vector waitSemaphoreValues = {
+        sync.renderFinishedTimeline.timeline,
+    };
+
+    const vk::SemaphoreWaitInfo waitInfo{
+        .semaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+        .pSemaphores = waitSemaphores.data(),
+        .pValues = waitSemaphoreValues.data(),
+    };
+
+    if (ctx.device->waitSemaphores(waitInfo, UINT64_MAX) != vk::Result::eSuccess) {
+        throw std::runtime_error("waitSemaphores on renderFinishedTimeline failed");
+    }
+
+    deliverCapturedFrame(frameResources[currentFrameIdx]);
+    pollPresentTimes();
+
+    const auto gpuFrameTime = readGpuFrameTime();
+
+    if (gpuFrameTime) {
+        updateRenderScale(*gpuFrameTime);
+    }
+
+    updateInstancingBenchmark(gpuFrameTime);
+    readCullingStats();
+
+    if (const vk::Extent2D newRenderExtent = getScaledRenderExtent(); newRenderExtent != renderExtent) {
+        // history pixels no longer line up with the current ones
+        gtaoState.isHistoryValid = false;
+        taaState.isHistoryValid = false;
+        renderExtent = newRenderExtent;
+    }
+
+    const auto &[result, imageIndex] = swapChain->acquireNextImage(*sync.imageAvailableSemaphore);
+
+    if (result == vk::Result::eErrorOutOfDateKHR) {
+        recreateSwapChain();
+        return false;
+    }
+    if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR) {
+        throw std::runtime_error("failed to acquire swap chain image!");
+    }
+
+    frameResources[currentFrameIdx].sceneCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].prepassCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].shadowCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].ssaoCmdBuffer.wasRecordedThisFrame = false;
+    for (auto &blurCmdBuffer: frameResources[currentFrameIdx].ssaoBlurCmdBuffers) {
+        blurCmdBuffer.wasRecordedThisFrame = false;
+    }
+    frameResources[currentFrameIdx].gtaoCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].hasAsyncComputeWork = false;
+    frameResources[currentFrameIdx].cullingCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].skinningCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].guiCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].debugCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].taaCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].fxaaCmdBuffer.wasRecordedThisFrame = false;
+    frameResources[currentFrameIdx].upscaleCmdBuffer.wasRecordedThisFrame = false;
+
+    instancingBenchmark.recordStartTime = glfwGetTime();
+
+    return true;
+}
+
+void VulkanRenderer::endFrame() {
+    recordGraphicsCommandBuffer();
+
+    // frames before the measured ones are skipped, same as in `updateInstancingBenchmark`
+    if (auto &benchmark = instancingBenchmark;
+        benchmark.framesLeft > 0 && benchmark.framesLeft < INSTANCING_BENCHMARK_FRAMES) {
+        benchmark.cpuRecordTimeSumMs += (glfwGetTime() - benchmark.recordStartTime) * 1000.0;
+        benchmark.cpuRecordTimeSamples++;
+    }
+
+    if (latencyState.sampleInputBeforeSubmit) {
+        sampleCameraInput();
+    }
+
+    updateLateFrameData();
+
+    auto &sync = frameResources[currentFrameIdx].sync;
+
+    std::vector waitSemaphores = {
+        **sync.imageAvailableSemaphore
+    };
+
+    std::vector<TimelineSemValueType> waitSemaphoreValues = {
+        0
+    };
+
+    std::vector<vk::PipelineStageFlags> waitStages = {
+        vk::PipelineStageFlagBits::eEarlyFragmentTests,
+    };
+
+    if (frameResources[currentFrameIdx].hasAsyncComputeWork) {
+        submitAsyncCompute();
+
+        // the first thing depending on the results is the transition of the compute pass' output
+        waitSemaphores.push_back(**sync.asyncComputeFinishedTimeline.semaphore);
+        waitSemaphoreValues.push_back(sync.asyncComputeFinishedTimeline.timeline);
+        waitStages.emplace_back(vk::PipelineStageFlagBits::eComputeShader);
+    }
+
+    const std::array signalSemaphores = {
+        **sync.renderFinishedTimeline.semaphore,
+        **sync.readyToPresentSemaphore
+    };
+
+    sync.renderFinishedTimeline.timeline++;
+    const std::vector<TimelineSemValueType> signalSemaphoreValues{
+        sync.renderFinishedTimeline.timeline,
+        0
+    };
+
+    const vk::StructureChain<vk::SubmitInfo, vk::TimelineSemaphoreSubmitInfo> submitInfo{
+        {
+            .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+            .pWaitSemaphores = waitSemaphores.data(),
+            .pWaitDstStageMask = waitStages.data(),
+            .commandBufferCount = 1,
+            .pCommandBuffers = &**frameResources[currentFrameIdx].graphicsCmdBuffer,
+            .signalSemaphoreCount = signalSemaphores.size(),
+            .pSignalSemaphores = signalSemaphores.data(),
+        },
+        {
+            .waitSemaphoreValueCount = static_cast<uint32_t>(waitSemaphoreValues.size()),
+            .pWaitSemaphoreValues = waitSemaphoreValues.data(),
+            .signalSemaphoreValueCount = static_cast<uint32_t>(signalSemaphoreValues.size()),
+            .pSignalSemaphoreValues = signalSemaphoreValues.data(),
+        }
+    };
+
+    try {
+        ctx.graphicsQueue->submit(submitInfo.get<vk::SubmitInfo>());
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        throw e;
+    }
+
+    const double submitTime = glfwGetTime();
+    latencyState.inputToSubmitMs = static_cast<float>((submitTime - latencyState.lastInputSampleTime) * 1000.0);
+
+    const std::array presentWaitSemaphores = {**sync.readyToPresentSemaphore};
+
+    const std::array imageIndices = {swapChain->getCurrentImageIndex()};
+
+    const uint64_t presentId = latencyState.nextPresentId++;
+
+    vk::StructureChain<vk::PresentInfoKHR, vk::PresentIdKHR> presentInfo{
+        {
+            .waitSemaphoreCount = presentWaitSemaphores.size(),
+            .pWaitSemaphores = presentWaitSemaphores.data(),
+            .swapchainCount = 1U,
+            .pSwapchains = &***swapChain,
+            .pImageIndices = imageIndices.data(),
+        },
+        {
+            .swapchainCount = 1U,
+            .pPresentIds = &presentId,
+        }
+    };
+
+    if (isPresentWaitSupported) {
+        latencyState.pendingPresents.emplace_back(presentId, submitTime);
+    } else {
+        presentInfo.unlink<vk::PresentIdKHR>();
+    }
+
+    auto presentResult = vk::Result::eSuccess;
+
+    try {
+        presentResult = presentQueue->presentKHR(presentInfo.get<vk::PresentInfoKHR>());
+    } catch (...) {
+    }
+
+    const bool didResize = presentResult == vk::Result::eErrorOutOfDateKHR
+                           || presentResult == vk::Result::eSuboptimalKHR
+                           || framebufferResized;
+    if (didResize) {
+        framebufferResized = false;
+        recreateSwapChain();
+    } else if (presentResult != vk::Result::eSuccess) {
+        throw std::runtime_error("failed to present swap chain image!");
+    }
+
+    if (idleRendering.framesUntilIdle > 0) {
+        idleRendering.framesUntilIdle--;
+    }
+
+    currentFrameIdx = (currentFrameIdx + 1) % framesInFlight;
+}
+
+void VulkanRenderer::sampleCameraInput() {
+    const double currentTime = glfwGetTime();
+    const auto deltaTime = static_cast<float>(currentTime - latencyState.lastInputSampleTime);
+    latencyState.lastInputSampleTime = currentTime;
+
+    glfwPollEvents();
+    camera->tick(deltaTime);
+}
+
+void VulkanRenderer::updateLateFrameData() {
+    const auto &res = frameResources[currentFrameIdx];
+
+    const glm::mat4 viewProj = camera->getProjectionMatrix() * camera->getViewMatrix();
+    const glm::mat4 modelMatrix = getModelMatrix();
+
+    const bool isViewStatic = viewProj == taaState.prevViewProj
+                              && modelMatrix == taaState.prevModel
+                              && !res.hasInstanceUploads
+                              && !isAnimating();
+
+    if (
+        progressiveState.isEnabled
+        && res.taaCmdBuffer.wasRecordedThisFrame
+        && progressiveState.canAccumulate
+        && isViewStatic
+    ) {
+        progressiveState.accumulatedFrames = std::min(progressiveState.accumulatedFrames + 1, PROGRESSIVE_MAX_FRAMES);
+    } else {
+        progressiveState.accumulatedFrames = 0;
+    }
+
+    updateGraphicsUniformBuffer();
+    updateLightBuffers();
+
+    // next frame's motion vectors are relative to this one
+    taaState.prevViewProj = viewProj;
+    taaState.prevModel = modelMatrix;
+
+    if (res.gtaoCmdBuffer.wasRecordedThisFrame || res.hasAsyncComputeWork) {
+        gtaoState.prevViewProj = viewProj;
+    }
+
+    idleRendering.lastViewProj = viewProj;
+    idleRendering.lastModel = taaState.prevModel;
+}
+
+void VulkanRenderer::pollPresentTimes(const uint64_t timeout) {
+    while (!latencyState.pendingPresents.empty()) {
+        const auto &[presentId, submitTime] = latencyState.pendingPresents.front();
+
+        vk::Result result;
+
+        try {
+            result = (**swapChain).waitForPresent(presentId, timeout);
+        } catch (...) {
+            // e.g. the swap chain went out of date, these frames won't be reported
+            latencyState.pendingPresents.clear();
+            return;
+        }
+
+        if (result != vk::Result::eSuccess) {
+            return;
+        }
+
+        latencyState.submitToPresentMs = static_cast<float>((glfwGetTime() - submitTime) * 1000.0);
+        latencyState.pendingPresents.pop_front();
+    }
+}
+
+void VulkanRenderer::submitAsyncCompute() {
+    auto &res = frameResources[currentFrameIdx];
+    auto &sync = res.sync;
+
+    // the prepass, followed by graphics work which doesn't depend on the async compute results
+
+    sync.prepassFinishedTimeline.timeline++;
+
+    const vk::StructureChain<vk::SubmitInfo, vk::TimelineSemaphoreSubmitInfo> prepassSubmitInfo{
+        {
+            .commandBufferCount = 1,
+            .pCommandBuffers = &**res.prepassGraphicsCmdBuffer,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &**sync.prepassFinishedTimeline.semaphore,
+        },
+        {
+            .signalSemaphoreValueCount = 1,
+            .pSignalSemaphoreValues = &sync.prepassFinishedTimeline.timeline,
+        }
+    };
+
+    const vk::SubmitInfo overlappedSubmitInfo{
+        .commandBufferCount = 1,
+        .pCommandBuffers = &**res.overlappedGraphicsCmdBuffer,
+    };
+
+    ctx.graphicsQueue->submit({prepassSubmitInfo.get<vk::SubmitInfo>(), overlappedSubmitInfo});
+
+    // the async compute work itself, the remaining graphics submission waits on the timeline it signals
+
+    static constexpr vk::PipelineStageFlags computeWaitStage = vk::PipelineStageFlagBits::eComputeShader;
+
+    sync.asyncComputeFinishedTimeline.timeline++;
+
+    const vk::StructureChain<vk::SubmitInfo, vk::TimelineSemaphoreSubmitInfo> computeSubmitInfo{
+        {
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &**sync.prepassFinishedTimeline.semaphore,
+            .pWaitDstStageMask = &computeWaitStage,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &**res.asyncComputeCmdBuffer,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &**sync.asyncComputeFinishedTimeline.semaphore,
+        },
+        {
+            .waitSemaphoreValueCount = 1,
+            .pWaitSemaphoreValues = &sync.prepassFinishedTimeline.timeline,
+            .signalSemaphoreValueCount = 1,
+            .pSignalSemaphoreValues = &sync.asyncComputeFinishedTimeline.timeline,
+        }
+    };
+
+    ctx.asyncComputeQueue->submit(computeSubmitInfo.get<vk::SubmitInfo>());
+}
+
+void VulkanRenderer::runSkinningPass() {
+    if (!model || !model->isSkinned()) {
+        return;
+    }
+
+    auto &res = frameResources[currentFrameIdx];
+
+    const auto &animations = model->getAnimations();
+    const std::optional<uint32_t> animationIdx = animations.empty()
+                                                     ? std::nullopt
+                                                     : std::optional(static_cast<uint32_t>(animationState.animationIdx));
+
+    model->computeBoneMatrices(animationIdx, animationState.time, animationState.boneMatrices);
+
+    // this frame's previous submission has already finished, so the bones can be overwritten right away
+    memcpy(
+        res.boneBufferMapped,
+        animationState.boneMatrices.data(),
+        animationState.boneMatrices.size() * sizeof(glm::mat4)
+    );
+
+    const auto &commandBuffer = *res.skinningCmdBuffer.buffer;
+
+    constexpr vk::CommandBufferInheritanceInfo inheritanceInfo;
+
+    const vk::CommandBufferBeginInfo beginInfo{
+        .pInheritanceInfo = &inheritanceInfo,
+    };
+
+    commandBuffer.begin(beginInfo);
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, ***skinningPipeline);
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute,
+        *skinningPipeline->getLayout(),
+        0,
+        ***res.skinningDescriptorSet,
+        nullptr
+    );
+
+    commandBuffer.pushConstants<SkinningPushConstants>(
+        *skinningPipeline->getLayout(),
+        vk::ShaderStageFlagBits::eCompute,
+        0,
+        SkinningPushConstants{
+            .skinnedVertexCount = skinnedVertexCount,
+            .vertexStride = sizeof(ModelVertex) / sizeof(float),
+            .positionOffset = offsetof(ModelVertex, pos) / sizeof(float),
+            .normalOffset = offsetof(ModelVertex, normal) / sizeof(float),
+            .tangentOffset = offsetof(ModelVertex, tangent) / sizeof(float),
+            .bitangentOffset = offsetof(ModelVertex, bitangent) / sizeof(float),
+        }
+    );
+
+    // has to match the workgroup size in skin.comp
+    static constexpr uint32_t skinGroupSize = 64;
+    commandBuffer.dispatch((skinnedVertexCount + skinGroupSize - 1) / skinGroupSize, 1, 1);
+
+    constexpr vk::MemoryBarrier outputBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead,
+    };
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eVertexInput,
+        {},
+        outputBarrier,
+        nullptr,
+        nullptr
+    );
+
+    commandBuffer.end();
+
+    res.skinningCmdBuffer.wasRecordedThisFrame = true;
+}
+
+void VulkanRenderer::runShadowPass() {
+    if (!model || !useShadows) {
+        return;
+    }
+
+    const glm::mat4 lightViewProj = getLightViewProj();
+    const glm::mat4 modelMatrix = getModelMatrix();
+
+    if (shadowMapState.isValid && shadowMapState.lightViewProj == lightViewProj
+        && shadowMapState.modelMatrix == modelMatrix && !isAnimating()) {
+        return;
+    }
+
+    const auto &commandBuffer = *frameResources[currentFrameIdx].shadowCmdBuffer.buffer;
+
+    const vk::StructureChain<
+        vk::CommandBufferInheritanceInfo,
+        vk::CommandBufferInheritanceRenderingInfo
+    > inheritanceInfo{
+        {},
+        shadowRenderInfo->getInheritanceRenderingInfo()
+    };
+
+    const vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &inheritanceInfo.get<vk::CommandBufferInheritanceInfo>(),
+    };
+
+    commandBuffer.begin(beginInfo);
+
+    vkutils::cmd::setDynamicStates(commandBuffer, shadowMapTexture->getImage().getExtent2d());
+
+    auto &pipeline = shadowRenderInfo->getPipeline();
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
+
+    commandBuffer.bindVertexBuffers(0, *getModelVertexBuffer(), {0});
+    commandBuffer.bindVertexBuffers(1, **instanceDataBuffer, {0});
+    commandBuffer.bindIndexBuffer(**indexBuffer, 0, vk::IndexType::eUint32);
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *pipeline.getLayout(),
+        0,
+        {
+            ***frameResources[currentFrameIdx].prepassDescriptorSet,
+            ***materialsDescriptorSet,
+        },
+        nullptr
+    );
+
+    drawModel(commandBuffer, true, pipeline);
+
+    commandBuffer.end();
+
+    frameResources[currentFrameIdx].shadowCmdBuffer.wasRecordedThisFrame = true;
+
+    shadowMapState.isValid = true;
+    shadowMapState.lightViewProj = lightViewProj;
+    shadowMapState.modelMatrix = modelMatrix;
+}
+
+void VulkanRenderer::runPrepass() {
+    if (!model) {
+        return;
+    }
+
+    const auto &commandBuffer = *frameResources[currentFrameIdx].prepassCmdBuffer.buffer;
+
+    const vk::StructureChain<
+        vk::CommandBufferInheritanceInfo,
+        vk::CommandBufferInheritanceRenderingInfo
+    > inheritanceInfo{
+        {},
+        prepassRenderInfo->getInheritanceRenderingInfo()
+    };
+
+    const vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &inheritanceInfo.get<vk::CommandBufferInheritanceInfo>(),
+    };
+
+    commandBuffer.begin(beginInfo);
+
+    vkutils::cmd::setDynamicStates(commandBuffer, renderExtent);
+
+    auto &pipeline = prepassRenderInfo->getPipeline();
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
+
+    commandBuffer.bindVertexBuffers(0, *getModelVertexBuffer(), {0});
+    commandBuffer.bindVertexBuffers(1, **instanceDataBuffer, {0});
+    commandBuffer.bindIndexBuffer(**indexBuffer, 0, vk::IndexType::eUint32);
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *pipeline.getLayout(),
+        0,
+        {
+            ***frameResources[currentFrameIdx].prepassDescriptorSet,
+            ***materialsDescriptorSet,
+        },
+        nullptr
+    );
+
+    drawModel(commandBuffer, true, pipeline);
+
+    commandBuffer.end();
+
+    frameResources[currentFrameIdx].prepassCmdBuffer.wasRecordedThisFrame = true;
+}
+
+void VulkanRenderer::runCullingPass() {
+    auto &res = frameResources[currentFrameIdx];
+
+    // the depth pyramid is built from this frame's prepass
+    if (!model || !useOcclusionCulling || !res.prepassCmdBuffer.wasRecordedThisFrame) {
+        return;
+    }
+
+    const auto &commandBuffer = *res.cullingCmdBuffer.buffer;
+
+    constexpr vk::CommandBufferInheritanceInfo inheritanceInfo;
+
+    const vk::CommandBufferBeginInfo beginInfo{
+        .pInheritanceInfo = &inheritanceInfo,
+    };
+
+    commandBuffer.begin(beginInfo);
+
+    // depth pyramid
+
+    const Image &pyramidImage = depthPyramidTexture->getImage();
+    const uint32_t levelCount = pyramidImage.getMipLevels();
+
+    const vk::ImageSubresourceRange pyramidRange{
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = levelCount,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+
+    // every level gets rebuilt, so the previous contents are discarded. the image is only ever
+    // accessed by compute dispatches, so only the previous frame's culling has to be waited for
+    const vk::ImageMemoryBarrier pyramidWriteBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eShaderRead,
+        .dstAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .oldLayout = vk::ImageLayout::eUndefined,
+        .newLayout = vk::ImageLayout::eGeneral,
+        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .image = **pyramidImage,
+        .subresourceRange = pyramidRange,
+    };
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        nullptr,
+        nullptr,
+        pyramidWriteBarrier
+    );
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, ***depthPyramidPipeline);
+
+    // level sizes are derived from the internal resolution and rounded down, which the culling shader relies on
+    glm::ivec2 srcSize{static_cast<int32_t>(renderExtent.width), static_cast<int32_t>(renderExtent.height)};
+
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const glm::ivec2 dstSize = glm::max(srcSize / 2, glm::ivec2(1));
+
+        commandBuffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute,
+            *depthPyramidPipeline->getLayout(),
+            0,
+            ***depthPyramidDescriptorSets[level],
+            nullptr
+        );
+
+        commandBuffer.pushConstants<DepthPyramidPushConstants>(
+            *depthPyramidPipeline->getLayout(),
+            vk::ShaderStageFlagBits::eCompute,
+            0,
+            DepthPyramidPushConstants{
+                .srcSize = srcSize,
+                .dstSize = dstSize,
+                .level = level,
+            }
+        );
+
+        // has to match the workgroup size in depth-pyramid.comp
+        static constexpr uint32_t pyramidGroupSize = 8;
+        commandBuffer.dispatch(
+            (static_cast<uint32_t>(dstSize.x) + pyramidGroupSize - 1) / pyramidGroupSize,
+            (static_cast<uint32_t>(dstSize.y) + pyramidGroupSize - 1) / pyramidGroupSize,
+            1
+        );
+
+        constexpr vk::MemoryBarrier levelBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+        };
+
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader,
+            {},
+            levelBarrier,
+            nullptr,
+            nullptr
+        );
+
+        srcSize = dstSize;
+    }
+
+    const vk::ImageMemoryBarrier pyramidReadBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+        .oldLayout = vk::ImageLayout::eGeneral,
+        .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .image = **pyramidImage,
+        .subresourceRange = pyramidRange,
+    };
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        nullptr,
+        nullptr,
+        pyramidReadBarrier
+    );
+
+    // culling
 
-        ImGui::Checkbox("SSAO", &useSsao);
+    const auto &meshes = model->getMeshes();
+    const vk::DeviceSize drawCommandsSize = sizeof(vk::DrawIndexedIndirectCommand) * meshes.size();
 
-        ImGui::Checkbox("IBL", &useIbl);
+    commandBuffer.copyBuffer(
+        **drawCommandTemplateBuffer,
+        **res.drawCommandBuffer,
+        vk::BufferCopy{.size = drawCommandsSize}
+    );
 
-        static bool useMsaaDummy = useMsaa;
-        if (ImGui::Checkbox("MSAA", &useMsaaDummy)) {
-            queuedFrameBeginActions.emplace([this] {
-                useMsaa = useMsaaDummy;
+    commandBuffer.fillBuffer(**res.cullStatsBuffer, 0, sizeof(CullStats), 0);
 
-                waitIdle();
-                recreateSwapChain();
+    constexpr vk::MemoryBarrier resetBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+    };
 
-                createSceneRenderInfos();
-                createSkyboxRenderInfos();
-                createDebugQuadRenderInfos();
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        resetBarrier,
+        nullptr,
+        nullptr
+    );
 
-                guiRenderer.reset();
-                initImgui();
-            });
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, ***cullingPipeline);
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute,
+        *cullingPipeline->getLayout(),
+        0,
+        ***res.cullingDescriptorSet,
+        nullptr
+    );
+
+    commandBuffer.pushConstants<CullPushConstants>(
+        *cullingPipeline->getLayout(),
+        vk::ShaderStageFlagBits::eCompute,
+        0,
+        CullPushConstants{
+            .instanceCount = cullingStats.instanceCount,
         }
+    );
 
-#ifndef NDEBUG
-        ImGui::Separator();
-        ImGui::DragFloat("Debug number", &debugNumber, 0.01, 0, std::numeric_limits<float>::max());
-#endif
-    }
+    // has to match the workgroup size in cull.comp
+    static constexpr uint32_t cullGroupSize = 64;
+    commandBuffer.dispatch((cullingStats.instanceCount + cullGroupSize - 1) / cullGroupSize, 1, 1);
 
-    if (ImGui::CollapsingHeader("Lighting ", sectionFlags)) {
-        ImGui::SliderFloat("Light intensity", &lightIntensity, 0.0f, 100.0f, "%.2f");
-        ImGui::ColorEdit3("Light color", &lightColor.x);
-        ImGui::gizmo3D("Light direction", lightDirection, 160, imguiGizmo::modeDirection);
-    }
+    constexpr vk::MemoryBarrier outputBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead
+                         | vk::AccessFlagBits::eVertexAttributeRead
+                         | vk::AccessFlagBits::eHostRead,
+    };
 
-    camera->renderGuiSection();
-}
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eDrawIndirect
+        | vk::PipelineStageFlagBits::eVertexInput
+        | vk::PipelineStageFlagBits::eHost,
+        {},
+        outputBarrier,
+        nullptr,
+        nullptr
+    );
 
-// ==================== render loop ====================
+    commandBuffer.end();
 
-void VulkanRenderer::tick(const float deltaTime) {
-    glfwPollEvents();
-    camera->tick(deltaTime);
+    res.cullingCmdBuffer.wasRecordedThisFrame = true;
+    res.hasCullStats = true;
+}
 
-    if (
-        !ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow)
-        && !ImGui::IsAnyItemActive()
-        && !ImGui::IsAnyItemFocused()
-    ) {
-        inputManager->tick(deltaTime);
+void VulkanRenderer::runSsaoPass() {
+    if (!model || !useSsao) {
+        gtaoState.isHistoryValid = false;
+        return;
     }
-}
 
-void VulkanRenderer::renderGui(const std::function<void()> &renderCommands) {
-    const auto &commandBuffer = *frameResources[currentFrameIdx].guiCmdBuffer.buffer;
+    if (aoTechnique == AmbientOcclusionTechnique::GTAO) {
+        runGtaoPass();
+        return;
+    }
 
-    const std::vector colorAttachmentFormats{swapChain->getImageFormat()};
+    // gtao history is left untouched while it's not running, so it has to be rebuilt once it's selected again
+    gtaoState.isHistoryValid = false;
+
+    const auto &commandBuffer = *frameResources[currentFrameIdx].ssaoCmdBuffer.buffer;
 
     const vk::StructureChain<
         vk::CommandBufferInheritanceInfo,
         vk::CommandBufferInheritanceRenderingInfo
     > inheritanceInfo{
         {},
-        {
-            .colorAttachmentCount = static_cast<uint32_t>(colorAttachmentFormats.size()),
-            .pColorAttachmentFormats = colorAttachmentFormats.data(),
-            .rasterizationSamples = getMsaaSampleCount(),
-        }
+        ssaoRenderInfo->getInheritanceRenderingInfo()
     };
 
     const vk::CommandBufferBeginInfo beginInfo{
@@ -1850,161 +5345,244 @@ void VulkanRenderer::renderGui(const std::function<void()> &renderCommands) {
 
     commandBuffer.begin(beginInfo);
 
-    guiRenderer->beginRendering();
-    renderCommands();
-    guiRenderer->endRendering(commandBuffer);
+    vkutils::cmd::setDynamicStates(commandBuffer, renderExtent);
+
+    auto &pipeline = ssaoRenderInfo->getPipeline();
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
+
+    commandBuffer.bindVertexBuffers(0, **screenSpaceQuadVertexBuffer, {0});
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *pipeline.getLayout(),
+        0,
+        ***frameResources[currentFrameIdx].ssaoDescriptorSet,
+        nullptr
+    );
+
+    commandBuffer.draw(screenSpaceQuadVertices.size(), 1, 0, 0);
 
     commandBuffer.end();
 
-    frameResources[currentFrameIdx].guiCmdBuffer.wasRecordedThisFrame = true;
+    frameResources[currentFrameIdx].ssaoCmdBuffer.wasRecordedThisFrame = true;
 }
 
-bool VulkanRenderer::startFrame() {
-    while (!queuedFrameBeginActions.empty()) {
-        queuedFrameBeginActions.front()();
-        queuedFrameBeginActions.pop();
-    }
+void VulkanRenderer::runGtaoPass() {
+    auto &res = frameResources[currentFrameIdx];
 
-    const auto &sync = frameResources[currentFrameIdx].sync;
+    // on the async compute queue the dispatch is submitted on its own, instead of being executed
+    // from the graphics queue's primary command buffer
+    const bool isAsync = useAsyncCompute && ctx.asyncComputeQueue;
+    const auto &commandBuffer = isAsync ? *res.asyncComputeCmdBuffer : *res.gtaoCmdBuffer.buffer;
 
-    const std::vector waitSemaphores = {
-        **sync.renderFinishedTimeline.semaphore,
-    };
+    constexpr vk::CommandBufferInheritanceInfo inheritanceInfo;
 
-    const std::vector waitSemaphoreValues = {
-        sync.renderFinishedTimeline.timeline,
+    const vk::CommandBufferBeginInfo beginInfo{
+        .pInheritanceInfo = isAsync ? nullptr : &inheritanceInfo,
     };
 
-    const vk::SemaphoreWaitInfo waitInfo{
-        .semaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
-        .pSemaphores = waitSemaphores.data(),
-        .pValues = waitSemaphoreValues.data(),
+    commandBuffer.begin(beginInfo);
+
+    // the previous frame's dispatch wrote the history read here and read the one which is about to be overwritten
+    constexpr vk::MemoryBarrier historyBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
     };
 
-    if (ctx.device->waitSemaphores(waitInfo, UINT64_MAX) != vk::Result::eSuccess) {
-        throw std::runtime_error("waitSemaphores on renderFinishedTimeline failed");
-    }
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        historyBarrier,
+        nullptr,
+        nullptr
+    );
 
-    updateGraphicsUniformBuffer();
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, ***gtaoPipeline);
 
-    const auto &[result, imageIndex] = swapChain->acquireNextImage(*sync.imageAvailableSemaphore);
+    const uint32_t historyIdx = gtaoState.frameIndex % 2;
 
-    if (result == vk::Result::eErrorOutOfDateKHR) {
-        recreateSwapChain();
-        return false;
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute,
+        *gtaoPipeline->getLayout(),
+        0,
+        ***res.gtaoDescriptorSets[historyIdx],
+        nullptr
+    );
+
+    commandBuffer.pushConstants<GtaoPushConstants>(
+        *gtaoPipeline->getLayout(),
+        vk::ShaderStageFlagBits::eCompute,
+        0,
+        GtaoPushConstants{
+            .prevViewProj = gtaoState.prevViewProj,
+            .frameIndex = gtaoState.frameIndex,
+            .radius = gtaoState.radius,
+            .historyValid = gtaoState.isHistoryValid ? 1u : 0,
+        }
+    );
+
+    // has to match the workgroup size in gtao.comp
+    static constexpr uint32_t tileSize = 16;
+    const auto &[width, height] = renderExtent;
+    commandBuffer.dispatch((width + tileSize - 1) / tileSize, (height + tileSize - 1) / tileSize, 1);
+
+    commandBuffer.end();
+
+    if (isAsync) {
+        res.hasAsyncComputeWork = true;
+    } else {
+        res.gtaoCmdBuffer.wasRecordedThisFrame = true;
     }
-    if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR) {
-        throw std::runtime_error("failed to acquire swap chain image!");
+
+    gtaoState.frameIndex++;
+    gtaoState.isHistoryValid = true;
+}
+
+void VulkanRenderer::runSsaoBlurPass() {
+    if (!model || !useSsao) {
+        return;
     }
 
-    frameResources[currentFrameIdx].sceneCmdBuffer.wasRecordedThisFrame = false;
-    frameResources[currentFrameIdx].prepassCmdBuffer.wasRecordedThisFrame = false;
-    frameResources[currentFrameIdx].ssaoCmdBuffer.wasRecordedThisFrame = false;
-    frameResources[currentFrameIdx].guiCmdBuffer.wasRecordedThisFrame = false;
-    frameResources[currentFrameIdx].debugCmdBuffer.wasRecordedThisFrame = false;
+    static constexpr std::array<glm::ivec2, 2> directions = {glm::ivec2{1, 0}, glm::ivec2{0, 1}};
 
-    return true;
+    for (size_t i = 0; i < directions.size(); i++) {
+        const auto &commandBuffer = *frameResources[currentFrameIdx].ssaoBlurCmdBuffers[i].buffer;
+
+        const vk::StructureChain<
+            vk::CommandBufferInheritanceInfo,
+            vk::CommandBufferInheritanceRenderingInfo
+        > inheritanceInfo{
+            {},
+            ssaoBlurRenderInfos[i].getInheritanceRenderingInfo()
+        };
+
+        const vk::CommandBufferBeginInfo beginInfo{
+            .flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+            .pInheritanceInfo = &inheritanceInfo.get<vk::CommandBufferInheritanceInfo>(),
+        };
+
+        commandBuffer.begin(beginInfo);
+
+        vkutils::cmd::setDynamicStates(commandBuffer, renderExtent);
+
+        auto &pipeline = ssaoBlurRenderInfos[i].getPipeline();
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
+
+        commandBuffer.bindVertexBuffers(0, **screenSpaceQuadVertexBuffer, {0});
+
+        commandBuffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics,
+            *pipeline.getLayout(),
+            0,
+            ***frameResources[currentFrameIdx].ssaoBlurDescriptorSets[i],
+            nullptr
+        );
+
+        commandBuffer.pushConstants<SsaoBlurPushConstants>(
+            *pipeline.getLayout(),
+            vk::ShaderStageFlagBits::eFragment,
+            0,
+            SsaoBlurPushConstants{
+                .direction = directions[i],
+            }
+        );
+
+        commandBuffer.draw(screenSpaceQuadVertices.size(), 1, 0, 0);
+
+        commandBuffer.end();
+
+        frameResources[currentFrameIdx].ssaoBlurCmdBuffers[i].wasRecordedThisFrame = true;
+    }
 }
 
-void VulkanRenderer::endFrame() {
-    recordGraphicsCommandBuffer();
+void VulkanRenderer::drawScene() {
+    if (!model) {
+        return;
+    }
 
-    auto &sync = frameResources[currentFrameIdx].sync;
+    const auto &commandBuffer = *frameResources[currentFrameIdx].sceneCmdBuffer.buffer;
 
-    const std::vector waitSemaphores = {
-        **sync.imageAvailableSemaphore
+    const vk::StructureChain<
+        vk::CommandBufferInheritanceInfo,
+        vk::CommandBufferInheritanceRenderingInfo
+    > inheritanceInfo{
+        {},
+        sceneRenderInfo->getInheritanceRenderingInfo()
     };
 
-    const std::vector<TimelineSemValueType> waitSemaphoreValues = {
-        0
+    const vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &inheritanceInfo.get<vk::CommandBufferInheritanceInfo>(),
     };
 
-    static constexpr vk::PipelineStageFlags waitStages[] = {
-        vk::PipelineStageFlagBits::eEarlyFragmentTests,
-        vk::PipelineStageFlagBits::eVertexInput,
-    };
+    commandBuffer.begin(beginInfo);
 
-    const std::array signalSemaphores = {
-        **sync.renderFinishedTimeline.semaphore,
-        **sync.readyToPresentSemaphore
-    };
+    vkutils::cmd::setDynamicStates(commandBuffer, renderExtent);
 
-    sync.renderFinishedTimeline.timeline++;
-    const std::vector<TimelineSemValueType> signalSemaphoreValues{
-        sync.renderFinishedTimeline.timeline,
-        0
-    };
+    // skybox
 
-    const vk::StructureChain<vk::SubmitInfo, vk::TimelineSemaphoreSubmitInfo> submitInfo{
-        {
-            .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
-            .pWaitSemaphores = waitSemaphores.data(),
-            .pWaitDstStageMask = waitStages,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &**frameResources[currentFrameIdx].graphicsCmdBuffer,
-            .signalSemaphoreCount = signalSemaphores.size(),
-            .pSignalSemaphores = signalSemaphores.data(),
-        },
-        {
-            .waitSemaphoreValueCount = static_cast<uint32_t>(waitSemaphoreValues.size()),
-            .pWaitSemaphoreValues = waitSemaphoreValues.data(),
-            .signalSemaphoreValueCount = static_cast<uint32_t>(signalSemaphoreValues.size()),
-            .pSignalSemaphoreValues = signalSemaphoreValues.data(),
-        }
-    };
+    const auto &skyboxPipeline = skyboxRenderInfos[swapChain->getCurrentImageIndex()].getPipeline();
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **skyboxPipeline);
 
-    try {
-        ctx.graphicsQueue->submit(submitInfo.get<vk::SubmitInfo>());
-    } catch (std::exception &e) {
-        std::cerr << e.what() << std::endl;
-        throw e;
-    }
+    commandBuffer.bindVertexBuffers(0, **skyboxVertexBuffer, {0});
 
-    const std::array presentWaitSemaphores = {**sync.readyToPresentSemaphore};
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *skyboxPipeline.getLayout(),
+        0,
+        ***frameResources[currentFrameIdx].skyboxDescriptorSet,
+        nullptr
+    );
 
-    const std::array imageIndices = {swapChain->getCurrentImageIndex()};
+    commandBuffer.draw(static_cast<uint32_t>(skyboxVertices.size()), 1, 0, 0);
 
-    const vk::PresentInfoKHR presentInfo{
-        .waitSemaphoreCount = presentWaitSemaphores.size(),
-        .pWaitSemaphores = presentWaitSemaphores.data(),
-        .swapchainCount = 1U,
-        .pSwapchains = &***swapChain,
-        .pImageIndices = imageIndices.data(),
-    };
+    // scene
 
-    auto presentResult = vk::Result::eSuccess;
+    const auto &scenePipeline = sceneRenderInfo->getPipeline();
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **scenePipeline);
+
+    const bool isCulled = frameResources[currentFrameIdx].cullingCmdBuffer.wasRecordedThisFrame;
+    const Buffer &instanceBuffer = isCulled
+                                       ? *frameResources[currentFrameIdx].visibleInstanceBuffer
+                                       : *instanceDataBuffer;
+
+    commandBuffer.bindVertexBuffers(0, *getModelVertexBuffer(), {0});
+    commandBuffer.bindVertexBuffers(1, *instanceBuffer, {0});
+    commandBuffer.bindIndexBuffer(**indexBuffer, 0, vk::IndexType::eUint32);
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *scenePipeline.getLayout(),
+        0,
+        {
+            ***frameResources[currentFrameIdx].sceneDescriptorSet,
+            ***materialsDescriptorSet,
+            ***iblDescriptorSet,
+        },
+        nullptr
+    );
 
-    try {
-        presentResult = presentQueue->presentKHR(presentInfo);
-    } catch (...) {
+    if (isCulled) {
+        drawCulledModel(commandBuffer, scenePipeline);
+    } else {
+        drawModel(commandBuffer, true, scenePipeline);
     }
 
-    const bool didResize = presentResult == vk::Result::eErrorOutOfDateKHR
-                           || presentResult == vk::Result::eSuboptimalKHR
-                           || framebufferResized;
-    if (didResize) {
-        framebufferResized = false;
-        recreateSwapChain();
-    } else if (presentResult != vk::Result::eSuccess) {
-        throw std::runtime_error("failed to present swap chain image!");
-    }
+    commandBuffer.end();
 
-    currentFrameIdx = (currentFrameIdx + 1) % MAX_FRAMES_IN_FLIGHT;
+    frameResources[currentFrameIdx].sceneCmdBuffer.wasRecordedThisFrame = true;
 }
 
-void VulkanRenderer::runPrepass() {
-    if (!model) {
-        return;
-    }
-
-    const auto &commandBuffer = *frameResources[currentFrameIdx].prepassCmdBuffer.buffer;
+void VulkanRenderer::drawDebugQuad() {
+    const auto &commandBuffer = *frameResources[currentFrameIdx].debugCmdBuffer.buffer;
 
     const vk::StructureChain<
         vk::CommandBufferInheritanceInfo,
         vk::CommandBufferInheritanceRenderingInfo
     > inheritanceInfo{
         {},
-        prepassRenderInfo->getInheritanceRenderingInfo()
+        debugQuadRenderInfos[0].getInheritanceRenderingInfo()
     };
 
     const vk::CommandBufferBeginInfo beginInfo{
@@ -2016,41 +5594,43 @@ void VulkanRenderer::runPrepass() {
 
     vkutils::cmd::setDynamicStates(commandBuffer, swapChain->getExtent());
 
-    auto &pipeline = prepassRenderInfo->getPipeline();
+    auto &pipeline = debugQuadRenderInfos[swapChain->getCurrentImageIndex()].getPipeline();
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
 
-    commandBuffer.bindVertexBuffers(0, **vertexBuffer, {0});
-    commandBuffer.bindVertexBuffers(1, **instanceDataBuffer, {0});
-    commandBuffer.bindIndexBuffer(**indexBuffer, 0, vk::IndexType::eUint32);
+    commandBuffer.bindVertexBuffers(0, **screenSpaceQuadVertexBuffer, {0});
 
     commandBuffer.bindDescriptorSets(
         vk::PipelineBindPoint::eGraphics,
         *pipeline.getLayout(),
         0,
-        ***frameResources[currentFrameIdx].prepassDescriptorSet,
+        ***debugQuadDescriptorSet,
         nullptr
     );
 
-    drawModel(commandBuffer, false, pipeline);
+    commandBuffer.draw(screenSpaceQuadVertices.size(), 1, 0, 0);
 
     commandBuffer.end();
 
-    frameResources[currentFrameIdx].prepassCmdBuffer.wasRecordedThisFrame = true;
+    frameResources[currentFrameIdx].debugCmdBuffer.wasRecordedThisFrame = true;
 }
 
-void VulkanRenderer::runSsaoPass() {
-    if (!model || !useSsao) {
+void VulkanRenderer::runTaaPass() {
+    if (!model || !useTaa) {
         return;
     }
 
-    const auto &commandBuffer = *frameResources[currentFrameIdx].ssaoCmdBuffer.buffer;
+    auto &res = frameResources[currentFrameIdx];
+    const auto &commandBuffer = *res.taaCmdBuffer.buffer;
+
+    const uint32_t historyIdx = taaState.frameIndex % 2;
+    const uint32_t outputIdx = 1 - historyIdx;
 
     const vk::StructureChain<
         vk::CommandBufferInheritanceInfo,
         vk::CommandBufferInheritanceRenderingInfo
     > inheritanceInfo{
         {},
-        ssaoRenderInfo->getInheritanceRenderingInfo()
+        taaRenderInfos[outputIdx].getInheritanceRenderingInfo()
     };
 
     const vk::CommandBufferBeginInfo beginInfo{
@@ -2060,9 +5640,9 @@ void VulkanRenderer::runSsaoPass() {
 
     commandBuffer.begin(beginInfo);
 
-    vkutils::cmd::setDynamicStates(commandBuffer, swapChain->getExtent());
+    vkutils::cmd::setDynamicStates(commandBuffer, renderExtent);
 
-    auto &pipeline = ssaoRenderInfo->getPipeline();
+    auto &pipeline = taaRenderInfos[outputIdx].getPipeline();
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
 
     commandBuffer.bindVertexBuffers(0, **screenSpaceQuadVertexBuffer, {0});
@@ -2071,30 +5651,45 @@ void VulkanRenderer::runSsaoPass() {
         vk::PipelineBindPoint::eGraphics,
         *pipeline.getLayout(),
         0,
-        ***frameResources[currentFrameIdx].ssaoDescriptorSet,
+        ***res.taaDescriptorSets[historyIdx],
         nullptr
     );
 
+    commandBuffer.pushConstants<TaaPushConstants>(
+        *pipeline.getLayout(),
+        vk::ShaderStageFlagBits::eFragment,
+        0,
+        TaaPushConstants{
+            .historyValid = taaState.isHistoryValid ? 1u : 0,
+        }
+    );
+
     commandBuffer.draw(screenSpaceQuadVertices.size(), 1, 0, 0);
 
     commandBuffer.end();
 
-    frameResources[currentFrameIdx].ssaoCmdBuffer.wasRecordedThisFrame = true;
+    res.taaCmdBuffer.wasRecordedThisFrame = true;
+
+    progressiveState.canAccumulate = taaState.isHistoryValid;
+
+    taaState.outputIdx = outputIdx;
+    taaState.frameIndex++;
+    taaState.isHistoryValid = true;
 }
 
-void VulkanRenderer::drawScene() {
-    if (!model) {
+void VulkanRenderer::runFxaaPass() {
+    if (!model || !useFxaa) {
         return;
     }
 
-    const auto &commandBuffer = *frameResources[currentFrameIdx].sceneCmdBuffer.buffer;
+    const auto &commandBuffer = *frameResources[currentFrameIdx].fxaaCmdBuffer.buffer;
 
     const vk::StructureChain<
         vk::CommandBufferInheritanceInfo,
         vk::CommandBufferInheritanceRenderingInfo
     > inheritanceInfo{
         {},
-        sceneRenderInfos[0].getInheritanceRenderingInfo()
+        fxaaRenderInfo->getInheritanceRenderingInfo()
     };
 
     const vk::CommandBufferBeginInfo beginInfo{
@@ -2104,62 +5699,55 @@ void VulkanRenderer::drawScene() {
 
     commandBuffer.begin(beginInfo);
 
-    vkutils::cmd::setDynamicStates(commandBuffer, swapChain->getExtent());
-
-    // skybox
+    vkutils::cmd::setDynamicStates(commandBuffer, renderExtent);
 
-    const auto &skyboxPipeline = skyboxRenderInfos[swapChain->getCurrentImageIndex()].getPipeline();
-    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **skyboxPipeline);
+    auto &pipeline = fxaaRenderInfo->getPipeline();
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
 
-    commandBuffer.bindVertexBuffers(0, **skyboxVertexBuffer, {0});
+    commandBuffer.bindVertexBuffers(0, **screenSpaceQuadVertexBuffer, {0});
 
     commandBuffer.bindDescriptorSets(
         vk::PipelineBindPoint::eGraphics,
-        *skyboxPipeline.getLayout(),
+        *pipeline.getLayout(),
         0,
-        ***frameResources[currentFrameIdx].skyboxDescriptorSet,
+        **getLatestSceneColorDescriptorSet(),
         nullptr
     );
 
-    commandBuffer.draw(static_cast<uint32_t>(skyboxVertices.size()), 1, 0, 0);
-
-    // scene
-
-    const auto &scenePipeline = sceneRenderInfos[swapChain->getCurrentImageIndex()].getPipeline();
-    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **scenePipeline);
-
-    commandBuffer.bindVertexBuffers(0, **vertexBuffer, {0});
-    commandBuffer.bindVertexBuffers(1, **instanceDataBuffer, {0});
-    commandBuffer.bindIndexBuffer(**indexBuffer, 0, vk::IndexType::eUint32);
+    const vk::Extent2D extent = swapChain->getExtent();
 
-    commandBuffer.bindDescriptorSets(
-        vk::PipelineBindPoint::eGraphics,
-        *scenePipeline.getLayout(),
+    commandBuffer.pushConstants<FxaaPushConstants>(
+        *pipeline.getLayout(),
+        vk::ShaderStageFlagBits::eFragment,
         0,
-        {
-            ***frameResources[currentFrameIdx].sceneDescriptorSet,
-            ***materialsDescriptorSet,
-            ***iblDescriptorSet,
-        },
-        nullptr
+        FxaaPushConstants{
+            .uvScale = glm::vec2(
+                static_cast<float>(renderExtent.width) / static_cast<float>(extent.width),
+                static_cast<float>(renderExtent.height) / static_cast<float>(extent.height)
+            ),
+        }
     );
 
-    drawModel(commandBuffer, true, scenePipeline);
+    commandBuffer.draw(screenSpaceQuadVertices.size(), 1, 0, 0);
 
     commandBuffer.end();
 
-    frameResources[currentFrameIdx].sceneCmdBuffer.wasRecordedThisFrame = true;
+    frameResources[currentFrameIdx].fxaaCmdBuffer.wasRecordedThisFrame = true;
 }
 
-void VulkanRenderer::drawDebugQuad() {
-    const auto &commandBuffer = *frameResources[currentFrameIdx].debugCmdBuffer.buffer;
+void VulkanRenderer::runUpscalePass() {
+    if (!model) {
+        return;
+    }
+
+    const auto &commandBuffer = *frameResources[currentFrameIdx].upscaleCmdBuffer.buffer;
 
     const vk::StructureChain<
         vk::CommandBufferInheritanceInfo,
         vk::CommandBufferInheritanceRenderingInfo
     > inheritanceInfo{
         {},
-        debugQuadRenderInfos[0].getInheritanceRenderingInfo()
+        upscaleRenderInfos[0].getInheritanceRenderingInfo()
     };
 
     const vk::CommandBufferBeginInfo beginInfo{
@@ -2169,9 +5757,10 @@ void VulkanRenderer::drawDebugQuad() {
 
     commandBuffer.begin(beginInfo);
 
-    vkutils::cmd::setDynamicStates(commandBuffer, swapChain->getExtent());
+    const vk::Extent2D extent = swapChain->getExtent();
+    vkutils::cmd::setDynamicStates(commandBuffer, extent);
 
-    auto &pipeline = debugQuadRenderInfos[swapChain->getCurrentImageIndex()].getPipeline();
+    auto &pipeline = upscaleRenderInfos[swapChain->getCurrentImageIndex()].getPipeline();
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, **pipeline);
 
     commandBuffer.bindVertexBuffers(0, **screenSpaceQuadVertexBuffer, {0});
@@ -2180,15 +5769,42 @@ void VulkanRenderer::drawDebugQuad() {
         vk::PipelineBindPoint::eGraphics,
         *pipeline.getLayout(),
         0,
-        ***debugQuadDescriptorSet,
+        **getLatestSceneColorDescriptorSet(),
         nullptr
     );
 
+    commandBuffer.pushConstants<UpscalePushConstants>(
+        *pipeline.getLayout(),
+        vk::ShaderStageFlagBits::eFragment,
+        0,
+        UpscalePushConstants{
+            .uvScale = glm::vec2(
+                static_cast<float>(renderExtent.width) / static_cast<float>(extent.width),
+                static_cast<float>(renderExtent.height) / static_cast<float>(extent.height)
+            ),
+        }
+    );
+
     commandBuffer.draw(screenSpaceQuadVertices.size(), 1, 0, 0);
 
     commandBuffer.end();
 
-    frameResources[currentFrameIdx].debugCmdBuffer.wasRecordedThisFrame = true;
+    frameResources[currentFrameIdx].upscaleCmdBuffer.wasRecordedThisFrame = true;
+}
+
+const DescriptorSet &VulkanRenderer::getLatestSceneColorDescriptorSet() const {
+    const auto &res = frameResources[currentFrameIdx];
+
+    if (res.fxaaCmdBuffer.wasRecordedThisFrame) {
+        return *sceneColorDescriptorSets[3];
+    }
+
+    // with taa, the resolved color is in whichever history texture was written this frame
+    if (res.taaCmdBuffer.wasRecordedThisFrame) {
+        return *sceneColorDescriptorSets[1 + taaState.outputIdx];
+    }
+
+    return *sceneColorDescriptorSets[0];
 }
 
 void VulkanRenderer::drawModel(const vk::raii::CommandBuffer &commandBuffer, const bool doPushConstants,
@@ -2205,7 +5821,8 @@ void VulkanRenderer::drawModel(const vk::raii::CommandBuffer &commandBuffer, con
                 vk::ShaderStageFlagBits::eFragment,
                 0,
                 ScenePushConstants{
-                    .materialID = mesh.materialID
+                    .materialID = mesh.materialID,
+                    .usesTextureArrays = model->hasPackedMaterialTextures(),
                 }
             );
         }
@@ -2224,6 +5841,30 @@ void VulkanRenderer::drawModel(const vk::raii::CommandBuffer &commandBuffer, con
     }
 }
 
+void VulkanRenderer::drawCulledModel(const vk::raii::CommandBuffer &commandBuffer, const Pipeline &pipeline) const {
+    const auto &drawCommandBuffer = *frameResources[currentFrameIdx].drawCommandBuffer;
+    const auto &meshes = model->getMeshes();
+
+    for (uint32_t i = 0; i < meshes.size(); i++) {
+        commandBuffer.pushConstants<ScenePushConstants>(
+            *pipeline.getLayout(),
+            vk::ShaderStageFlagBits::eFragment,
+            0,
+            ScenePushConstants{
+                .materialID = meshes[i].materialID,
+                .usesTextureArrays = model->hasPackedMaterialTextures(),
+            }
+        );
+
+        commandBuffer.drawIndexedIndirect(
+            *drawCommandBuffer,
+            i * sizeof(vk::DrawIndexedIndirectCommand),
+            1,
+            sizeof(vk::DrawIndexedIndirectCommand)
+        );
+    }
+}
+
 void VulkanRenderer::captureCubemap() const {
     const vk::Extent2D extent = skyboxTexture->getImage().getExtent2d();
 
@@ -2363,12 +6004,85 @@ void VulkanRenderer::computeBrdfIntegrationMap() const {
     vkutils::cmd::endSingleTimeCommands(commandBuffer, *ctx.graphicsQueue);
 }
 
+glm::mat4 VulkanRenderer::getModelMatrix() const {
+    return glm::translate(modelTranslate)
+           * mat4_cast(modelRotation)
+           * glm::scale(glm::vec3(modelScale));
+}
+
+bool VulkanRenderer::isAnimating() const {
+    return model
+           && model->isSkinned()
+           && !model->getAnimations().empty()
+           && model->getAnimations()[animationState.animationIdx].duration > 0.0f
+           && animationState.isPlaying
+           && animationState.speed > 0.0f;
+}
+
+const Buffer &VulkanRenderer::getModelVertexBuffer() const {
+    const auto &skinnedVertexBuffer = frameResources[currentFrameIdx].skinnedVertexBuffer;
+    return skinnedVertexBuffer ? *skinnedVertexBuffer : *vertexBuffer;
+}
+
+static float getHaltonSequenceValue(uint32_t index, const uint32_t base) {
+    float fraction = 1.0f;
+    float result = 0.0f;
+
+    while (index > 0) {
+        fraction /= static_cast<float>(base);
+        result += fraction * static_cast<float>(index % base);
+        index /= base;
+    }
+
+    return result;
+}
+
+glm::vec2 VulkanRenderer::getTaaJitter() const {
+    if (!useTaa) {
+        return glm::vec2(0.0f);
+    }
+
+    // halton(2, 3) covers the pixel evenly even over short stretches of the sequence.
+    // accumulating a static view can afford many more distinct sample positions
+    const uint32_t sequenceLength = progressiveState.accumulatedFrames > 0 ? PROGRESSIVE_MAX_FRAMES : 8;
+    const uint32_t index = taaState.frameIndex % sequenceLength + 1;
+
+    const glm::vec2 offset{
+        getHaltonSequenceValue(index, 2) - 0.5f,
+        getHaltonSequenceValue(index, 3) - 0.5f,
+    };
+
+    return offset * 2.0f / glm::vec2(renderExtent.width, renderExtent.height);
+}
+
+glm::vec3 VulkanRenderer::getLightDirection() const {
+    return glm::vec3(mat4_cast(lightDirection) * glm::vec4(-1, 0, 0, 0));
+}
+
+glm::mat4 VulkanRenderer::getLightViewProj() const {
+    // fit an orthographic frustum tightly around the model's bounding sphere
+    const glm::vec3 center = modelTranslate;
+    const float radius = (model ? model->getBoundingRadius() : Model::NORMALIZED_RADIUS) * modelScale;
+
+    const glm::vec3 towardsLight = glm::normalize(getLightDirection());
+    const glm::vec3 up = std::abs(towardsLight.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+
+    const glm::mat4 view = glm::lookAt(center + towardsLight * 2.0f * radius, center, up);
+    const glm::mat4 proj = glm::ortho(-radius, radius, -radius, radius, radius, 3.0f * radius);
+
+    return proj * view;
+}
+
 void VulkanRenderer::updateGraphicsUniformBuffer() const {
-    const glm::mat4 model = glm::translate(modelTranslate)
-                            * mat4_cast(modelRotation)
-                            * glm::scale(glm::vec3(modelScale));
+    const glm::mat4 modelMatrix = getModelMatrix();
     const glm::mat4 view = camera->getViewMatrix();
-    const glm::mat4 proj = camera->getProjectionMatrix();
+    const glm::mat4 unjitteredProj = camera->getProjectionMatrix();
+
+    // offsetting the projection's z column shifts the whole image by a constant amount in ndc
+    const glm::vec2 jitter = getTaaJitter();
+    glm::mat4 proj = unjitteredProj;
+    proj[2][0] += jitter.x;
+    proj[2][1] += jitter.y;
 
     glm::ivec2 windowSize{};
     glfwGetWindowSize(window, &windowSize.x, &windowSize.y);
@@ -2381,14 +6095,22 @@ void VulkanRenderer::updateGraphicsUniformBuffer() const {
         .window = {
             .windowWidth = static_cast<uint32_t>(windowSize.x),
             .windowHeight = static_cast<uint32_t>(windowSize.y),
+            .renderWidth = renderExtent.width,
+            .renderHeight = renderExtent.height,
         },
         .matrices = {
-            .model = model,
+            .model = modelMatrix,
             .view = view,
             .proj = proj,
             .inverseVp = glm::inverse(proj * view),
+            .inverseProj = glm::inverse(proj),
             .staticView = camera->getStaticViewMatrix(),
-            .cubemapCaptureProj = cubemapFaceProjection
+            .cubemapCaptureProj = cubemapFaceProjection,
+            .lightViewProj = getLightViewProj(),
+            .unjitteredViewProj = unjitteredProj * view,
+            .prevViewProj = taaState.prevViewProj,
+            .prevModel = taaState.prevModel,
+            .modelNormal = glm::mat4(glm::inverseTranspose(glm::mat3(modelMatrix))),
         },
         .misc = {
             .debugNumber = debugNumber,
@@ -2396,8 +6118,10 @@ void VulkanRenderer::updateGraphicsUniformBuffer() const {
             .zFar = zFar,
             .useSsao = useSsao ? 1u : 0,
             .useIbl = useIbl ? 1u : 0,
+            .useShadows = useShadows && model ? 1u : 0,
+            .accumulatedFrames = progressiveState.accumulatedFrames,
             .lightIntensity = lightIntensity,
-            .lightDir = glm::vec3(mat4_cast(lightDirection) * glm::vec4(-1, 0, 0, 0)),
+            .lightDir = getLightDirection(),
             .lightColor = lightColor,
             .cameraPos = camera->getPos(),
         }
@@ -2418,3 +6142,285 @@ void VulkanRenderer::updateGraphicsUniformBuffer() const {
 
     memcpy(frameResources[currentFrameIdx].graphicsUboMapped, &graphicsUbo, sizeof(graphicsUbo));
 }
+
+void VulkanRenderer::updateLightBuffers() {
+    const auto &[zNear, zFar] = camera->getClippingPlanes();
+    lightClusterGrid.build(punctualLights, camera->getViewMatrix(), camera->getProjectionMatrix(), zNear, zFar);
+
+    const auto &res = frameResources[currentFrameIdx];
+    const auto &lightData = lightClusterGrid.getLightData();
+    const auto &clusters = lightClusterGrid.getClusters();
+    const auto &lightIndices = lightClusterGrid.getLightIndices();
+
+    const LightBufferHeader header{
+        .lightCount = static_cast<uint32_t>(lightData.size()),
+        .framebufferWidth = renderExtent.width,
+        .framebufferHeight = renderExtent.height,
+    };
+
+    auto *lightBufferBytes = static_cast<std::byte *>(res.lightBufferMapped);
+    memcpy(lightBufferBytes, &header, sizeof(header));
+    memcpy(lightBufferBytes + sizeof(header), lightData.data(), lightData.size() * sizeof(LightData));
+
+    memcpy(res.lightClusterBufferMapped, clusters.data(), clusters.size() * sizeof(glm::uvec2));
+    memcpy(res.lightIndexBufferMapped, lightIndices.data(), lightIndices.size() * sizeof(uint32_t));
+}
+
+std::optional<float> VulkanRenderer::readGpuFrameTime() const {
+    const auto &res = frameResources[currentFrameIdx];
+
+    if (!res.timestampQueryPool || !res.hasTimestamps) {
+        return std::nullopt;
+    }
+
+    // this frame's previous submission has already finished, so its results are available without waiting
+    const auto [result, timestamps] = res.timestampQueryPool->getResults<uint64_t>(
+        0,
+        2,
+        2 * sizeof(uint64_t),
+        sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64
+    );
+
+    if (result != vk::Result::eSuccess) {
+        return std::nullopt;
+    }
+
+    return static_cast<float>(timestamps[1] - timestamps[0]) * timestampPeriodNs / 1e6f;
+}
+
+void VulkanRenderer::updateRenderScale(const float gpuFrameTimeMs) {
+    auto &state = dynamicResolution;
+
+    state.smoothedGpuTimeMs = state.smoothedGpuTimeMs == 0.0f
+                                  ? gpuFrameTimeMs
+                                  : glm::mix(state.smoothedGpuTimeMs, gpuFrameTimeMs, 0.1f);
+    state.framesSinceChange++;
+
+    if (!state.isEnabled) {
+        return;
+    }
+
+    // let the smoothed time settle on the new resolution before reacting again
+    static constexpr uint32_t SETTLE_FRAMES = 16;
+    if (state.framesSinceChange < SETTLE_FRAMES) {
+        return;
+    }
+
+    // aim slightly below the frame budget and leave a dead zone around it, so the scale doesn't oscillate
+    const float targetTimeMs = 0.9f * 1000.0f / state.targetFps;
+    const float loadRatio = state.smoothedGpuTimeMs / targetTimeMs;
+
+    if (loadRatio > 0.9f && loadRatio < 1.1f) {
+        return;
+    }
+
+    // gpu time is roughly proportional to the pixel count, which goes with the square of the scale
+    float newScale = state.scale / std::sqrt(loadRatio);
+    newScale = std::clamp(newScale, state.scale - 0.1f, state.scale + 0.1f);
+    newScale = std::clamp(std::round(newScale * 40.0f) / 40.0f, state.minScale, 1.0f);
+
+    if (newScale != state.scale) {
+        state.scale = newScale;
+        state.framesSinceChange = 0;
+    }
+}
+
+void VulkanRenderer::readCullingStats() {
+    auto &res = frameResources[currentFrameIdx];
+
+    if (!res.hasCullStats) {
+        return;
+    }
+
+    // this frame's previous submission has already finished, so the counters are final
+    const auto *stats = static_cast<const CullStats *>(res.cullStatsBufferMapped);
+    cullingStats.frustumCulledCount = stats->frustumCulledCount;
+    cullingStats.occludedCount = stats->occludedCount;
+
+    res.hasCullStats = false;
+}
+
+void VulkanRenderer::generateStressScene() {
+    waitIdle();
+    requestRedraw();
+
+    model->generateStressScene(stressSceneSettings);
+    modelExplodeFactor = 0.0f;
+    shadowMapState.isValid = false;
+    taaState.isHistoryValid = false;
+
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+
+    const auto packStart = Clock::now();
+    const auto instances = model->getInstances();
+    const auto uploadStart = Clock::now();
+    createInstanceBuffer(instances);
+    const auto uploadEnd = Clock::now();
+
+    createCullingBuffers();
+
+    instancingBenchmark.sceneResult = {
+        .copyCount = static_cast<uint32_t>(stressSceneSettings.copyCount),
+        .instanceCount = static_cast<uint32_t>(instances.size()),
+        .uploadBytes = sizeof(ModelInstance) * instances.size(),
+        .legacyUploadBytes = (sizeof(glm::mat4) + sizeof(glm::mat3x4)) * instances.size(),
+        .packTimeMs = Milliseconds(uploadStart - packStart).count(),
+        .uploadTimeMs = Milliseconds(uploadEnd - uploadStart).count(),
+    };
+}
+
+void VulkanRenderer::applySceneGraphChanges() {
+    if (!model) {
+        return;
+    }
+
+    const auto movedInstances = model->updateNodeWorldTransforms();
+
+    if (movedInstances.empty()) {
+        return;
+    }
+
+    // exploded offsets depend on every instance's transform, so they're simply recomputed for all of them
+    if (modelExplodeFactor != 0.0f) {
+        updateInstances(0, model->getExplodedInstances(modelExplodeFactor));
+        return;
+    }
+
+    // instances of a subtree are mostly consecutive within each mesh, so they're uploaded in runs
+    size_t runStart = 0;
+
+    for (size_t i = 1; i <= movedInstances.size(); i++) {
+        if (i == movedInstances.size() || movedInstances[i] != movedInstances[i - 1] + 1) {
+            const uint32_t firstInstance = movedInstances[runStart];
+            updateInstances(firstInstance, model->getInstances(firstInstance, static_cast<uint32_t>(i - runStart)));
+            runStart = i;
+        }
+    }
+}
+
+void VulkanRenderer::startInstancingBenchmark() {
+    auto &state = instancingBenchmark;
+
+    state.results.clear();
+    state.pendingCopyCounts.clear();
+
+    if (state.sweepCopyCounts) {
+        for (int count = 1; count < stressSceneSettings.copyCount; count *= 2) {
+            state.pendingCopyCounts.push_back(count);
+        }
+    }
+
+    state.pendingCopyCounts.push_back(stressSceneSettings.copyCount);
+
+    std::cout << "copies,instances,bytes,uncompacted bytes,pack ms,upload ms,frame ms,cpu record ms,gpu ms"
+            << std::endl;
+
+    startNextInstancingBenchmarkRun();
+}
+
+void VulkanRenderer::startNextInstancingBenchmarkRun() {
+    auto &state = instancingBenchmark;
+
+    stressSceneSettings.copyCount = state.pendingCopyCounts.front();
+    state.pendingCopyCounts.pop_front();
+
+    generateStressScene();
+
+    state.framesLeft = framesInFlight + INSTANCING_BENCHMARK_FRAMES;
+    state.cpuRecordTimeSumMs = 0.0;
+    state.cpuRecordTimeSamples = 0;
+    state.gpuTimeSumMs = 0.0;
+    state.gpuTimeSamples = 0;
+}
+
+void VulkanRenderer::updateInstancingBenchmark(const std::optional<float> gpuFrameTimeMs) {
+    auto &state = instancingBenchmark;
+
+    if (state.framesLeft == 0) {
+        return;
+    }
+
+    // timestamps read during the first frames in flight belong to frames from before the benchmark
+    if (state.framesLeft == INSTANCING_BENCHMARK_FRAMES) {
+        state.measureStartTime = glfwGetTime();
+    } else if (state.framesLeft < INSTANCING_BENCHMARK_FRAMES && gpuFrameTimeMs) {
+        state.gpuTimeSumMs += *gpuFrameTimeMs;
+        state.gpuTimeSamples++;
+    }
+
+    if (--state.framesLeft > 0) {
+        return;
+    }
+
+    auto result = state.sceneResult;
+    result.frameTimeMs = static_cast<float>((glfwGetTime() - state.measureStartTime) * 1000.0)
+                         / static_cast<float>(INSTANCING_BENCHMARK_FRAMES - 1);
+    result.cpuRecordTimeMs = state.cpuRecordTimeSamples > 0
+                                 ? static_cast<float>(state.cpuRecordTimeSumMs / state.cpuRecordTimeSamples)
+                                 : 0.0f;
+    result.gpuTimeMs = state.gpuTimeSamples > 0
+                           ? static_cast<float>(state.gpuTimeSumMs / state.gpuTimeSamples)
+                           : 0.0f;
+
+    state.results.push_back(result);
+
+    std::cout << result.copyCount << "," << result.instanceCount << ","
+            << result.uploadBytes << "," << result.legacyUploadBytes << ","
+            << result.packTimeMs << "," << result.uploadTimeMs << ","
+            << result.frameTimeMs << "," << result.cpuRecordTimeMs << "," << result.gpuTimeMs << std::endl;
+
+    if (!state.pendingCopyCounts.empty()) {
+        queuedFrameBeginActions.emplace([this] {
+            startNextInstancingBenchmarkRun();
+        });
+    }
+}
+
+vk::Extent2D VulkanRenderer::getScaledRenderExtent() const {
+    const auto &[width, height] = swapChain->getExtent();
+    const float scale = std::clamp(dynamicResolution.scale, 0.0f, 1.0f);
+
+    return {
+        std::max(1u, static_cast<uint32_t>(std::round(static_cast<float>(width) * scale))),
+        std::max(1u, static_cast<uint32_t>(std::round(static_cast<float>(height) * scale))),
+    };
+}
+
+void VulkanRenderer::generateLightRig() {
+    std::uniform_real_distribution<float> randomFloats(0.0, 1.0);
+    std::default_random_engine generator(lightRigSettings.seed);
+
+    punctualLights.clear();
+    punctualLights.reserve(lightRigSettings.lightCount);
+
+    for (int i = 0; i < lightRigSettings.lightCount; i++) {
+        const glm::vec3 position = glm::vec3(
+            randomFloats(generator) * 2.0f - 1.0f,
+            randomFloats(generator) * 0.5f,
+            randomFloats(generator) * 2.0f - 1.0f
+        ) * lightRigSettings.spread;
+
+        // fully saturated hues, so that overlapping lights are easy to tell apart
+        const glm::vec3 color = glm::clamp(
+            glm::abs(glm::mod(randomFloats(generator) * 6.0f + glm::vec3(0, 4, 2), 6.0f) - 3.0f) - 1.0f,
+            0.0f, 1.0f
+        );
+
+        const bool isSpot = randomFloats(generator) < lightRigSettings.spotFraction;
+
+        punctualLights.push_back(PunctualLight{
+            .type = isSpot ? LightType::Spot : LightType::Point,
+            .position = position,
+            .direction = glm::normalize(glm::vec3(
+                randomFloats(generator) * 0.5f - 0.25f,
+                -1.0f,
+                randomFloats(generator) * 0.5f - 0.25f
+            )),
+            .color = color,
+            .intensity = lightRigSettings.intensity,
+            .range = lightRigSettings.range,
+        });
+    }
+}
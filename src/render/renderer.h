@@ -4,12 +4,18 @@
 #include <vector>
 #include <filesystem>
 #include <array>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <list>
 #include <queue>
+#include <set>
 
 #include "deps/vma/vk_mem_alloc.h"
 
 #include "libs.h"
 #include "globals.h"
+#include "lights.h"
 #include "mesh/model.h"
 #include "vk/cmd.h"
 #include "vk/image.h"
@@ -24,6 +30,7 @@ class Pipeline;
 class DescriptorSet;
 class SwapChain;
 class GuiRenderer;
+class FileWatcher;
 
 static constexpr std::array validationLayers{
     "VK_LAYER_KHRONOS_validation"
@@ -47,6 +54,8 @@ constexpr bool enableValidationLayers = true;
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsComputeFamily;
     std::optional<uint32_t> presentFamily;
+    // preferably a compute-only family, otherwise the graphics one if it exposes more than a single queue
+    std::optional<uint32_t> asyncComputeFamily;
 
     [[nodiscard]] bool isComplete() const {
         return graphicsComputeFamily.has_value() && presentFamily.has_value();
@@ -61,6 +70,8 @@ struct GraphicsUBO {
     struct WindowRes {
         uint32_t windowWidth;
         uint32_t windowHeight;
+        uint32_t renderWidth;
+        uint32_t renderHeight;
     };
 
     struct Matrices {
@@ -68,9 +79,15 @@ struct GraphicsUBO {
         glm::mat4 view;
         glm::mat4 proj;
         glm::mat4 inverseVp;
+        glm::mat4 inverseProj;
         glm::mat4 staticView;
         glm::mat4 cubemapCaptureViews[6];
         glm::mat4 cubemapCaptureProj;
+        glm::mat4 lightViewProj;
+        glm::mat4 unjitteredViewProj;
+        glm::mat4 prevViewProj;
+        glm::mat4 prevModel;
+        glm::mat4 modelNormal;
     };
 
     struct MiscData {
@@ -79,6 +96,8 @@ struct GraphicsUBO {
         float zFar;
         uint32_t useSsao;
         uint32_t useIbl;
+        uint32_t useShadows;
+        uint32_t accumulatedFrames;
         float lightIntensity;
         glm::vec3 lightDir;
         glm::vec3 lightColor;
@@ -92,12 +111,127 @@ struct GraphicsUBO {
 
 struct ScenePushConstants {
     uint32_t materialID;
+    uint32_t usesTextureArrays;
 };
 
 struct PrefilterPushConstants {
     float roughness;
 };
 
+struct SsaoBlurPushConstants {
+    glm::ivec2 direction;
+};
+
+struct TaaPushConstants {
+    uint32_t historyValid;
+};
+
+struct FxaaPushConstants {
+    glm::vec2 uvScale;
+};
+
+struct UpscalePushConstants {
+    glm::vec2 uvScale;
+};
+
+struct GtaoPushConstants {
+    glm::mat4 prevViewProj;
+    uint32_t frameIndex;
+    float radius;
+    uint32_t historyValid;
+};
+
+struct DepthPyramidPushConstants {
+    glm::ivec2 srcSize;
+    glm::ivec2 dstSize;
+    uint32_t level;
+};
+
+struct CullPushConstants {
+    uint32_t instanceCount;
+};
+
+struct SkinningPushConstants {
+    uint32_t skinnedVertexCount;
+    // in floats, as the shader can't rely on `ModelVertex`'s layout
+    uint32_t vertexStride;
+    uint32_t positionOffset;
+    uint32_t normalOffset;
+    uint32_t tangentOffset;
+    uint32_t bitangentOffset;
+};
+
+/**
+ * Per-instance input of the culling pass. Has to match the corresponding definition in the compute shader.
+ */
+struct CullInstanceData {
+    glm::vec4 boundingSphere;
+    uint32_t meshIndex;
+};
+
+/**
+ * Counters written by the culling pass, read back by the host once the frame has finished.
+ */
+struct CullStats {
+    uint32_t frustumCulledCount;
+    uint32_t occludedCount;
+};
+
+/**
+ * Identifies a loaded model, along with the load options it depends on.
+ */
+struct ModelCacheKey {
+    std::filesystem::path path;
+    bool hasMaterials;
+    bool hasPackedTextures;
+
+    bool operator==(const ModelCacheKey &other) const = default;
+};
+
+/**
+ * A previously loaded model kept on the gpu, along with everything needed to render it again without reloading it.
+ */
+struct ResidentModel {
+    ModelCacheKey key;
+    std::filesystem::file_time_type lastWriteTime; // of the model's file, to tell whether it has changed since
+    unique_ptr<Model> model;
+    unique_ptr<Buffer> vertexBuffer;
+    unique_ptr<Buffer> indexBuffer;
+    unique_ptr<Buffer> materialTextureLayersBuffer;
+    vk::DeviceSize memoryUsage;
+};
+
+/**
+ * Everything baked from an environment map, apart from the brdf integration map shared by all of them.
+ */
+struct IblSet {
+    std::filesystem::path path;
+    std::filesystem::file_time_type lastWriteTime; // of the environment map, to tell whether it has changed since
+    unique_ptr<Texture> skybox;
+    unique_ptr<Texture> irradianceMap;
+    unique_ptr<Texture> prefilteredEnvmap;
+    unique_ptr<DescriptorSet> descriptorSet;
+    vk::DeviceSize memoryUsage;
+};
+
+/**
+ * Options fixed for the renderer's whole lifetime.
+ */
+struct RendererOptions {
+    // renders into a hidden window of this size, for producing still images rather than for interactive use.
+    // neither the default model nor the default environment map are loaded then
+    std::optional<vk::Extent2D> headlessExtent;
+};
+
+/**
+ * Pixels of a presented frame as tightly packed 8-bit rgba, top row first.
+ */
+struct CapturedFrame {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
 /**
  * Simple RAII-preserving wrapper class for the VMA allocator.
  */
@@ -130,6 +264,10 @@ struct RendererContext {
     unique_ptr<vk::raii::Device> device;
     unique_ptr<vk::raii::CommandPool> commandPool;
     unique_ptr<vk::raii::Queue> graphicsQueue;
+    unique_ptr<vk::raii::Queue> asyncComputeQueue; // null if the device has no queue to spare for it
+    // families which resources used by both the graphics and the async compute queue have to be shared between,
+    // empty if both queues come from the same family
+    std::vector<uint32_t> concurrentQueueFamilies;
     unique_ptr<VmaAllocatorWrapper> allocator;
 };
 
@@ -188,15 +326,48 @@ class VulkanRenderer {
     unique_ptr<SwapChain> swapChain;
 
     unique_ptr<Model> model;
+    std::optional<ModelCacheKey> modelKey;
+    std::filesystem::file_time_type modelLastWriteTime;
     Material separateMaterial;
 
+    // models loaded before the current one, kept resident until the budget runs out
+    struct {
+        std::list<ResidentModel> entries; // most recently used first
+        vk::DeviceSize budget = 1024ull * 1024 * 1024; // covers the current model as well
+        uint32_t hitCount = 0;
+        uint32_t missCount = 0;
+    } modelCache;
+
+    unique_ptr<FileWatcher> fileWatcher;
+
+    // picks up changes of the current model's files on disk
+    struct {
+        bool isEnabled = true;
+        std::set<std::filesystem::path> changedFiles; // not handled yet
+        std::chrono::steady_clock::time_point lastChangeTime;
+        std::future<unique_ptr<ModelImport> > pendingImport; // parsed on a worker thread
+        std::set<std::filesystem::path> importChangedFiles; // changes the pending import accounts for
+        uint32_t reloadCount = 0;
+    } hotReload;
+
     unique_ptr<Texture> ssaoTexture;
     unique_ptr<Texture> ssaoNoiseTexture;
+    unique_ptr<Texture> ssaoBlurIntermediateTexture; // horizontally blurred
+    unique_ptr<Texture> ssaoBlurredTexture; // blurred in both directions, sampled by the scene pass
+    std::array<unique_ptr<Texture>, 2> gtaoHistoryTextures; // ping-ponged between frames
+    unique_ptr<Texture> shadowMapTexture;
+    unique_ptr<Texture> sceneColorTexture; // linear hdr, rendered at the internal resolution
+    unique_ptr<Image> multisampledSceneColor; // only used with msaa, resolved into `sceneColorTexture`
+    std::array<unique_ptr<Texture>, 2> taaHistoryTextures; // ping-ponged between frames, linear hdr
+    unique_ptr<Texture> fxaaOutputTexture; // linear hdr
+    unique_ptr<Texture> depthPyramidTexture; // farthest prepass depth, each level at half the previous one's size
 
     struct {
         unique_ptr<Texture> depth;
-        unique_ptr<Texture> normal;
-        unique_ptr<Texture> pos;
+        unique_ptr<Texture> normal; // view-space, octahedral-encoded
+        unique_ptr<Texture> velocity; // uv offset from the previous frame, without the taa jitter
+        unique_ptr<Image> multisampledNormal; // only used with msaa, resolved into `normal`
+        unique_ptr<Image> multisampledVelocity; // only used with msaa, resolved into `velocity`
     } gBufferTextures;
 
     unique_ptr<Texture> skyboxTexture;
@@ -209,24 +380,64 @@ class VulkanRenderer {
 
     unique_ptr<DescriptorSet> materialsDescriptorSet;
     unique_ptr<DescriptorSet> iblDescriptorSet;
+    shared_ptr<vk::raii::DescriptorSetLayout> iblDescriptorSetLayout;
+
+    // environment the current skybox, irradiance and prefiltered maps were baked from, if any
+    std::optional<std::filesystem::path> envmapPath;
+    std::filesystem::file_time_type envmapLastWriteTime;
+
+    // ibl sets baked before the current one, kept resident until the budget runs out
+    struct {
+        std::list<IblSet> entries; // most recently used first
+        vk::DeviceSize budget = 2048ull * 1024 * 1024; // covers the current set as well
+        uint32_t hitCount = 0;
+        uint32_t missCount = 0;
+    } iblCache;
     unique_ptr<DescriptorSet> cubemapCaptureDescriptorSet;
     unique_ptr<DescriptorSet> envmapConvoluteDescriptorSet;
     unique_ptr<DescriptorSet> debugQuadDescriptorSet;
+    // each samples one of the textures the scene color can end up in before upscaling:
+    // the rendered one, either taa history texture and the fxaa output, in this order
+    std::array<unique_ptr<DescriptorSet>, 4> sceneColorDescriptorSets;
+    shared_ptr<vk::raii::DescriptorSetLayout> depthPyramidDescriptorLayout;
+    std::vector<unique_ptr<DescriptorSet>> depthPyramidDescriptorSets; // one per level built
 
-    std::vector<RenderInfo> sceneRenderInfos;
+    unique_ptr<RenderInfo> sceneRenderInfo;
     std::vector<RenderInfo> skyboxRenderInfos;
     std::vector<RenderInfo> guiRenderInfos;
     unique_ptr<RenderInfo> prepassRenderInfo;
+    unique_ptr<RenderInfo> shadowRenderInfo;
     unique_ptr<RenderInfo> ssaoRenderInfo;
+    std::vector<RenderInfo> ssaoBlurRenderInfos; // horizontal, vertical
     unique_ptr<RenderInfo> cubemapCaptureRenderInfo;
     unique_ptr<RenderInfo> irradianceCaptureRenderInfo;
     std::vector<RenderInfo> prefilterRenderInfos;
     unique_ptr<RenderInfo> brdfIntegrationRenderInfo;
     std::vector<RenderInfo> debugQuadRenderInfos;
+    std::vector<RenderInfo> taaRenderInfos; // indexed by the history texture written
+    unique_ptr<RenderInfo> fxaaRenderInfo;
+    std::vector<RenderInfo> upscaleRenderInfos;
+
+    std::optional<ComputePipelineBuilder> gtaoPipelineBuilder;
+    unique_ptr<Pipeline> gtaoPipeline;
+    std::optional<ComputePipelineBuilder> depthPyramidPipelineBuilder;
+    unique_ptr<Pipeline> depthPyramidPipeline;
+    std::optional<ComputePipelineBuilder> cullingPipelineBuilder;
+    unique_ptr<Pipeline> cullingPipeline;
+    std::optional<ComputePipelineBuilder> skinningPipelineBuilder;
+    unique_ptr<Pipeline> skinningPipeline;
 
     unique_ptr<Buffer> vertexBuffer;
     unique_ptr<Buffer> indexBuffer;
     unique_ptr<Buffer> instanceDataBuffer;
+    // host copy of the instance buffer's contents, and [first, end) ranges of instances yet to be uploaded from it
+    std::vector<ModelInstance> instanceData;
+    std::vector<std::pair<uint32_t, uint32_t> > dirtyInstanceRanges;
+    unique_ptr<Buffer> cullInstanceBuffer;
+    unique_ptr<Buffer> vertexSkinBuffer; // only if the model is skinned
+    uint32_t skinnedVertexCount = 0;
+    unique_ptr<Buffer> drawCommandTemplateBuffer; // one command per mesh, none of them with any instances
+    unique_ptr<Buffer> materialTextureLayersBuffer; // (array, layer) of every material's textures, if packed
     unique_ptr<Buffer> skyboxVertexBuffer;
     unique_ptr<Buffer> screenSpaceQuadVertexBuffer;
 
@@ -240,47 +451,148 @@ class VulkanRenderer {
             unique_ptr<vk::raii::Semaphore> imageAvailableSemaphore;
             unique_ptr<vk::raii::Semaphore> readyToPresentSemaphore;
             Timeline renderFinishedTimeline;
+            // only signaled on frames which submit async compute work
+            Timeline prepassFinishedTimeline;
+            Timeline asyncComputeFinishedTimeline;
         } sync;
 
         // primary command buffer
         unique_ptr<vk::raii::CommandBuffer> graphicsCmdBuffer;
 
+        // with async compute, the frame is split into the prepass, graphics work independent of the async
+        // compute results which overlaps with it, and the rest of the frame recorded into `graphicsCmdBuffer`
+        unique_ptr<vk::raii::CommandBuffer> prepassGraphicsCmdBuffer;
+        unique_ptr<vk::raii::CommandBuffer> overlappedGraphicsCmdBuffer;
+
+        // primary command buffer submitted to the async compute queue
+        unique_ptr<vk::raii::CommandBuffer> asyncComputeCmdBuffer;
+        bool hasAsyncComputeWork = false;
+
         SecondaryCommandBuffer sceneCmdBuffer;
         SecondaryCommandBuffer prepassCmdBuffer;
+        SecondaryCommandBuffer shadowCmdBuffer;
         SecondaryCommandBuffer ssaoCmdBuffer;
+        std::array<SecondaryCommandBuffer, 2> ssaoBlurCmdBuffers;
+        SecondaryCommandBuffer gtaoCmdBuffer;
+        SecondaryCommandBuffer cullingCmdBuffer;
+        SecondaryCommandBuffer skinningCmdBuffer;
         SecondaryCommandBuffer guiCmdBuffer;
         SecondaryCommandBuffer debugCmdBuffer;
+        SecondaryCommandBuffer taaCmdBuffer;
+        SecondaryCommandBuffer fxaaCmdBuffer;
+        SecondaryCommandBuffer upscaleCmdBuffer;
+
+        // gpu time spent on this frame's primary command buffer, read back once the frame has finished
+        unique_ptr<vk::raii::QueryPool> timestampQueryPool;
+        bool hasTimestamps = false;
 
         unique_ptr<Buffer> graphicsUniformBuffer;
         void *graphicsUboMapped{};
 
+        // clustered lighting, rewritten by the host every frame
+        unique_ptr<Buffer> lightBuffer;
+        void *lightBufferMapped{};
+        unique_ptr<Buffer> lightClusterBuffer;
+        void *lightClusterBufferMapped{};
+        unique_ptr<Buffer> lightIndexBuffer;
+        void *lightIndexBufferMapped{};
+
+        // staging memory for instance updates, reused once the frame has finished, which makes up a ring
+        // of them across frames in flight. none of the frames has to wait for the ones still in flight
+        unique_ptr<Buffer> instanceStagingBuffer;
+        void *instanceStagingBufferMapped{};
+        bool hasInstanceUploads = false;
+
+        // the presented image copied out of the swap chain, handed to the callback once the frame has finished
+        unique_ptr<Buffer> captureBuffer;
+        void *captureBufferMapped{};
+        vk::Extent2D captureBufferExtent{};
+        std::function<void(CapturedFrame &&)> captureCallback;
+
+        // skinned copy of the vertex buffer, drawn instead of it by every pass. only exists if the model is skinned
+        unique_ptr<Buffer> skinnedVertexBuffer;
+        unique_ptr<Buffer> boneBuffer;
+        void *boneBufferMapped{};
+
+        // culling output consumed by the main pass, its draw commands are reset from the template every frame
+        unique_ptr<Buffer> drawCommandBuffer;
+        unique_ptr<Buffer> visibleInstanceBuffer;
+        unique_ptr<Buffer> cullStatsBuffer;
+        void *cullStatsBufferMapped{};
+        bool hasCullStats = false;
+
         unique_ptr<DescriptorSet> sceneDescriptorSet;
         unique_ptr<DescriptorSet> skyboxDescriptorSet;
         unique_ptr<DescriptorSet> prepassDescriptorSet;
         unique_ptr<DescriptorSet> ssaoDescriptorSet;
+        std::array<unique_ptr<DescriptorSet>, 2> ssaoBlurDescriptorSets;
+        std::array<unique_ptr<DescriptorSet>, 2> gtaoDescriptorSets; // indexed by the history texture read
+        std::array<unique_ptr<DescriptorSet>, 2> taaDescriptorSets; // indexed by the history texture read
+        unique_ptr<DescriptorSet> cullingDescriptorSet;
+        unique_ptr<DescriptorSet> skinningDescriptorSet;
+
+        // number of descriptor sets above, which the descriptor pool budgets for every frame in flight
+        static constexpr uint32_t DESCRIPTOR_SET_COUNT = 12;
     };
 
     static constexpr size_t MAX_FRAMES_IN_FLIGHT = 3;
     std::array<FrameResources, MAX_FRAMES_IN_FLIGHT> frameResources;
+    uint32_t framesInFlight = MAX_FRAMES_IN_FLIGHT; // only the first this many frame resources are cycled through
 
     using FrameBeginCallback = std::function<void()>;
     std::queue<FrameBeginCallback> queuedFrameBeginActions;
 
     vk::SampleCountFlagBits msaaSampleCount = vk::SampleCountFlagBits::e1;
 
+    unique_ptr<vk::raii::CommandPool> asyncComputeCommandPool;
+
     unique_ptr<vk::raii::DescriptorPool> imguiDescriptorPool;
     unique_ptr<GuiRenderer> guiRenderer;
 
     // miscellaneous constants
 
-    static constexpr auto prepassColorFormat = vk::Format::eR16G16B16A16Sfloat;
+    static constexpr auto gBufferNormalFormat = vk::Format::eR16G16Sint; // octahedral encoding, see `pack_normal`
+    static constexpr auto gBufferVelocityFormat = vk::Format::eR16G16Sfloat;
+    static constexpr auto sceneColorFormat = vk::Format::eR16G16B16A16Sfloat;
     static constexpr auto hdrEnvmapFormat = vk::Format::eR32G32B32A32Sfloat;
     static constexpr auto brdfIntegrationMapFormat = vk::Format::eR8G8B8A8Unorm;
+    static constexpr auto shadowMapFormat = vk::Format::eD32Sfloat;
+    static constexpr auto depthPyramidFormat = vk::Format::eR32Sfloat;
 
     static constexpr uint32_t MAX_PREFILTER_MIP_LEVELS = 5;
 
+    // each cached ibl set holds a descriptor set of its own
+    static constexpr uint32_t MAX_CACHED_IBL_SETS = 8;
+
     static constexpr uint32_t MATERIAL_TEX_ARRAY_SIZE = 32;
 
+    // worst case of packed material textures, where no two of them can share an array
+    static constexpr uint32_t MAX_MATERIAL_TEXTURE_ARRAYS = 3 * MATERIAL_TEX_ARRAY_SIZE;
+
+    static constexpr uint32_t SHADOW_MAP_SIZE = 4096;
+
+    static constexpr uint32_t MAX_DEPTH_PYRAMID_LEVELS = 16;
+
+    // frames still rendered after the last change before going idle, enough for the gui to react to input
+    // and for temporal effects to converge: 0.9^32 of the old taa history is left, over 4 jitter cycles
+    static constexpr uint32_t GUI_SETTLE_FRAMES = 3;
+    static constexpr uint32_t TAA_SETTLE_FRAMES = 32;
+    static constexpr uint32_t GTAO_SETTLE_FRAMES = 8; // `MAX_ACCUMULATED_FRAMES` in gtao.comp
+
+    // past this many frames, progressive accumulation keeps a running average with a fixed weight
+    static constexpr uint32_t PROGRESSIVE_MAX_FRAMES = 256;
+
+    // frames measured by the instancing benchmark, after skipping those whose timestamps predate it
+    static constexpr uint32_t INSTANCING_BENCHMARK_FRAMES = 128;
+
+    static constexpr int MAX_STRESS_SCENE_COPIES = 16384;
+
+    // most instance data uploaded in a single frame, whatever's left over is uploaded in the following ones
+    static constexpr vk::DeviceSize INSTANCE_STAGING_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    // while idle, the loop still wakes up this often (in seconds) to check for changes
+    static constexpr double IDLE_WAIT_TIMEOUT = 0.25;
+
     // miscellaneous state variables
 
     uint32_t currentFrameIdx = 0;
@@ -290,6 +602,8 @@ class VulkanRenderer {
     glm::vec3 backgroundColor = glm::vec3(26, 26, 26) / 255.0f;
 
     float modelScale = 1.0f;
+    float modelExplodeFactor = 0.0f;
+    std::optional<uint32_t> selectedSceneNode;
     glm::vec3 modelTranslate{};
     glm::quat modelRotation{1, 0, 0, 0};
 
@@ -297,16 +611,168 @@ class VulkanRenderer {
     glm::vec3 lightColor = glm::normalize(glm::vec3(23.47, 21.31, 20.79));
     float lightIntensity = 20.0f;
 
+    std::vector<PunctualLight> punctualLights;
+    LightClusterGrid lightClusterGrid;
+
+    struct {
+        int lightCount = 0;
+        float spread = 10.0f;
+        float range = 3.0f;
+        float intensity = 5.0f;
+        float spotFraction = 0.25f;
+        uint32_t seed = 0;
+    } lightRigSettings;
+
     float debugNumber = 0;
 
+    enum class AmbientOcclusionTechnique {
+        SSAO,
+        GTAO,
+    };
+
+    AmbientOcclusionTechnique aoTechnique = AmbientOcclusionTechnique::SSAO;
+
+    struct {
+        float radius = 0.5f;
+        uint32_t frameIndex = 0;
+        bool isHistoryValid = false;
+        glm::mat4 prevViewProj{1.0f};
+    } gtaoState;
+
+    // the shadow map only gets re-rendered when the light's view-projection or the model matrix changes,
+    // or when it's explicitly invalidated, e.g. on model load. the light's frustum is fitted to the model's
+    // bounds, which don't depend on its rotation, so the model matrix has to be compared separately
+    struct {
+        bool isValid = false;
+        glm::mat4 lightViewProj{1.0f};
+        glm::mat4 modelMatrix{1.0f};
+    } shadowMapState;
+
+    // jitter and history validity advance only on frames where the taa pass runs, while the previous
+    // frame's matrices are tracked unconditionally, as they're what the prepass' motion vectors are relative to
+    struct {
+        uint32_t frameIndex = 0;
+        uint32_t outputIdx = 0; // history texture written by the most recent pass
+        bool isHistoryValid = false;
+        glm::mat4 prevViewProj{1.0f};
+        glm::mat4 prevModel{1.0f};
+    } taaState;
+
+    // a taa mode where, while the view is static, the history becomes a plain average of every frame since
+    // it stopped. with a longer jitter sequence and ssao noise varying across frames, that average converges
+    // to a supersampled, noise-free image. whether the view is static is only known once the camera
+    // is final, so the frame count is advanced along with the late uniform buffer update
+    struct {
+        bool isEnabled = false;
+        bool canAccumulate = false; // whether this frame's taa pass had a valid history to add to
+        uint32_t accumulatedFrames = 0;
+    } progressiveState;
+
+    // every pass before the upscale one renders into the top-left `renderExtent` part of screen-sized targets,
+    // so changing the scale never requires reallocating them
+    vk::Extent2D renderExtent{};
+
+    struct {
+        bool isEnabled = false;
+        float scale = 1.0f;
+        float minScale = 0.5f;
+        float targetFps = 60.0f;
+        float smoothedGpuTimeMs = 0.0f;
+        uint32_t framesSinceChange = 0;
+    } dynamicResolution;
+
+    float timestampPeriodNs = 0.0f; // zero if timestamps aren't supported
+
+    bool isPresentWaitSupported = false;
+
+    // with idle rendering, frames are only rendered while what's on screen might still change. input events,
+    // resource loads and queued actions are tracked explicitly, while the camera and model transform are
+    // compared against those of the last rendered frame, as they can keep changing without any new events
+    struct {
+        bool isEnabled = true;
+        int frameCap = 0; // frames per second, zero if uncapped
+        bool hasPendingChanges = true;
+        uint32_t framesUntilIdle = 0;
+        glm::mat4 lastViewProj{1.0f};
+        glm::mat4 lastModel{1.0f};
+        double lastFrameStartTime = 0.0;
+        void (*prevScrollCallback)(GLFWwindow *, double, double) = nullptr;
+    } idleRendering;
+
+    // the camera is sampled once more right before submitting, so the uniform buffer written then reflects
+    // the freshest input. presentation is only observable with present wait, and is polled once per frame
+    struct {
+        bool sampleInputBeforeSubmit = true;
+        std::optional<vk::PresentModeKHR> presentMode; // left to the swap chain if empty
+        double lastInputSampleTime = 0.0;
+        float inputToSubmitMs = 0.0f;
+        std::optional<float> submitToPresentMs;
+        uint64_t nextPresentId = 1;
+        std::deque<std::pair<uint64_t, double>> pendingPresents; // present id and submit time, oldest first
+    } latencyState;
+
+    // bones of skinned models are posed on the host, then skinned on the gpu once per frame for all passes
+    struct {
+        int animationIdx = 0;
+        bool isPlaying = true;
+        float time = 0.0f; // in seconds
+        float speed = 1.0f;
+        std::vector<glm::mat4> boneMatrices;
+    } animationState;
+
+    // as of the most recently finished frame which ran the culling pass
+    struct {
+        uint32_t instanceCount = 0;
+        uint32_t frustumCulledCount = 0;
+        uint32_t occludedCount = 0;
+    } cullingStats;
+
+    StressSceneSettings stressSceneSettings;
+
+    // measures how long packing, uploading, recording and rendering all instances of the stress scene takes,
+    // optionally sweeping copy counts in powers of two up to the configured one.
+    // legacy bytes are what the instances took before they were compacted
+    struct {
+        struct Result {
+            uint32_t copyCount = 0;
+            uint32_t instanceCount = 0;
+            size_t uploadBytes = 0;
+            size_t legacyUploadBytes = 0;
+            float packTimeMs = 0.0f;
+            float uploadTimeMs = 0.0f;
+            float frameTimeMs = 0.0f;
+            float cpuRecordTimeMs = 0.0f;
+            float gpuTimeMs = 0.0f;
+        };
+
+        bool sweepCopyCounts = false;
+        std::deque<int> pendingCopyCounts;
+        uint32_t framesLeft = 0;
+        double measureStartTime = 0.0;
+        double recordStartTime = 0.0;
+        double cpuRecordTimeSumMs = 0.0;
+        uint32_t cpuRecordTimeSamples = 0;
+        double gpuTimeSumMs = 0.0;
+        uint32_t gpuTimeSamples = 0;
+
+        Result sceneResult; // upload statistics of the current stress scene
+        std::vector<Result> results;
+    } instancingBenchmark;
+
     bool cullBackFaces = false;
     bool wireframeMode = false;
     bool useSsao = false;
     bool useIbl = true;
+    bool useShadows = true;
     bool useMsaa = false;
+    bool useTaa = false;
+    bool useFxaa = false;
+    bool useAsyncCompute = false; // no effect if the device has no async compute queue
+    bool useOcclusionCulling = true;
+    bool usePackedMaterialTextures = false; // applied on the next model load
 
 public:
-    explicit VulkanRenderer();
+    explicit VulkanRenderer(const RendererOptions &options = {});
 
     ~VulkanRenderer();
 
@@ -328,6 +794,22 @@ public:
 
     void tick(float deltaTime);
 
+    /**
+     * Checks whether a frame should be rendered, i.e. whether anything on screen might have changed since
+     * the last one, or temporal effects haven't converged yet. Always true if idle rendering is disabled.
+     */
+    [[nodiscard]] bool needsRedraw();
+
+    /**
+     * Makes sure the next frames get rendered, for changes the renderer can't detect on its own.
+     */
+    void requestRedraw() { idleRendering.hasPendingChanges = true; }
+
+    /**
+     * Blocks until an event arrives or a short timeout passes. Called instead of rendering while idle.
+     */
+    void waitForEvents();
+
     /**
      * Waits until the device has completed all previously submitted commands.
      */
@@ -337,6 +819,29 @@ public:
 
     void loadModel(const std::filesystem::path &path);
 
+    /**
+     * Loads the model parsed by `import` along with its materials, which lets the parsing happen on another thread.
+     * The import is left unused if the model is still resident and its file hasn't changed since.
+     */
+    void loadModelWithMaterials(ModelImport &&import);
+
+    /**
+     * Releases all models kept resident besides the current one.
+     */
+    void clearModelCache();
+
+    /**
+     * Overwrites instances starting at `firstInstance`, in the order of `Model::getInstances`. Only the changed
+     * instances are uploaded, at the start of the next frames, without waiting for any frames in flight.
+     */
+    void updateInstances(uint32_t firstInstance, const std::vector<ModelInstance> &instances);
+
+    /**
+     * Replaces a scene node's transform relative to its parent. Instances of its subtree are moved at the start
+     * of the next tick, along with those of any other node changed in the meantime.
+     */
+    void setSceneNodeTransform(uint32_t nodeIdx, const glm::mat4 &localTransform);
+
     void loadBaseColorTexture(const std::filesystem::path &path);
 
     void loadNormalMap(const std::filesystem::path &path);
@@ -348,15 +853,49 @@ public:
 
     void loadRmaMap(const std::filesystem::path &path);
 
+    /**
+     * Makes the environment map at `path` the source of the skybox and image-based lighting. Recently used
+     * environments are taken out of the ibl cache instead of being baked again, unless their file has changed since.
+     */
     void loadEnvironmentMap(const std::filesystem::path &path);
 
+    /**
+     * Releases all baked ibl sets besides the current one.
+     */
+    void clearIblCache();
+
     void reloadShaders() const;
 
+    /**
+     * Places the camera on an orbit around the model, with the given yaw and pitch.
+     */
+    void setCameraOrbit(glm::vec2 rotation, float radius);
+
+    /**
+     * Copies out the image presented by the frame being recorded. `callback` receives it once the frame has finished,
+     * at the start of one of the next frames or in `flushCapturedFrames`. Has to be called between `startFrame`
+     * and `endFrame`.
+     */
+    void captureFrame(std::function<void(CapturedFrame &&)> callback);
+
+    /**
+     * Waits for all frames in flight, and hands out each of their captured images.
+     */
+    void flushCapturedFrames();
+
 private:
     static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
 
+    static void inputEventCallback(GLFWwindow *window);
+
     void bindMouseDragActions();
 
+    /**
+     * Installs callbacks which request a redraw on any input event. Has to be called before imgui is initialized,
+     * so that its glfw backend chains them with its own.
+     */
+    void bindInputEventCallbacks();
+
     // ==================== instance creation ====================
 
     void createInstance();
@@ -392,18 +931,101 @@ private:
 
     static bool checkDeviceExtensionSupport(const vk::raii::PhysicalDevice &physicalDevice);
 
+    /**
+     * Checks whether the device can report when frames are presented, through VK_KHR_present_id and VK_KHR_present_wait.
+     * Neither is required, latency measurements past submission are just unavailable otherwise.
+     */
+    static bool checkPresentWaitSupport(const vk::raii::PhysicalDevice &physicalDevice);
+
     // ==================== logical device ====================
 
     void createLogicalDevice();
 
+    // ==================== models ====================
+
+    /**
+     * Makes the model at `path` current, either by taking it out of the model cache or by loading it
+     * if it isn't resident or its file has changed since. The previous model is moved into the cache.
+     */
+    void setModel(const std::filesystem::path &path, bool withMaterials, ModelImport *import = nullptr);
+
+    /**
+     * Moves the current model and its buffers into the front of the model cache.
+     */
+    void stashModel();
+
+    /**
+     * Releases least recently used cached models until all resident ones fit into the budget.
+     */
+    void evictModels();
+
+    /**
+     * Creates the vertex, index and texture layer buffers of the current model.
+     */
+    void createModelBuffers();
+
+    /**
+     * Resets state tied to the previous model, and points buffers and descriptors which depend on the model at the current one.
+     */
+    void onModelChanged();
+
+    [[nodiscard]] vk::DeviceSize getModelMemoryUsage() const;
+
+    // ==================== hot reload ====================
+
+    /**
+     * Makes the file watcher report changes of the current model's files, and of nothing else.
+     */
+    void watchModelFiles();
+
+    /**
+     * Handles files changed since the last check, once they stop changing. Changed textures are reloaded in place,
+     * while a changed model file is parsed again on a worker thread and swapped in once that finishes.
+     */
+    void pollFileChanges();
+
+    void reloadModelTextures(const std::set<std::filesystem::path> &files);
+
+    /**
+     * Turns the finished background import into the current model, taking over all textures whose files didn't change.
+     */
+    void finishModelReload();
+
     // ==================== assets ====================
 
     void createPrepassTextures();
 
+    void createShadowMapTexture();
+
+    void createSceneColorTexture();
+
+    void createTaaTextures();
+
+    void createFxaaTexture();
+
+    void createDepthPyramidTexture();
+
     void createSsaoTextures();
 
     void createIblTextures();
 
+    /**
+     * Creates the textures baked from an environment map: the skybox, irradiance and prefiltered maps.
+     */
+    void createEnvmapTextures();
+
+    /**
+     * Moves the current ibl set into the front of the ibl cache.
+     */
+    void stashIblSet();
+
+    /**
+     * Releases least recently used cached ibl sets until all resident ones fit into the budget.
+     */
+    void evictIblSets();
+
+    [[nodiscard]] vk::DeviceSize getIblSetMemoryUsage() const;
+
     // ==================== swap chain ====================
 
     void recreateSwapChain();
@@ -422,6 +1044,10 @@ private:
 
     void createSsaoDescriptorSets();
 
+    void createSsaoBlurDescriptorSets();
+
+    void createGtaoDescriptorSets();
+
     void createIblDescriptorSet();
 
     void createCubemapCaptureDescriptorSet();
@@ -430,6 +1056,16 @@ private:
 
     void createDebugQuadDescriptorSet();
 
+    void createTaaDescriptorSets();
+
+    void createSceneColorDescriptorSets();
+
+    void createDepthPyramidDescriptorSets();
+
+    void createCullingDescriptorSets();
+
+    void createSkinningDescriptorSets();
+
     // ==================== render infos ====================
 
     void createSceneRenderInfos();
@@ -440,8 +1076,18 @@ private:
 
     void createPrepassRenderInfo();
 
+    void createShadowRenderInfo();
+
     void createSsaoRenderInfo();
 
+    void createSsaoBlurRenderInfos();
+
+    void createGtaoPipeline();
+
+    void createCullingPipelines();
+
+    void createSkinningPipeline();
+
     void createCubemapCaptureRenderInfo();
 
     void createIrradianceCaptureRenderInfo();
@@ -452,6 +1098,12 @@ private:
 
     void createDebugQuadRenderInfos();
 
+    void createTaaRenderInfos();
+
+    void createFxaaRenderInfo();
+
+    void createUpscaleRenderInfos();
+
     // ==================== multisampling ====================
 
     [[nodiscard]] vk::SampleCountFlagBits getMaxUsableSampleCount() const;
@@ -460,6 +1112,8 @@ private:
 
     void createModelVertexBuffer();
 
+    void createInstanceBuffer(const std::vector<ModelInstance> &instances);
+
     void createSkyboxVertexBuffer();
 
     void createScreenSpaceQuadVertexBuffer();
@@ -471,6 +1125,14 @@ private:
 
     void createUniformBuffers();
 
+    void createLightBuffers();
+
+    void createInstanceStagingBuffers();
+
+    void createCullingBuffers();
+
+    void createSkinningBuffers();
+
     // ==================== commands ====================
 
     void createCommandPool();
@@ -479,14 +1141,70 @@ private:
 
     void recordGraphicsCommandBuffer();
 
+    void recordInstanceUploads(const vk::raii::CommandBuffer &commandBuffer);
+
+    /**
+     * Records a copy of the current swap chain image into this frame's capture buffer. The image is left
+     * in the layout it was rendered in.
+     */
+    void recordFrameCapture(const vk::raii::CommandBuffer &commandBuffer) const;
+
+    /**
+     * Hands the captured image of a finished frame to its callback, if it had one.
+     */
+    void deliverCapturedFrame(FrameResources &res) const;
+
+    void recordShadowPassCommands(const vk::raii::CommandBuffer &commandBuffer) const;
+
+    void recordPrepassCommands(const vk::raii::CommandBuffer &commandBuffer) const;
+
+    /**
+     * Records the ssao or gtao pass followed by the blur passes. Gtao dispatched on the async compute queue
+     * is left out, only the blur passes which consume its output are recorded then.
+     */
+    void recordAmbientOcclusionCommands(const vk::raii::CommandBuffer &commandBuffer) const;
+
+    /**
+     * Submits this frame's async compute work, synchronized with the graphics queue through timeline semaphores:
+     * it waits for the prepass submitted beforehand, and the rest of the frame waits for it in turn.
+     */
+    void submitAsyncCompute();
+
+    /**
+     * Polls events and advances the camera by the time since input was last sampled.
+     */
+    void sampleCameraInput();
+
+    /**
+     * Writes everything the host provides per frame which depends on the camera, right before submission.
+     */
+    void updateLateFrameData();
+
+    /**
+     * Records submit-to-present times of frames which have been presented since the last call.
+     * @param timeout How long to wait for each pending present, in nanoseconds.
+     */
+    void pollPresentTimes(uint64_t timeout = 0);
+
+    [[nodiscard]] uint32_t getFramesToSettle() const;
+
+    /**
+     * Sleeps for as long as needed to keep to the frame cap, if idle rendering is enabled and there is one.
+     */
+    void limitFrameRate() const;
+
     // ==================== sync ====================
 
     void createSyncObjects();
 
+    void createTimestampQueryPools();
+
     // ==================== gui ====================
 
     void initImgui();
 
+    void renderSceneNodeTree(uint32_t nodeIdx);
+
 public:
     void renderGuiSection();
 
@@ -498,18 +1216,45 @@ public:
 
     void renderGui(const std::function<void()> &renderCommands);
 
+    void runSkinningPass();
+
+    void runShadowPass();
+
     void runPrepass();
 
+    void runCullingPass();
+
     void runSsaoPass();
 
+    void runSsaoBlurPass();
+
     void drawScene();
 
     void drawDebugQuad();
 
+    void runTaaPass();
+
+    void runFxaaPass();
+
+    void runUpscalePass();
+
 private:
     void drawModel(const vk::raii::CommandBuffer &commandBuffer, bool doPushConstants,
                    const Pipeline &pipeline) const;
 
+    /**
+     * Draws the instances which survived this frame's culling pass, using the draw commands it wrote.
+     */
+    void drawCulledModel(const vk::raii::CommandBuffer &commandBuffer, const Pipeline &pipeline) const;
+
+    void runGtaoPass();
+
+    /**
+     * Returns the descriptor set sampling the most recent version of the scene color,
+     * depending on which of the anti-aliasing passes were recorded so far this frame.
+     */
+    [[nodiscard]] const DescriptorSet &getLatestSceneColorDescriptorSet() const;
+
     void captureCubemap() const;
 
     void captureIrradianceMap() const;
@@ -518,5 +1263,49 @@ private:
 
     void computeBrdfIntegrationMap() const;
 
+    [[nodiscard]] glm::mat4 getModelMatrix() const;
+
+    [[nodiscard]] bool isAnimating() const;
+
+    /**
+     * Returns the buffer this frame's passes should read model vertices from, skinned ones if there are any.
+     */
+    [[nodiscard]] const Buffer &getModelVertexBuffer() const;
+
+    /**
+     * Returns the sub-pixel offset applied to the projection this frame, in normalized device coordinates.
+     * Zero if taa is disabled.
+     */
+    [[nodiscard]] glm::vec2 getTaaJitter() const;
+
+    [[nodiscard]] glm::vec3 getLightDirection() const;
+
+    [[nodiscard]] glm::mat4 getLightViewProj() const;
+
     void updateGraphicsUniformBuffer() const;
+
+    [[nodiscard]] std::optional<float> readGpuFrameTime() const;
+
+    void updateRenderScale(float gpuFrameTimeMs);
+
+    void readCullingStats();
+
+    void generateStressScene();
+
+    /**
+     * Propagates scene node changes to world transforms, and uploads instances which moved as a result.
+     */
+    void applySceneGraphChanges();
+
+    void startInstancingBenchmark();
+
+    void startNextInstancingBenchmarkRun();
+
+    void updateInstancingBenchmark(std::optional<float> gpuFrameTimeMs);
+
+    [[nodiscard]] vk::Extent2D getScaledRenderExtent() const;
+
+    void updateLightBuffers();
+
+    void generateLightRig();
 };
@@ -4,12 +4,16 @@
 #include "src/render/renderer.h"
 
 Buffer::Buffer(const VmaAllocator _allocator, const vk::DeviceSize size, const vk::BufferUsageFlags usage,
-               const vk::MemoryPropertyFlags properties)
+               const vk::MemoryPropertyFlags properties, const std::vector<uint32_t> &concurrentQueueFamilies)
     : allocator(_allocator) {
+    const bool isConcurrent = concurrentQueueFamilies.size() > 1;
+
     const vk::BufferCreateInfo bufferInfo{
         .size = size,
         .usage = usage,
-        .sharingMode = vk::SharingMode::eExclusive,
+        .sharingMode = isConcurrent ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = isConcurrent ? static_cast<uint32_t>(concurrentQueueFamilies.size()) : 0,
+        .pQueueFamilyIndices = isConcurrent ? concurrentQueueFamilies.data() : nullptr,
     };
 
     VmaAllocationCreateFlags flags;
@@ -47,6 +51,12 @@ Buffer::~Buffer() {
     vmaDestroyBuffer(allocator, static_cast<VkBuffer>(buffer), allocation);
 }
 
+vk::DeviceSize Buffer::getAllocationSize() const {
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(allocator, allocation, &info);
+    return info.size;
+}
+
 void *Buffer::map() {
     if (!mapped && vmaMapMemory(allocator, allocation, &mapped) != VK_SUCCESS) {
         throw std::runtime_error("failed to map buffer memory!");
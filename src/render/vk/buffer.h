@@ -19,8 +19,12 @@ class Buffer {
     void *mapped = nullptr;
 
 public:
+    /**
+     * Buffers accessed from more than one queue family should specify all of them in `concurrentQueueFamilies`,
+     * in which case they're shared concurrently instead of having to be transferred between them.
+     */
     explicit Buffer(VmaAllocator _allocator, vk::DeviceSize size, vk::BufferUsageFlags usage,
-                    vk::MemoryPropertyFlags properties);
+                    vk::MemoryPropertyFlags properties, const std::vector<uint32_t> &concurrentQueueFamilies = {});
 
     ~Buffer();
 
@@ -39,6 +43,11 @@ public:
      */
     [[nodiscard]] const vk::Buffer &operator*() const { return buffer; }
 
+    /**
+     * Returns the size of the memory backing this buffer, which may exceed the requested size.
+     */
+    [[nodiscard]] vk::DeviceSize getAllocationSize() const;
+
     /**
      * Maps the buffer's memory to host memory. This requires the buffer to *not* be created
      * with the vk::MemoryPropertyFlagBits::eDeviceLocal flag set in `properties` during object creation.
@@ -57,18 +57,48 @@ DescriptorSet &DescriptorSet::queueUpdate(const uint32_t binding, const Buffer &
     return *this;
 }
 
+static vk::ImageLayout getDescriptorImageLayout(const vk::DescriptorType type) {
+    return type == vk::DescriptorType::eStorageImage
+               ? vk::ImageLayout::eGeneral
+               : vk::ImageLayout::eShaderReadOnlyOptimal;
+}
+
 DescriptorSet &DescriptorSet::queueUpdate(const RendererContext &ctx, const uint32_t binding, const Texture &texture,
                                           const uint32_t arrayElement) {
+    return queueUpdate(ctx, binding, texture, vk::DescriptorType::eCombinedImageSampler, arrayElement);
+}
+
+DescriptorSet &DescriptorSet::queueUpdate(const RendererContext &ctx, const uint32_t binding, const Texture &texture,
+                                          const vk::DescriptorType type, const uint32_t arrayElement) {
     const vk::DescriptorImageInfo imageInfo{
         .sampler = *texture.getSampler(),
         .imageView = **texture.getImage().getView(ctx),
-        .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        .imageLayout = getDescriptorImageLayout(type),
+    };
+
+    queuedUpdates.emplace_back(DescriptorUpdate{
+        .binding = binding,
+        .arrayElement = arrayElement,
+        .type = type,
+        .info = imageInfo,
+    });
+
+    return *this;
+}
+
+DescriptorSet &DescriptorSet::queueMipUpdate(const RendererContext &ctx, const uint32_t binding, const Texture &texture,
+                                             const uint32_t mipLevel, const vk::DescriptorType type,
+                                             const uint32_t arrayElement) {
+    const vk::DescriptorImageInfo imageInfo{
+        .sampler = *texture.getSampler(),
+        .imageView = **texture.getImage().getMipView(ctx, mipLevel),
+        .imageLayout = getDescriptorImageLayout(type),
     };
 
     queuedUpdates.emplace_back(DescriptorUpdate{
         .binding = binding,
         .arrayElement = arrayElement,
-        .type = vk::DescriptorType::eCombinedImageSampler,
+        .type = type,
         .info = imageInfo,
     });
 
@@ -126,10 +156,15 @@ void DescriptorSet::updateBinding(const RendererContext &ctx, const uint32_t bin
 
 void DescriptorSet::updateBinding(const RendererContext &ctx, const uint32_t binding, const Texture &texture,
                                   const uint32_t arrayElement) const {
+    updateBinding(ctx, binding, texture, vk::DescriptorType::eCombinedImageSampler, arrayElement);
+}
+
+void DescriptorSet::updateBinding(const RendererContext &ctx, const uint32_t binding, const Texture &texture,
+                                  const vk::DescriptorType type, const uint32_t arrayElement) const {
     const vk::DescriptorImageInfo imageInfo{
         .sampler = *texture.getSampler(),
         .imageView = **texture.getImage().getView(ctx),
-        .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        .imageLayout = getDescriptorImageLayout(type),
     };
 
     const vk::WriteDescriptorSet write{
@@ -137,7 +172,7 @@ void DescriptorSet::updateBinding(const RendererContext &ctx, const uint32_t bin
         .dstBinding = binding,
         .dstArrayElement = arrayElement,
         .descriptorCount = 1,
-        .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+        .descriptorType = type,
         .pImageInfo = &imageInfo,
     };
 
@@ -70,6 +70,22 @@ public:
     DescriptorSet &queueUpdate(const RendererContext &ctx, uint32_t binding, const Texture &texture,
                                uint32_t arrayElement = 0);
 
+    /**
+     * Queues an update to a given binding in this descriptor set, using a specific descriptor type.
+     * Storage images are expected to be in the general layout, other image descriptors in the shader read-only one.
+     * To actually push the update, `commitUpdates` must be called after all desired updates are queued.
+     */
+    DescriptorSet &queueUpdate(const RendererContext &ctx, uint32_t binding, const Texture &texture,
+                               vk::DescriptorType type, uint32_t arrayElement = 0);
+
+    /**
+     * Queues an update to a given binding in this descriptor set, referencing only a single mip level of the texture.
+     * Storage images are expected to be in the general layout, other image descriptors in the shader read-only one.
+     * To actually push the update, `commitUpdates` must be called after all desired updates are queued.
+     */
+    DescriptorSet &queueMipUpdate(const RendererContext &ctx, uint32_t binding, const Texture &texture,
+                                  uint32_t mipLevel, vk::DescriptorType type, uint32_t arrayElement = 0);
+
     void commitUpdates(const RendererContext &ctx);
 
     /**
@@ -83,6 +99,13 @@ public:
      */
     void updateBinding(const RendererContext &ctx, uint32_t binding, const Texture &texture,
                        uint32_t arrayElement = 0) const;
+
+    /**
+     * Immediately updates a single binding in this descriptor set, using a specific descriptor type.
+     * Storage images are expected to be in the general layout, other image descriptors in the shader read-only one.
+     */
+    void updateBinding(const RendererContext &ctx, uint32_t binding, const Texture &texture,
+                       vk::DescriptorType type, uint32_t arrayElement = 0) const;
 };
 
 namespace vkutils::desc {
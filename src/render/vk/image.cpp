@@ -54,6 +54,12 @@ Image::~Image() {
     vmaFreeMemory(allocator, *allocation);
 }
 
+vk::DeviceSize Image::getAllocationSize() const {
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(allocator, *allocation, &info);
+    return info.size;
+}
+
 shared_ptr<vk::raii::ImageView> Image::getView(const RendererContext &ctx) {
     return getCachedView(ctx, {0, mipLevels, 0, 1});
 }
@@ -76,16 +82,19 @@ shared_ptr<vk::raii::ImageView> Image::getCachedView(const RendererContext &ctx,
         return cachedViews.at(params);
     }
 
-    const auto &[baseMip, mipCount, baseLayer, layerCount] = params;
-
-    auto view = layerCount == 1
-                    ? vkutils::img::createImageView(ctx, **image, format, aspectMask, baseMip, mipCount, baseLayer)
-                    : vkutils::img::createCubeImageView(ctx, **image, format, aspectMask, baseMip, mipCount);
-    auto viewPtr = make_shared<vk::raii::ImageView>(std::move(view));
+    auto viewPtr = make_shared<vk::raii::ImageView>(createView(ctx, params));
     cachedViews.emplace(params, viewPtr);
     return viewPtr;
 }
 
+vk::raii::ImageView Image::createView(const RendererContext &ctx, const ViewParams params) const {
+    const auto &[baseMip, mipCount, baseLayer, layerCount] = params;
+
+    return layerCount == 1
+               ? vkutils::img::createImageView(ctx, **image, format, aspectMask, baseMip, mipCount, baseLayer)
+               : vkutils::img::createCubeImageView(ctx, **image, format, aspectMask, baseMip, mipCount);
+}
+
 void Image::copyFromBuffer(const vk::Buffer buffer, const vk::raii::CommandBuffer &commandBuffer) {
     const vk::BufferImageCopy region{
         .bufferOffset = 0U,
@@ -351,6 +360,41 @@ void CubeImage::transitionLayout(const vk::ImageLayout oldLayout, const vk::Imag
     Image::transitionLayout(oldLayout, newLayout, range, commandBuffer);
 }
 
+// ==================== ArrayImage ====================
+
+ArrayImage::ArrayImage(const RendererContext &ctx, const vk::ImageCreateInfo &imageInfo,
+                       const vk::MemoryPropertyFlags properties)
+    : Image(ctx, imageInfo, properties, vk::ImageAspectFlagBits::eColor),
+      layerCount(imageInfo.arrayLayers) {
+}
+
+shared_ptr<vk::raii::ImageView> ArrayImage::getView(const RendererContext &ctx) {
+    return getCachedView(ctx, {0, mipLevels, 0, layerCount});
+}
+
+shared_ptr<vk::raii::ImageView> ArrayImage::getMipView(const RendererContext &ctx, const uint32_t mipLevel) {
+    return getCachedView(ctx, {mipLevel, 1, 0, layerCount});
+}
+
+void ArrayImage::transitionLayout(const vk::ImageLayout oldLayout, const vk::ImageLayout newLayout,
+                                  const vk::raii::CommandBuffer &commandBuffer) const {
+    const vk::ImageSubresourceRange range{
+        .aspectMask = aspectMask,
+        .baseMipLevel = 0,
+        .levelCount = mipLevels,
+        .baseArrayLayer = 0,
+        .layerCount = layerCount,
+    };
+
+    Image::transitionLayout(oldLayout, newLayout, range, commandBuffer);
+}
+
+vk::raii::ImageView ArrayImage::createView(const RendererContext &ctx, const ViewParams params) const {
+    const auto &[baseMip, mipCount, baseLayer, viewLayerCount] = params;
+    return vkutils::img::createArrayImageView(ctx, **image, format, aspectMask, baseMip, mipCount,
+                                              baseLayer, viewLayerCount);
+}
+
 // ==================== Texture ====================
 
 void Texture::generateMipmaps(const RendererContext &ctx, const vk::ImageLayout finalLayout) const {
@@ -516,6 +560,12 @@ TextureBuilder &TextureBuilder::asCubemap() {
     return *this;
 }
 
+TextureBuilder &TextureBuilder::asArray(const uint32_t layers) {
+    isArray = true;
+    arrayLayers = layers;
+    return *this;
+}
+
 TextureBuilder &TextureBuilder::asSeparateChannels() {
     isSeparateChannels = true;
     return *this;
@@ -536,6 +586,11 @@ TextureBuilder &TextureBuilder::withSamplerAddressMode(const vk::SamplerAddressM
     return *this;
 }
 
+TextureBuilder &TextureBuilder::withConcurrentSharing(const std::vector<uint32_t> &queueFamilies) {
+    concurrentQueueFamilies = queueFamilies;
+    return *this;
+}
+
 TextureBuilder &TextureBuilder::asUninitialized(const vk::Extent3D extent) {
     isUninitialized = true;
     desiredExtent = extent;
@@ -592,6 +647,8 @@ unique_ptr<Texture> TextureBuilder::create(const RendererContext &ctx) const {
         mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
     }
 
+    const bool isConcurrent = concurrentQueueFamilies.size() > 1;
+
     const vk::ImageCreateInfo imageInfo{
         .flags = isCubemap ? vk::ImageCreateFlagBits::eCubeCompatible : static_cast<vk::ImageCreateFlags>(0),
         .imageType = vk::ImageType::e2D,
@@ -602,7 +659,9 @@ unique_ptr<Texture> TextureBuilder::create(const RendererContext &ctx) const {
         .samples = vk::SampleCountFlagBits::e1,
         .tiling = vk::ImageTiling::eOptimal,
         .usage = usage,
-        .sharingMode = vk::SharingMode::eExclusive,
+        .sharingMode = isConcurrent ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = isConcurrent ? static_cast<uint32_t>(concurrentQueueFamilies.size()) : 0,
+        .pQueueFamilyIndices = isConcurrent ? concurrentQueueFamilies.data() : nullptr,
         .initialLayout = vk::ImageLayout::eUndefined,
     };
 
@@ -615,6 +674,12 @@ unique_ptr<Texture> TextureBuilder::create(const RendererContext &ctx) const {
             imageInfo,
             vk::MemoryPropertyFlagBits::eDeviceLocal
         );
+    } else if (isArray) {
+        texture->image = make_unique<ArrayImage>(
+            ctx,
+            imageInfo,
+            vk::MemoryPropertyFlagBits::eDeviceLocal
+        );
     } else {
         texture->image = make_unique<Image>(
             ctx,
@@ -637,7 +702,8 @@ unique_ptr<Texture> TextureBuilder::create(const RendererContext &ctx) const {
             texture->image->copyFromBuffer(**stagingBuffer, cmdBuffer);
         }
 
-        if (!hasMipmaps) {
+        // uninitialized textures have nothing to downsample, so their levels are left to be filled in by the user
+        if (!hasMipmaps || isUninitialized) {
             texture->image->transitionLayout(
                 vk::ImageLayout::eTransferDstOptimal,
                 layout,
@@ -646,7 +712,7 @@ unique_ptr<Texture> TextureBuilder::create(const RendererContext &ctx) const {
         }
     });
 
-    if (hasMipmaps) {
+    if (hasMipmaps && !isUninitialized) {
         texture->generateMipmaps(ctx, layout);
     }
 
@@ -671,6 +737,20 @@ void TextureBuilder::checkParams() const {
         throw std::invalid_argument("cannot simultaneously set texture as uninitialized and specify sources!");
     }
 
+    if (isArray) {
+        if (!isUninitialized) {
+            throw std::invalid_argument("array textures are currently only supported as uninitialized!");
+        }
+
+        if (isCubemap) {
+            throw std::invalid_argument("cubemap arrays are currently not supported!");
+        }
+
+        if (arrayLayers == 0) {
+            throw std::invalid_argument("array textures must have at least one layer!");
+        }
+    }
+
     if (isCubemap) {
         if (memorySource) {
             throw std::invalid_argument("cubemaps from a memory source are currently not supported!");
@@ -751,7 +831,7 @@ uint32_t TextureBuilder::getLayerCount() const {
     if (memorySource || isFromSwizzleFill) return 1;
 
     const uint32_t sourcesCount = isUninitialized
-                                      ? (isCubemap ? 6 : 1)
+                                      ? (isCubemap ? 6 : arrayLayers)
                                       : paths.size();
     return isSeparateChannels ? sourcesCount / 3 : sourcesCount;
 }
@@ -1001,7 +1081,9 @@ vk::RenderingAttachmentInfo RenderTarget::getAttachmentInfo() const {
                             : vk::ImageLayout::eColorAttachmentOptimal;
 
     vk::ClearValue clearValue = vk::ClearColorValue{0.0f, 0.0f, 0.0f, 1.0f};
-    if (vkutils::img::isDepthFormat(format)) {
+    if (vkutils::img::isIntegerFormat(format)) {
+        clearValue = vk::ClearColorValue{0, 0, 0, 0};
+    } else if (vkutils::img::isDepthFormat(format)) {
         clearValue = vk::ClearDepthStencilValue{
             .depth = 1.0f,
             .stencil = 0,
@@ -1017,9 +1099,13 @@ vk::RenderingAttachmentInfo RenderTarget::getAttachmentInfo() const {
     };
 
     if (resolveView) {
-        info.resolveMode = vk::ResolveModeFlagBits::eAverage;
+        // averaging depth values or packed encodings doesn't produce a meaningful value, so a single sample
+        // is picked instead. integer color formats don't support any other resolve mode anyway
+        info.resolveMode = vkutils::img::isDepthFormat(format) || vkutils::img::isIntegerFormat(format)
+                               ? vk::ResolveModeFlagBits::eSampleZero
+                               : vk::ResolveModeFlagBits::eAverage;
         info.resolveImageView = **resolveView;
-        info.resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        info.resolveImageLayout = layout;
     }
 
     return info;
@@ -1072,6 +1158,26 @@ vkutils::img::createCubeImageView(const RendererContext &ctx, const vk::Image im
     return {*ctx.device, createInfo};
 }
 
+vk::raii::ImageView
+vkutils::img::createArrayImageView(const RendererContext &ctx, const vk::Image image, const vk::Format format,
+                                   const vk::ImageAspectFlags aspectFlags, const uint32_t baseMipLevel,
+                                   const uint32_t mipLevels, const uint32_t baseLayer, const uint32_t layerCount) {
+    const vk::ImageViewCreateInfo createInfo{
+        .image = image,
+        .viewType = vk::ImageViewType::e2DArray,
+        .format = format,
+        .subresourceRange = {
+            .aspectMask = aspectFlags,
+            .baseMipLevel = baseMipLevel,
+            .levelCount = mipLevels,
+            .baseArrayLayer = baseLayer,
+            .layerCount = layerCount,
+        }
+    };
+
+    return {*ctx.device, createInfo};
+}
+
 bool vkutils::img::isDepthFormat(const vk::Format format) {
     switch (format) {
         case vk::Format::eD16Unorm:
@@ -1085,6 +1191,30 @@ bool vkutils::img::isDepthFormat(const vk::Format format) {
     }
 }
 
+bool vkutils::img::isIntegerFormat(const vk::Format format) {
+    switch (format) {
+        case vk::Format::eR8Uint:
+        case vk::Format::eR8Sint:
+        case vk::Format::eR16Uint:
+        case vk::Format::eR16Sint:
+        case vk::Format::eR32Uint:
+        case vk::Format::eR32Sint:
+        case vk::Format::eR16G16Uint:
+        case vk::Format::eR16G16Sint:
+        case vk::Format::eR32G32Uint:
+        case vk::Format::eR32G32Sint:
+        case vk::Format::eR8G8B8A8Uint:
+        case vk::Format::eR8G8B8A8Sint:
+        case vk::Format::eR16G16B16A16Uint:
+        case vk::Format::eR16G16B16A16Sint:
+        case vk::Format::eR32G32B32A32Uint:
+        case vk::Format::eR32G32B32A32Sint:
+            return true;
+        default:
+            return false;
+    }
+}
+
 size_t vkutils::img::getFormatSizeInBytes(const vk::Format format) {
     switch (format) {
         case vk::Format::eB8G8R8A8Srgb:
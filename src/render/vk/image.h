@@ -108,6 +108,11 @@ public:
 
     [[nodiscard]] uint32_t getMipLevels() const { return mipLevels; }
 
+    /**
+     * Returns the size of the memory backing this image, including all of its mip levels and layers.
+     */
+    [[nodiscard]] vk::DeviceSize getAllocationSize() const;
+
     /**
      * Records commands that copy the contents of a given buffer to this image.
      */
@@ -143,6 +148,12 @@ protected:
      * Otherwise, creates the view and caches it for later.
      */
     [[nodiscard]] shared_ptr<vk::raii::ImageView> getCachedView(const RendererContext &ctx, ViewParams params);
+
+    /**
+     * Creates a new view described by the given parameters. Views with a single layer are 2D views,
+     * views over multiple layers are cube views.
+     */
+    [[nodiscard]] virtual vk::raii::ImageView createView(const RendererContext &ctx, ViewParams params) const;
 };
 
 class CubeImage final : public Image {
@@ -162,6 +173,31 @@ public:
                           const vk::raii::CommandBuffer &commandBuffer) const override;
 };
 
+/**
+ * Image with an arbitrary amount of layers, all of which are always viewed together as a 2D array.
+ */
+class ArrayImage final : public Image {
+    uint32_t layerCount;
+
+public:
+    explicit ArrayImage(const RendererContext &ctx, const vk::ImageCreateInfo &imageInfo,
+                        vk::MemoryPropertyFlags properties);
+
+    [[nodiscard]] uint32_t getLayerCount() const { return layerCount; }
+
+    [[nodiscard]] shared_ptr<vk::raii::ImageView>
+    getView(const RendererContext &ctx) override;
+
+    [[nodiscard]] shared_ptr<vk::raii::ImageView>
+    getMipView(const RendererContext &ctx, uint32_t mipLevel) override;
+
+    void transitionLayout(vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+                          const vk::raii::CommandBuffer &commandBuffer) const override;
+
+protected:
+    [[nodiscard]] vk::raii::ImageView createView(const RendererContext &ctx, ViewParams params) const override;
+};
+
 class Texture {
     unique_ptr<Image> image;
     unique_ptr<vk::raii::Sampler> sampler;
@@ -208,6 +244,8 @@ class TextureBuilder {
                                 | vk::ImageUsageFlagBits::eTransferDst
                                 | vk::ImageUsageFlagBits::eSampled;
     bool isCubemap = false;
+    bool isArray = false;
+    uint32_t arrayLayers = 1;
     bool isSeparateChannels = false;
     bool isHdr = false;
     bool hasMipmaps = false;
@@ -221,6 +259,8 @@ class TextureBuilder {
 
     std::optional<vk::Extent3D> desiredExtent;
 
+    std::vector<uint32_t> concurrentQueueFamilies;
+
     std::vector<std::filesystem::path> paths;
     void *memorySource = nullptr;
     bool isFromSwizzleFill = false;
@@ -240,6 +280,12 @@ public:
 
     TextureBuilder &asCubemap();
 
+    /**
+     * Makes the texture a 2D array with a given amount of layers.
+     * This is currently only supported for uninitialized textures.
+     */
+    TextureBuilder &asArray(uint32_t layers);
+
     TextureBuilder &asSeparateChannels();
 
     TextureBuilder &asHdr();
@@ -248,6 +294,12 @@ public:
 
     TextureBuilder &withSamplerAddressMode(vk::SamplerAddressMode mode);
 
+    /**
+     * Shares the texture concurrently between the given queue families, so that it can be accessed from
+     * all of them without ownership transfers. Has no effect if less than two families are given.
+     */
+    TextureBuilder &withConcurrentSharing(const std::vector<uint32_t> &queueFamilies);
+
     TextureBuilder &asUninitialized(vk::Extent3D extent);
 
     TextureBuilder &withSwizzle(std::array<SwizzleComponent, 4> sw);
@@ -326,16 +378,23 @@ namespace vkutils::img {
     createCubeImageView(const RendererContext &ctx, vk::Image image, vk::Format format,
                         vk::ImageAspectFlags aspectFlags, uint32_t baseMipLevel = 0, uint32_t mipLevels = 1);
 
+    [[nodiscard]] vk::raii::ImageView
+    createArrayImageView(const RendererContext &ctx, vk::Image image, vk::Format format,
+                         vk::ImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t mipLevels,
+                         uint32_t baseLayer, uint32_t layerCount);
+
     [[nodiscard]] bool isDepthFormat(vk::Format format);
 
+    [[nodiscard]] bool isIntegerFormat(vk::Format format);
+
     [[nodiscard]] size_t getFormatSizeInBytes(vk::Format format);
 }
 
 struct ImageBarrierInfo {
-    vk::AccessFlagBits srcAccessMask;
-    vk::AccessFlagBits dstAccessMask;
-    vk::PipelineStageFlagBits srcStage;
-    vk::PipelineStageFlagBits dstStage;
+    vk::AccessFlags srcAccessMask;
+    vk::AccessFlags dstAccessMask;
+    vk::PipelineStageFlags srcStage;
+    vk::PipelineStageFlags dstStage;
 };
 
 /**
@@ -362,6 +421,27 @@ static const std::map<std::pair<vk::ImageLayout, vk::ImageLayout>, ImageBarrierI
             .dstStage = vk::PipelineStageFlagBits::eTransfer,
         }
     },
+    {
+        {vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal},
+        {
+            .srcAccessMask = {},
+            .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .srcStage = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .dstStage = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        }
+    },
+    {
+        {vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal},
+        {
+            .srcAccessMask = {},
+            .dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead
+                             | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+            .srcStage = vk::PipelineStageFlagBits::eEarlyFragmentTests
+                        | vk::PipelineStageFlagBits::eLateFragmentTests,
+            .dstStage = vk::PipelineStageFlagBits::eEarlyFragmentTests
+                        | vk::PipelineStageFlagBits::eLateFragmentTests,
+        }
+    },
     {
         {vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eShaderReadOnlyOptimal},
         {
@@ -397,5 +477,78 @@ static const std::map<std::pair<vk::ImageLayout, vk::ImageLayout>, ImageBarrierI
             .srcStage = vk::PipelineStageFlagBits::eFragmentShader,
             .dstStage = vk::PipelineStageFlagBits::eTransfer,
         }
+    },
+    {
+        {vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eColorAttachmentOptimal},
+        {
+            .srcAccessMask = vk::AccessFlagBits::eShaderRead,
+            .dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .srcStage = vk::PipelineStageFlagBits::eFragmentShader
+                        | vk::PipelineStageFlagBits::eComputeShader,
+            .dstStage = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        }
+    },
+    {
+        {vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal},
+        {
+            .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+            .srcStage = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .dstStage = vk::PipelineStageFlagBits::eFragmentShader
+                        | vk::PipelineStageFlagBits::eComputeShader,
+        }
+    },
+    {
+        {vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eDepthStencilAttachmentOptimal},
+        {
+            .srcAccessMask = vk::AccessFlagBits::eShaderRead,
+            .dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead
+                             | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+            .srcStage = vk::PipelineStageFlagBits::eFragmentShader
+                        | vk::PipelineStageFlagBits::eComputeShader,
+            .dstStage = vk::PipelineStageFlagBits::eEarlyFragmentTests
+                        | vk::PipelineStageFlagBits::eLateFragmentTests,
+        }
+    },
+    {
+        {vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal},
+        {
+            // depth resolves happen in the color attachment output stage
+            .srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite
+                             | vk::AccessFlagBits::eColorAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+            .srcStage = vk::PipelineStageFlagBits::eEarlyFragmentTests
+                        | vk::PipelineStageFlagBits::eLateFragmentTests
+                        | vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            .dstStage = vk::PipelineStageFlagBits::eFragmentShader
+                        | vk::PipelineStageFlagBits::eComputeShader,
+        }
+    },
+    {
+        {vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eGeneral},
+        {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+            .srcStage = vk::PipelineStageFlagBits::eTransfer,
+            .dstStage = vk::PipelineStageFlagBits::eComputeShader,
+        }
+    },
+    {
+        {vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eGeneral},
+        {
+            .srcAccessMask = vk::AccessFlagBits::eShaderRead,
+            .dstAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .srcStage = vk::PipelineStageFlagBits::eFragmentShader,
+            .dstStage = vk::PipelineStageFlagBits::eComputeShader,
+        }
+    },
+    {
+        {vk::ImageLayout::eGeneral, vk::ImageLayout::eShaderReadOnlyOptimal},
+        {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+            .srcStage = vk::PipelineStageFlagBits::eComputeShader,
+            .dstStage = vk::PipelineStageFlagBits::eFragmentShader,
+        }
     }
 };
@@ -5,6 +5,26 @@
 #include "src/render/renderer.h"
 #include "src/render/mesh/vertex.h"
 
+static vk::raii::ShaderModule createShaderModule(const RendererContext &ctx, const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file!");
+    }
+
+    const size_t fileSize = file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), static_cast<std::streamsize>(fileSize));
+
+    const vk::ShaderModuleCreateInfo createInfo{
+        .codeSize = buffer.size(),
+        .pCode = reinterpret_cast<const uint32_t *>(buffer.data()),
+    };
+
+    return vk::raii::ShaderModule{*ctx.device, createInfo};
+}
+
 PipelineBuilder &PipelineBuilder::withVertexShader(const std::filesystem::path &path) {
     vertexShaderPath = path;
     return *this;
@@ -211,25 +231,59 @@ void PipelineBuilder::checkParams() const {
     }
 }
 
-vk::raii::ShaderModule
-PipelineBuilder::createShaderModule(const RendererContext &ctx, const std::filesystem::path &path) {
-    std::ifstream file(path, std::ios::ate | std::ios::binary);
+ComputePipelineBuilder &ComputePipelineBuilder::withComputeShader(const std::filesystem::path &path) {
+    computeShaderPath = path;
+    return *this;
+}
 
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file!");
-    }
+ComputePipelineBuilder &
+ComputePipelineBuilder::withDescriptorLayouts(const std::vector<vk::DescriptorSetLayout> &layouts) {
+    descriptorSetLayouts = layouts;
+    return *this;
+}
 
-    const size_t fileSize = file.tellg();
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), static_cast<std::streamsize>(fileSize));
+ComputePipelineBuilder &ComputePipelineBuilder::withPushConstants(const std::vector<vk::PushConstantRange> &ranges) {
+    pushConstantRanges = ranges;
+    return *this;
+}
 
-    const vk::ShaderModuleCreateInfo createInfo{
-        .codeSize = buffer.size(),
-        .pCode = reinterpret_cast<const uint32_t *>(buffer.data()),
+Pipeline ComputePipelineBuilder::create(const RendererContext &ctx) const {
+    checkParams();
+
+    Pipeline result;
+
+    const vk::raii::ShaderModule compShaderModule = createShaderModule(ctx, computeShaderPath);
+
+    const vk::PipelineShaderStageCreateInfo compShaderStageInfo{
+        .stage = vk::ShaderStageFlagBits::eCompute,
+        .module = *compShaderModule,
+        .pName = "main",
     };
 
-    return vk::raii::ShaderModule{*ctx.device, createInfo};
+    const vk::PipelineLayoutCreateInfo pipelineLayoutInfo{
+        .setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
+        .pSetLayouts = descriptorSetLayouts.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+        .pPushConstantRanges = pushConstantRanges.empty() ? nullptr : pushConstantRanges.data()
+    };
+
+    result.layout = make_unique<vk::raii::PipelineLayout>(*ctx.device, pipelineLayoutInfo);
+
+    const vk::ComputePipelineCreateInfo pipelineCreateInfo{
+        .stage = compShaderStageInfo,
+        .layout = **result.layout,
+    };
+
+    result.pipeline = make_unique<vk::raii::Pipeline>(*ctx.device, nullptr, pipelineCreateInfo);
+    result.rasterizationSamples = vk::SampleCountFlagBits::e1;
+
+    return result;
+}
+
+void ComputePipelineBuilder::checkParams() const {
+    if (computeShaderPath.empty()) {
+        throw std::invalid_argument("compute shader must be specified during pipeline creation!");
+    }
 }
 
 template PipelineBuilder &PipelineBuilder::withVertices<ModelVertex>();
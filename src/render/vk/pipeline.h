@@ -17,6 +17,7 @@ class Pipeline {
     vk::SampleCountFlagBits rasterizationSamples;
 
     friend class PipelineBuilder;
+    friend class ComputePipelineBuilder;
 
     Pipeline() = default;
 
@@ -80,7 +81,26 @@ public:
 
 private:
     void checkParams() const;
+};
+
+/**
+ * Builder class streamlining compute pipeline creation.
+ */
+class ComputePipelineBuilder {
+    std::filesystem::path computeShaderPath;
 
-    [[nodiscard]] static vk::raii::ShaderModule
-    createShaderModule(const RendererContext &ctx, const std::filesystem::path &path);
+    std::vector<vk::DescriptorSetLayout> descriptorSetLayouts;
+    std::vector<vk::PushConstantRange> pushConstantRanges;
+
+public:
+    ComputePipelineBuilder &withComputeShader(const std::filesystem::path &path);
+
+    ComputePipelineBuilder &withDescriptorLayouts(const std::vector<vk::DescriptorSetLayout> &layouts);
+
+    ComputePipelineBuilder &withPushConstants(const std::vector<vk::PushConstantRange> &ranges);
+
+    [[nodiscard]] Pipeline create(const RendererContext &ctx) const;
+
+private:
+    void checkParams() const;
 };
@@ -1,5 +1,7 @@
 #include "swapchain.h"
 
+#include <algorithm>
+
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
@@ -14,7 +16,8 @@ SwapChainSupportDetails::SwapChainSupportDetails(const vk::raii::PhysicalDevice
 
 SwapChain::SwapChain(const RendererContext &ctx, const vk::raii::SurfaceKHR &surface,
                      const QueueFamilyIndices &queueFamilies, GLFWwindow *window,
-                     vk::SampleCountFlagBits sampleCount) : msaaSampleCount(sampleCount) {
+                     vk::SampleCountFlagBits sampleCount, const std::optional<vk::PresentModeKHR> preferredPresentMode)
+    : msaaSampleCount(sampleCount) {
     const auto [capabilities, formats, presentModes] = SwapChainSupportDetails{*ctx.physicalDevice, surface};
 
     extent = chooseExtent(capabilities, window);
@@ -22,12 +25,21 @@ SwapChain::SwapChain(const RendererContext &ctx, const vk::raii::SurfaceKHR &sur
     const vk::SurfaceFormatKHR surfaceFormat = chooseSurfaceFormat(formats);
     imageFormat = surfaceFormat.format;
 
-    const vk::PresentModeKHR presentMode = choosePresentMode(presentModes);
+    availablePresentModes = presentModes;
+    presentMode = choosePresentMode(presentModes, preferredPresentMode);
 
     const auto &[graphicsComputeFamily, presentFamily] = queueFamilies;
     const uint32_t queueFamilyIndices[] = {graphicsComputeFamily.value(), presentFamily.value()};
     const bool isUniformFamily = graphicsComputeFamily == presentFamily;
 
+    // lets presented frames be copied out, if the surface allows it
+    vk::ImageUsageFlags imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+    isReadable = static_cast<bool>(capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc);
+
+    if (isReadable) {
+        imageUsage |= vk::ImageUsageFlagBits::eTransferSrc;
+    }
+
     const vk::SwapchainCreateInfoKHR createInfo{
         .surface = *surface,
         .minImageCount = getImageCount(ctx, surface),
@@ -35,7 +47,7 @@ SwapChain::SwapChain(const RendererContext &ctx, const vk::raii::SurfaceKHR &sur
         .imageColorSpace = surfaceFormat.colorSpace,
         .imageExtent = extent,
         .imageArrayLayers = 1,
-        .imageUsage = vk::ImageUsageFlagBits::eColorAttachment,
+        .imageUsage = imageUsage,
         .imageSharingMode = isUniformFamily ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent,
         .queueFamilyIndexCount = isUniformFamily ? 0u : 2u,
         .pQueueFamilyIndices = isUniformFamily ? nullptr : queueFamilyIndices,
@@ -171,7 +183,15 @@ vk::SurfaceFormatKHR SwapChain::chooseSurfaceFormat(const std::vector<vk::Surfac
     return availableFormats[0];
 }
 
-vk::PresentModeKHR SwapChain::choosePresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes) {
+vk::PresentModeKHR SwapChain::choosePresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes,
+                                                const std::optional<vk::PresentModeKHR> preferredPresentMode) {
+    if (
+        preferredPresentMode
+        && std::ranges::find(availablePresentModes, *preferredPresentMode) != availablePresentModes.end()
+    ) {
+        return *preferredPresentMode;
+    }
+
     for (const auto &availablePresentMode: availablePresentModes) {
         if (availablePresentMode == vk::PresentModeKHR::eMailbox) {
             return availablePresentMode;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 #include "image.h"
 #include "src/render/libs.h"
 
@@ -32,6 +34,9 @@ class SwapChain {
     vk::Format imageFormat{};
     vk::Format depthFormat{};
     vk::Extent2D extent{};
+    vk::PresentModeKHR presentMode{};
+    bool isReadable = false;
+    std::vector<vk::PresentModeKHR> availablePresentModes;
 
     unique_ptr<Image> colorImage;
     unique_ptr<Image> depthImage;
@@ -45,7 +50,8 @@ class SwapChain {
 public:
     explicit SwapChain(const RendererContext &ctx, const vk::raii::SurfaceKHR &surface,
                        const QueueFamilyIndices &queueFamilies, GLFWwindow *window,
-                       vk::SampleCountFlagBits sampleCount = vk::SampleCountFlagBits::e1);
+                       vk::SampleCountFlagBits sampleCount = vk::SampleCountFlagBits::e1,
+                       std::optional<vk::PresentModeKHR> preferredPresentMode = {});
 
     SwapChain(const SwapChain &other) = delete;
 
@@ -59,12 +65,38 @@ public:
 
     [[nodiscard]] vk::Extent2D getExtent() const { return extent; }
 
+    [[nodiscard]] vk::PresentModeKHR getPresentMode() const { return presentMode; }
+
+    /**
+     * Checks whether images can be used as the source of transfers, i.e. copied into buffers.
+     */
+    [[nodiscard]] bool isImageReadable() const { return isReadable; }
+
+    /**
+     * Returns the present modes supported by the surface this swap chain was created for.
+     */
+    [[nodiscard]] const std::vector<vk::PresentModeKHR> &getAvailablePresentModes() const {
+        return availablePresentModes;
+    }
+
+    /**
+     * Returns the multisampled color image shared by all swap chain render targets. Only used with msaa.
+     */
+    [[nodiscard]] Image &getColorImage() const { return *colorImage; }
+
+    /**
+     * Returns the depth image shared by all swap chain render targets. Its sample count matches the color targets.
+     */
+    [[nodiscard]] Image &getDepthImage() const { return *depthImage; }
+
     /**
      * Returns the index of the image that was most recently acquired and will be presented next.
      * @return Index of the current image.
      */
     [[nodiscard]] uint32_t getCurrentImageIndex() const { return currentImageIndex; }
 
+    [[nodiscard]] vk::Image getCurrentImage() const { return images[currentImageIndex]; }
+
     /**
      * Wraps swapchain image views in `RenderTarget` objects and returns them.
      * When called the first time, these views are created and cached for later.
@@ -107,5 +139,6 @@ private:
 
     static vk::SurfaceFormatKHR chooseSurfaceFormat(const std::vector<vk::SurfaceFormatKHR> &availableFormats);
 
-    static vk::PresentModeKHR choosePresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes);
+    static vk::PresentModeKHR choosePresentMode(const std::vector<vk::PresentModeKHR> &availablePresentModes,
+                                                std::optional<vk::PresentModeKHR> preferredPresentMode);
 };
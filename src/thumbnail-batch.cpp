@@ -0,0 +1,313 @@
+#include "thumbnail-batch.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <glm/gtc/constants.hpp>
+
+#include "deps/stb/stb_image_write.h"
+
+static const std::vector<CameraPreset> cameraPresets{
+    {"front", {0.0f, -0.15f}, 1.6f * Model::NORMALIZED_RADIUS},
+    {"three-quarter", {glm::quarter_pi<float>(), -0.4f}, 1.6f * Model::NORMALIZED_RADIUS},
+    {"side", {glm::half_pi<float>(), -0.15f}, 1.6f * Model::NORMALIZED_RADIUS},
+    {"back", {glm::pi<float>(), -0.15f}, 1.6f * Model::NORMALIZED_RADIUS},
+    {"top", {0.0f, -1.4f}, 1.6f * Model::NORMALIZED_RADIUS},
+};
+
+static constexpr auto usage =
+        "usage: --thumbnails <model list> --envmap <hdr file> [--output <dir>] [--size <pixels>]\n"
+        "                    [--samples <frames>] [--presets <name>,...] [--encoders <threads>]\n"
+        "the model list holds one path per line, relative to the list itself. available presets:\n"
+        "front, three-quarter (default), side, back, top";
+
+static uint32_t parsePositive(const std::string &option, const std::string &value) {
+    try {
+        if (const int parsed = std::stoi(value); parsed > 0) {
+            return static_cast<uint32_t>(parsed);
+        }
+    } catch (std::exception &) {
+    }
+
+    throw std::runtime_error("expected a positive number after " + option + "\n" + usage);
+}
+
+static std::vector<CameraPreset> parsePresets(const std::string &names) {
+    std::vector<CameraPreset> presets;
+    std::stringstream stream(names);
+    std::string name;
+
+    while (std::getline(stream, name, ',')) {
+        const auto it = std::ranges::find(cameraPresets, name, &CameraPreset::name);
+
+        if (it == cameraPresets.end()) {
+            throw std::runtime_error("unknown camera preset: " + name + "\n" + usage);
+        }
+
+        presets.push_back(*it);
+    }
+
+    return presets;
+}
+
+static std::vector<std::filesystem::path> readModelList(const std::filesystem::path &listPath) {
+    std::ifstream file(listPath);
+
+    if (!file) {
+        throw std::runtime_error("failed to open model list: " + listPath.string());
+    }
+
+    std::vector<std::filesystem::path> paths;
+    std::string line;
+
+    while (std::getline(file, line)) {
+        // trailing whitespace includes the carriage returns of lists written on windows
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        line.erase(0, line.find_first_not_of(" \t"));
+
+        if (!line.empty() && line[0] != '#') {
+            paths.emplace_back(line);
+        }
+    }
+
+    return paths;
+}
+
+ThumbnailBatchSettings ThumbnailBatchSettings::fromArgs(const std::vector<std::string> &args) {
+    ThumbnailBatchSettings settings;
+    std::filesystem::path modelListPath;
+
+    for (size_t i = 0; i < args.size(); i++) {
+        const auto &arg = args[i];
+
+        if (!arg.starts_with("--")) {
+            if (!modelListPath.empty()) {
+                throw std::runtime_error(std::string("more than one model list given\n") + usage);
+            }
+
+            modelListPath = arg;
+            continue;
+        }
+
+        if (i + 1 == args.size()) {
+            throw std::runtime_error("missing value after " + arg + "\n" + usage);
+        }
+
+        const auto &value = args[++i];
+
+        if (arg == "--envmap") {
+            settings.envmapPath = value;
+        } else if (arg == "--output") {
+            settings.outputDir = value;
+        } else if (arg == "--size") {
+            settings.imageSize = parsePositive(arg, value);
+        } else if (arg == "--samples") {
+            settings.samplesPerImage = parsePositive(arg, value);
+        } else if (arg == "--presets") {
+            settings.cameraPresets = parsePresets(value);
+        } else if (arg == "--encoders") {
+            settings.encoderThreadCount = parsePositive(arg, value);
+        } else {
+            throw std::runtime_error("unknown option: " + arg + "\n" + usage);
+        }
+    }
+
+    if (modelListPath.empty() || settings.envmapPath.empty()) {
+        throw std::runtime_error(usage);
+    }
+
+    if (settings.cameraPresets.empty()) {
+        settings.cameraPresets = parsePresets("three-quarter");
+    }
+
+    settings.modelListDir = std::filesystem::absolute(modelListPath).parent_path();
+    settings.modelPaths = readModelList(modelListPath);
+
+    for (auto &path: settings.modelPaths) {
+        path = (settings.modelListDir / path).lexically_normal();
+    }
+
+    return settings;
+}
+
+ThumbnailBatch::ThumbnailBatch(ThumbnailBatchSettings settings)
+    : settings(std::move(settings)),
+      renderer(RendererOptions{
+          .headlessExtent = vk::Extent2D{this->settings.imageSize, this->settings.imageSize},
+      }) {
+}
+
+bool ThumbnailBatch::run() {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    renderer.loadEnvironmentMap(settings.envmapPath);
+
+    const auto &modelPaths = settings.modelPaths;
+
+    const auto startImport = [&](const size_t idx) {
+        return std::async(std::launch::async, [path = modelPaths[idx]] {
+            return make_unique<ModelImport>(path);
+        });
+    };
+
+    std::future<unique_ptr<ModelImport> > nextImport;
+
+    if (!modelPaths.empty()) {
+        nextImport = startImport(0);
+    }
+
+    for (size_t i = 0; i < modelPaths.size(); i++) {
+        const auto modelStartTime = std::chrono::steady_clock::now();
+
+        unique_ptr<ModelImport> import;
+
+        try {
+            import = nextImport.get();
+        } catch (std::exception &e) {
+            std::cerr << "failed to import " << modelPaths[i] << ": " << e.what() << std::endl;
+            failedModelCount++;
+        }
+
+        // the next model is parsed while this one is uploaded and rendered
+        if (i + 1 < modelPaths.size()) {
+            nextImport = startImport(i + 1);
+        }
+
+        if (!import) {
+            continue;
+        }
+
+        try {
+            renderer.loadModelWithMaterials(std::move(*import));
+        } catch (std::exception &e) {
+            std::cerr << "failed to load " << modelPaths[i] << ": " << e.what() << std::endl;
+            failedModelCount++;
+            continue;
+        }
+
+        // every model is rendered once, so there's no point in keeping the previous ones resident
+        renderer.clearModelCache();
+
+        renderModel(modelPaths[i]);
+
+        const std::chrono::duration<double> modelTime = std::chrono::steady_clock::now() - modelStartTime;
+        std::cout << "[" << i + 1 << "/" << modelPaths.size() << "] " << modelPaths[i].string()
+                << " (" << modelTime.count() << " s)" << std::endl;
+    }
+
+    renderer.flushCapturedFrames();
+
+    while (!pendingEncodes.empty()) {
+        finishOldestEncode();
+    }
+
+    const std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - startTime;
+    const auto renderedModelCount = static_cast<uint32_t>(modelPaths.size()) - failedModelCount;
+
+    std::cout << "rendered " << renderedModelCount << " models into " << writtenImageCount << " images in "
+            << totalTime.count() << " s, " << 60.0 * renderedModelCount / totalTime.count() << " models per minute"
+            << std::endl;
+
+    if (failedModelCount > 0 || failedImageCount > 0) {
+        std::cout << "failed models: " << failedModelCount << ", failed images: " << failedImageCount << std::endl;
+    }
+
+    return failedModelCount == 0 && failedImageCount == 0;
+}
+
+void ThumbnailBatch::renderModel(const std::filesystem::path &modelPath) {
+    for (const auto &preset: settings.cameraPresets) {
+        renderView(preset, getOutputPath(modelPath, preset));
+    }
+}
+
+void ThumbnailBatch::renderView(const CameraPreset &preset, const std::filesystem::path &outputPath) {
+    renderer.setCameraOrbit(preset.rotation, preset.distance);
+
+    // the first frame of a new view starts the accumulation, which all the following ones add to
+    for (uint32_t frame = 0; frame < settings.samplesPerImage;) {
+        renderer.tick(0.0f);
+
+        // the swap chain had to be recreated, which doesn't render a frame
+        if (!renderer.startFrame()) {
+            continue;
+        }
+
+        renderFrame();
+
+        if (frame + 1 == settings.samplesPerImage) {
+            renderer.captureFrame([this, outputPath](CapturedFrame &&capturedFrame) {
+                encodeImage(outputPath, std::move(capturedFrame));
+            });
+        }
+
+        renderer.endFrame();
+        frame++;
+    }
+}
+
+void ThumbnailBatch::renderFrame() {
+    renderer.runSkinningPass();
+    renderer.runShadowPass();
+    renderer.runPrepass();
+    renderer.runCullingPass();
+    renderer.runSsaoPass();
+    renderer.runSsaoBlurPass();
+    renderer.drawScene();
+    renderer.runTaaPass();
+    renderer.runFxaaPass();
+    renderer.runUpscalePass();
+}
+
+void ThumbnailBatch::encodeImage(const std::filesystem::path &path, CapturedFrame &&frame) {
+    // bounds the memory held by captured images waiting for a worker
+    while (pendingEncodes.size() >= settings.encoderThreadCount) {
+        finishOldestEncode();
+    }
+
+    pendingEncodes.push_back(std::async(std::launch::async, [path, frame = std::move(frame)] {
+        std::filesystem::create_directories(path.parent_path());
+
+        const int result = stbi_write_png(
+            path.string().c_str(),
+            static_cast<int>(frame.width),
+            static_cast<int>(frame.height),
+            STBI_rgb_alpha,
+            frame.pixels.data(),
+            static_cast<int>(4 * frame.width)
+        );
+
+        if (!result) {
+            throw std::runtime_error("failed to write image: " + path.string());
+        }
+    }));
+}
+
+void ThumbnailBatch::finishOldestEncode() {
+    try {
+        pendingEncodes.front().get();
+        writtenImageCount++;
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        failedImageCount++;
+    }
+
+    pendingEncodes.pop_front();
+}
+
+std::filesystem::path ThumbnailBatch::getOutputPath(const std::filesystem::path &modelPath,
+                                                    const CameraPreset &preset) const {
+    // mirrors the layout of the library, as plenty of models share generic names like `scene.gltf`
+    auto relativePath = modelPath.lexically_relative(settings.modelListDir);
+
+    if (relativePath.empty() || *relativePath.begin() == "..") {
+        relativePath = modelPath.filename();
+    }
+
+    relativePath.replace_extension();
+
+    return settings.outputDir / relativePath.parent_path()
+           / (relativePath.filename().string() + "-" + preset.name + ".png");
+}
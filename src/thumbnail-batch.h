@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "render/renderer.h"
+
+/**
+ * A named camera placement on an orbit around the model, which is normalized to `Model::NORMALIZED_RADIUS`.
+ */
+struct CameraPreset {
+    std::string name;
+    glm::vec2 rotation; // yaw and pitch, negative pitch looks from above
+    float distance;
+};
+
+struct ThumbnailBatchSettings {
+    std::vector<std::filesystem::path> modelPaths;
+    std::filesystem::path modelListDir; // model paths are relative to it, and so are the output images
+    std::filesystem::path envmapPath;
+    std::filesystem::path outputDir = "thumbnails";
+    std::vector<CameraPreset> cameraPresets;
+    uint32_t imageSize = 512;
+    uint32_t samplesPerImage = 32; // frames accumulated into each image
+    uint32_t encoderThreadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    /**
+     * Parses the arguments following `--thumbnails`, and reads the model list they point to.
+     * Throws with a usage message if they're invalid.
+     */
+    [[nodiscard]] static ThumbnailBatchSettings fromArgs(const std::vector<std::string> &args);
+};
+
+/**
+ * Renders preview images of a list of models without showing anything on screen, one image per model and camera
+ * preset. While a model is uploaded and rendered, the next one is already being parsed on a worker thread,
+ * and finished images are encoded to png files on other ones.
+ */
+class ThumbnailBatch {
+    ThumbnailBatchSettings settings;
+    VulkanRenderer renderer;
+
+    std::deque<std::future<void> > pendingEncodes; // oldest first
+    uint32_t writtenImageCount = 0;
+    uint32_t failedImageCount = 0;
+    uint32_t failedModelCount = 0;
+
+public:
+    explicit ThumbnailBatch(ThumbnailBatchSettings settings);
+
+    /**
+     * Renders every image and reports throughput to stdout. Returns whether all of them were written.
+     */
+    [[nodiscard]] bool run();
+
+private:
+    void renderModel(const std::filesystem::path &modelPath);
+
+    void renderView(const CameraPreset &preset, const std::filesystem::path &outputPath);
+
+    void renderFrame();
+
+    /**
+     * Encodes the image on a worker thread, after waiting for the oldest one if all workers are busy.
+     */
+    void encodeImage(const std::filesystem::path &path, CapturedFrame &&frame);
+
+    void finishOldestEncode();
+
+    [[nodiscard]] std::filesystem::path getOutputPath(const std::filesystem::path &modelPath,
+                                                      const CameraPreset &preset) const;
+};
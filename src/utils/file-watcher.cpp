@@ -0,0 +1,108 @@
+#include "file-watcher.h"
+
+#include <array>
+#include <iostream>
+#include <ranges>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotifyFd < 0) {
+        std::cerr << "failed to initialize inotify, file changes won't be detected" << std::endl;
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+void FileWatcher::watch(const std::filesystem::path &path) {
+    std::error_code error;
+    const auto canonicalPath = std::filesystem::canonical(path, error);
+
+    if (error || !isSupported()) {
+        return;
+    }
+
+    watchedFiles.insert(canonicalPath);
+
+#ifdef __linux__
+    const auto dir = canonicalPath.parent_path();
+
+    for (const auto &watchedDir: watchedDirs | std::views::values) {
+        if (watchedDir == dir) {
+            return;
+        }
+    }
+
+    const int wd = inotify_add_watch(inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if (wd < 0) {
+        std::cerr << "failed to watch directory: " << dir << std::endl;
+        return;
+    }
+
+    watchedDirs.emplace(wd, dir);
+#endif
+}
+
+void FileWatcher::clear() {
+#ifdef __linux__
+    for (const int wd: watchedDirs | std::views::keys) {
+        inotify_rm_watch(inotifyFd, wd);
+    }
+#endif
+
+    watchedDirs.clear();
+    watchedFiles.clear();
+}
+
+std::vector<std::filesystem::path> FileWatcher::poll() {
+    std::set<std::filesystem::path> changedFiles;
+
+#ifdef __linux__
+    if (!isSupported()) {
+        return {};
+    }
+
+    alignas(inotify_event) std::array<char, 4096> buffer{};
+
+    while (true) {
+        const ssize_t length = read(inotifyFd, buffer.data(), buffer.size());
+
+        // nothing more to read without blocking
+        if (length <= 0) {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            const auto dirIt = watchedDirs.find(event->wd);
+
+            if (event->len == 0 || dirIt == watchedDirs.end()) {
+                continue;
+            }
+
+            // events cover every file in the directory, not only the watched ones
+            if (auto path = dirIt->second / event->name; watchedFiles.contains(path)) {
+                changedFiles.insert(std::move(path));
+            }
+        }
+    }
+#endif
+
+    return {changedFiles.begin(), changedFiles.end()};
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <set>
+#include <vector>
+
+/**
+ * Reports modifications of a set of files, without blocking. Backed by inotify, so changes are only ever
+ * reported on Linux; elsewhere the watcher accepts files but stays silent.
+ *
+ * Directories containing the files are watched rather than the files themselves, as exporters and editors
+ * commonly save by writing a new file and renaming it over the old one, which would end a watch on the file.
+ */
+class FileWatcher {
+    int inotifyFd = -1;
+    std::map<int, std::filesystem::path> watchedDirs; // by watch descriptor
+    std::set<std::filesystem::path> watchedFiles;
+
+public:
+    explicit FileWatcher();
+
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &other) = delete;
+
+    FileWatcher(FileWatcher &&other) = delete;
+
+    FileWatcher &operator=(const FileWatcher &other) = delete;
+
+    FileWatcher &operator=(FileWatcher &&other) = delete;
+
+    [[nodiscard]] bool isSupported() const { return inotifyFd >= 0; }
+
+    /**
+     * Starts reporting modifications of the file at `path`. Files which don't exist are ignored.
+     */
+    void watch(const std::filesystem::path &path);
+
+    /**
+     * Stops watching all files.
+     */
+    void clear();
+
+    [[nodiscard]] size_t getWatchedFileCount() const { return watchedFiles.size(); }
+
+    /**
+     * Returns every watched file written to or replaced since the last call, each of them once.
+     */
+    [[nodiscard]] std::vector<std::filesystem::path> poll();
+};